@@ -93,6 +93,9 @@ enum WndPopupIDs
 extern twins::IWindowState * getWndMain();
 extern const twins::Widget * pWndMainWidgets;
 extern const uint16_t wndMainNumPages;
+extern const twins::FocusEntry * pWndMainFocusOrder;
+extern const twins::WidgetColumns wndMainWidgetColumns;
 
 extern twins::IWindowState * getWndPopup();
-extern const twins::Widget * pWndPopupWidgets;
+extern const twins::FocusEntry * pWndPopupFocusOrder;
+extern const twins::WidgetColumns wndPopupWidgetColumns;
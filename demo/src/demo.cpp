@@ -6,9 +6,11 @@
 #include "twins.hpp"
 #include "twins_ringbuffer.hpp"
 #include "twins_vector.hpp"
+#include "twins_small_vector.hpp"
 #include "twins_map.hpp"
 #include "twins_utils.hpp"
 #include "twins_input_posix.hpp"
+#include "twins_event_loop.hpp"
 #include "twins_pal_defimpl.hpp"
 #include "twins_glob.hpp"
 #include "twins_window_state_base.hpp"
@@ -546,7 +548,7 @@ private:
     {
         if (count == 1 && *pId == twins::WIDGET_ID_NONE)
         {
-            invalidatedWgts.resize(0); // resize do not free memory if small chunk allocated
+            invalidatedWgts.clear(); // few IDs fit in the inline storage - no heap involved
             return;
         }
 
@@ -559,14 +561,14 @@ private:
         if (instantly)
         {
             WindowStateBase::invalidateImpl(invalidatedWgts.data(), invalidatedWgts.size(), true);
-            invalidatedWgts.resize(0);
+            invalidatedWgts.clear();
         }
     }
 
 public:
     twins::String lblKeycodeSeq;
     twins::String lblKeyName;
-    twins::Vector<twins::WID> invalidatedWgts;
+    twins::SmallVector<twins::WID, 16> invalidatedWgts;
     bool wndEnabled = true;
 
 private:
@@ -666,16 +668,22 @@ twins::IWindowState * getWndMain()
 {
     // the only place where pWndMainWidgets is used
     if (!wndMain.getWidgets())
+    {
         wndMain.init(pWndMainWidgets);
+        wndMain.setFocusOrder(pWndMainFocusOrder);
+        wndMain.setWidgetColumns(&wndMainWidgetColumns);
+    }
     return &wndMain;
 }
 
 twins::IWindowState * getWndPopup()
 {
-    // the only place where pWndPopupWidgets is used
-    if (!wndPopup.getWidgets())
+    // no Widget array - the window is given by its columns only
+    if (!wndPopup.getWidgetColumns())
     {
-        wndPopup.init(pWndPopupWidgets);
+        wndPopup.init(nullptr);
+        wndPopup.setFocusOrder(pWndPopupFocusOrder);
+        wndPopup.setWidgetColumns(&wndPopupWidgetColumns);
         // sets the widget to be focused when the Popup is shown for the first time
         wndPopup.getFocusedID() = IDPP_BTN_NO;
     }
@@ -701,26 +709,27 @@ static void gui()
     twins::screenClrAll();
     twins::glob::wMngr.show(getWndMain());
     twins::inputPosixInit(100);
-    twins::mouseMode(twins::MouseMode::M2);
+    twins::mouseMode(twins::MouseMode::SGR);
+    twins::bracketedPaste(true);
     twins::flushBuffer();
 
     // after twins::init():
     twins::RingBuff<char> rbKeybInput;
-    rbKeybInput.init(20);
+    rbKeybInput.init(80);
 
     // assert(!"just-a-test");
 
-    for (;;)
-    {
-        bool quit_req = false;
-        const char *posix_inp = twins::inputPosixRead(quit_req);
-        if (quit_req) break;
-        rbKeybInput.write(posix_inp);
+    // sleeps until a key is pressed
+    twins::EventLoop loop;
+    int esc_timer = 0;
+    std::function<void()> process_input;
 
+    process_input = [&]()
+    {
         if (rbKeybInput.size() && twins::glob::wMngr.size())
         {
             twins::Locker lck;
-            twins::KeyCode kc = {};
+            twins::KeyCode keys[16];
 
             // display input buffer
             {
@@ -730,66 +739,85 @@ static void gui()
                 wndMain.lblKeycodeSeq = seq;
             }
 
-            twins::decodeInputSeq(rbKeybInput, kc);
-            // pass key to top-window
-            bool key_handled = twins::processInput(twins::glob::wMngr.topWndWidgets(), kc);
-            wndMain.lblKeyName = kc.name;
+            // decode all available keys and apply them before single redraw;
+            // repeated navigation keys merged, as all the handlers below respect the KeyCode::repeat
+            const uint16_t n_keys = twins::decodeInputSeqBatch(rbKeybInput, keys, sizeof(keys)/sizeof(keys[0]), true);
+            bool draw_leds = n_keys == 0;
 
-            // display decoded key
-            if (kc.key == twins::Key::MouseEvent)
-            {
-                TWINS_LOG_D("B%c %c%c%c %03d:%03d",
-                    '0' + (char)kc.mouse.btn,
-                    kc.m_ctrl ? 'C' : ' ',
-                    kc.m_alt ? 'A' : ' ',
-                    kc.m_shift ? 'S' : ' ',
-                    kc.mouse.col, kc.mouse.row);
-            }
-            else if (kc.key != twins::Key::None)
+            if (n_keys == 0)
+                wndMain.lblKeyName = "<?>";
+
+            for (uint16_t k = 0, processed = 0; k < n_keys; k++, processed--)
             {
-                TWINS_LOG_D("Key: '%s' %s", kc.name, key_handled ? "(handled)" : "");
-            }
+                if (processed == 0)
+                {
+                    // pass keys to top-window, redrawn once after the batch;
+                    // batch ends earlier if the top-window changed
+                    twins::processInputBatch(*twins::glob::wMngr.topWnd(), keys + k, n_keys - k, &processed);
+                }
 
+                const twins::KeyCode &kc = keys[k];
+                wndMain.lblKeyName = kc.name;
 
-            if (kc.m_spec && kc.key == twins::Key::F2)
-            {
-                wndMain.wndEnabled = !wndMain.wndEnabled;
-                wndMain.invalidate(ID_WND);
-            }
-            else if (kc.m_spec && kc.key == twins::Key::F4)
-            {
-                static bool mouse_on = true;
-                mouse_on = !mouse_on;
-                TWINS_LOG_I("Mouse %s", mouse_on ? "ON" : "OFF");
-                twins::mouseMode(mouse_on ? twins::MouseMode::M2 : twins::MouseMode::Off);
-                twins::flushBuffer();
-            }
-            else if (kc.m_spec && kc.key == twins::Key::F5)
-            {
-                twins::screenClrAll();
-                twins::flushBuffer();
+                // display decoded key
+                if (kc.key == twins::Key::MouseEvent)
+                {
+                    TWINS_LOG_D("B%c %c%c%c %03d:%03d",
+                        '0' + (char)kc.mouse.btn,
+                        kc.m_ctrl ? 'C' : ' ',
+                        kc.m_alt ? 'A' : ' ',
+                        kc.m_shift ? 'S' : ' ',
+                        kc.mouse.col, kc.mouse.row);
+                }
+                else if (kc.key != twins::Key::None)
+                {
+                    TWINS_LOG_D("Key: '%s'", kc.name);
+                }
 
-                // draw windows from bottom to top
-                twins::glob::wMngr.redrawAll();
-            }
-            else if (kc.m_spec && kc.key == twins::Key::F6)
-            {
-                twins::cursorSavePos();
-                twins::moveTo(0, twins::glob::pal.getLogsRow());
-                twins::screenClrBelow();
-                twins::cursorRestorePos();
-            }
-            else if (kc.m_spec && kc.m_ctrl && (kc.key == twins::Key::PgUp || kc.key == twins::Key::PgDown))
-            {
-                if (twins::glob::wMngr.topWnd() == &wndMain)
-                    twins::wgt::selectNextPage(wndMain.getWidgets(), ID_PGCONTROL, kc.key == twins::Key::PgDown);
-            }
-            else if (kc.m_spec && (kc.key == twins::Key::F9 || kc.key == twins::Key::F10))
-            {
-                if (twins::glob::wMngr.topWnd() == &wndMain)
-                    twins::wgt::selectNextPage(wndMain.getWidgets(), ID_PGCONTROL, kc.key == twins::Key::F10);
-            }
 
+                if (kc.m_spec && kc.key == twins::Key::F2)
+                {
+                    wndMain.wndEnabled = !wndMain.wndEnabled;
+                    wndMain.invalidate(ID_WND);
+                }
+                else if (kc.m_spec && kc.key == twins::Key::F4)
+                {
+                    static bool mouse_on = true;
+                    mouse_on = !mouse_on;
+                    TWINS_LOG_I("Mouse %s", mouse_on ? "ON" : "OFF");
+                    twins::mouseMode(mouse_on ? twins::MouseMode::SGR : twins::MouseMode::Off);
+                    twins::flushBuffer();
+                }
+                else if (kc.m_spec && kc.key == twins::Key::F5)
+                {
+                    twins::screenClrAll();
+                    twins::flushBuffer();
+
+                    // draw windows from bottom to top
+                    twins::glob::wMngr.redrawAll();
+                }
+                else if (kc.m_spec && kc.key == twins::Key::F6)
+                {
+                    twins::cursorSavePos();
+                    twins::moveTo(0, twins::glob::pal.getLogsRow());
+                    twins::screenClrBelow();
+                    twins::cursorRestorePos();
+                }
+                else if (kc.m_spec && kc.m_ctrl && (kc.key == twins::Key::PgUp || kc.key == twins::Key::PgDown))
+                {
+                    if (twins::glob::wMngr.topWnd() == &wndMain)
+                        for (int r = kc.repeatCount(); r > 0; r--)
+                            twins::wgt::selectNextPage(wndMain.getWidgets(), ID_PGCONTROL, kc.key == twins::Key::PgDown);
+                }
+                else if (kc.m_spec && (kc.key == twins::Key::F9 || kc.key == twins::Key::F10))
+                {
+                    if (twins::glob::wMngr.topWnd() == &wndMain)
+                        twins::wgt::selectNextPage(wndMain.getWidgets(), ID_PGCONTROL, kc.key == twins::Key::F10);
+                }
+
+                if (kc.mod_all != KEY_MOD_SPECIAL)
+                    draw_leds = true;
+            }
 
             if (twins::glob::wMngr.topWnd() == &wndMain)
             {
@@ -797,7 +825,7 @@ static void gui()
                 twins::cursorSavePos();
                 wndMain.invalidate({ID_LABEL_KEYSEQ, ID_LABEL_KEYNAME});
 
-                if (kc.mod_all != KEY_MOD_SPECIAL)
+                if (draw_leds)
                 {
                     twins::drawWidgets(wndMain.getWidgets(),
                     {
@@ -817,11 +845,31 @@ static void gui()
         }
 
         twins::flushBuffer();
-    }
+
+        // lone Esc - decode it again after the Esc timeout
+        if (uint16_t esc_wait_ms = twins::decodeInputSeqEscPending())
+            if (rbKeybInput.size() && !loop.isTimerActive(esc_timer))
+                esc_timer = loop.addTimer(esc_wait_ms, process_input, false);
+    };
+
+    loop.addInput(twins::inputPosixFd(), rbKeybInput, [&](twins::RingBuff<char> &rb, bool eof)
+    {
+        char c = 0;
+        rb.copy(&c, 1);
+
+        // lone Ctrl+D
+        if (eof || (rb.size() == 1 && c == (char)twins::Ansi::EOT))
+            loop.quit();
+        else
+            process_input();
+    });
+
+    loop.run();
 
     twins::moveTo(0, twins::glob::pal.getLogsRow());
     twins::screenClrBelow();
     twins::mouseMode(twins::MouseMode::Off);
+    twins::bracketedPaste(false);
     twins::flushBuffer();
     twins::inputPosixFree();
 }
@@ -905,27 +953,54 @@ static void cli()
 
     twins::writeStr(ESC_INVERSE_ON "TWins CLI mode; type 'help' for commands (Ctrl+D - quit)" ESC_INVERSE_OFF "\n");
     twins::inputPosixInit(100);
+    twins::bracketedPaste(true);
     twins::cli::prompt(false);
     twins::flushBuffer();
     // ensure cursor moves to next line after Enter is hit
     twins::cli::echoNlAfterCr = true;
 
-    for (;;)
+    twins::RingBuff<char> rbInput;
+    rbInput.init(80);
+
+    twins::EventLoop loop;
+    int esc_timer = 0;
+    std::function<void()> process_input;
+
+    process_input = [&]()
     {
-        const char *posix_inp = twins::inputPosixRead(quit_req);
+        // add new data or process state machine
+        twins::cli::processInput(rbInput);
+        // execute if command completed; pasted text may bring several commands
+        while (twins::cli::checkAndExec(commands)) {}
+        twins::flushBuffer();
+
+        // lone Esc - process it again after the Esc timeout
+        if (uint16_t esc_wait_ms = twins::decodeInputSeqEscPending())
+            if (rbInput.size() && !loop.isTimerActive(esc_timer))
+                esc_timer = loop.addTimer(esc_wait_ms, process_input, false);
+    };
+
+    loop.addInput(twins::inputPosixFd(), rbInput, [&](twins::RingBuff<char> &rb, bool eof)
+    {
+        char c = 0;
+        rb.copy(&c, 1);
+
+        // lone Ctrl+D
+        if (eof || (rb.size() == 1 && c == (char)twins::Ansi::EOT))
+            quit_req = true;
+        else
+            process_input();
+
         if (quit_req)
         {
             twins::writeStr(ESC_FG_MAGENTA "QUIT requested" ESC_FG_DEFAULT);
-            break;
+            loop.quit();
         }
+    });
 
-        // add new data or process state machine
-        twins::cli::processInput(posix_inp);
-        // execute if command completed
-        twins::cli::checkAndExec(commands);
-        twins::flushBuffer();
-    }
+    loop.run();
 
+    twins::bracketedPaste(false);
     twins::writeStr("\r\n");
     twins::flushBuffer();
     twins::inputPosixFree();
@@ -907,6 +907,13 @@ static constexpr twins::Widget wndPopup =
 constexpr auto wndMainWidgets = twins::transforWindowDefinition<&wndMain>();
 const twins::Widget * pWndMainWidgets = wndMainWidgets.begin();
 const uint16_t wndMainNumPages = twins::getPagesCount(&wndMain);
+constexpr auto wndMainFocusOrder = twins::transformWindowFocusOrder<&wndMain>();
+const twins::FocusEntry * pWndMainFocusOrder = wndMainFocusOrder.begin();
+constexpr auto wndMainColumns = twins::transformWindowColumns<&wndMain>();
+const twins::WidgetColumns wndMainWidgetColumns = wndMainColumns.getColumns();
 
-constexpr auto wndPopupWidgets = twins::transforWindowDefinition<&wndPopup>();
-const twins::Widget * pWndPopupWidgets = wndPopupWidgets.begin();
+// popup uses only the compact form, without the Widget array
+constexpr auto wndPopupFocusOrder = twins::transformWindowFocusOrder<&wndPopup>();
+const twins::FocusEntry * pWndPopupFocusOrder = wndPopupFocusOrder.begin();
+constexpr auto wndPopupColumns = twins::transformWindowColumns<&wndPopup>();
+const twins::WidgetColumns wndPopupWidgetColumns = wndPopupColumns.getColumns();
@@ -0,0 +1,88 @@
+#!/usr/bin/env python3
+
+# Generates lib/src/twins_string_width_tbl.hpp - two-stage character width table
+# used by twins::String::charWidth()
+#
+# Width rules (as in wcwidth):
+#   0 - combining marks (Mn, Me), format characters (Cf, except soft hyphen),
+#       Hangul medial vowels and final consonants
+#   2 - East Asian Wide and Fullwidth characters
+#   1 - everything else
+#
+# usage: python3 doc/gen-width-table.py > lib/src/twins_string_width_tbl.hpp
+
+import sys
+import unicodedata
+
+TABLE_END = 0x20000 # code points above are handled explicitly
+BLOCK_SHIFT = 7
+BLOCK_SIZE = 1 << BLOCK_SHIFT
+
+def char_width(cp):
+    c = chr(cp)
+    cat = unicodedata.category(c)
+    if cp == 0x00AD:
+        return 1
+    if cat in ('Mn', 'Me', 'Cf'):
+        return 0
+    if 0x1160 <= cp <= 0x11FF:
+        return 0
+    if unicodedata.east_asian_width(c) in ('W', 'F'):
+        return 2
+    return 1
+
+def pack_block(first):
+    out = []
+    for i in range(0, BLOCK_SIZE, 4):
+        b = 0
+        for j in range(4):
+            b |= char_width(first + i + j) << (j * 2)
+        out.append(b)
+    return tuple(out)
+
+def main():
+    blocks = []
+    block_idx = {}
+    stage1 = []
+
+    for first in range(0, TABLE_END, BLOCK_SIZE):
+        blk = pack_block(first)
+        if blk not in block_idx:
+            block_idx[blk] = len(blocks)
+            blocks.append(blk)
+        stage1.append(block_idx[blk])
+
+    assert len(blocks) < 256
+
+    w = sys.stdout.write
+    w('/******************************************************************************\n')
+    w(' * @brief   TWins - character width table\n')
+    w(' *          generated by doc/gen-width-table.py, Unicode %s - do not edit\n' % unicodedata.unidata_version)
+    w(' * @author  Mariusz Midor\n')
+    w(' *          https://bitbucket.org/marmidr/twins\n')
+    w(' *          https://github.com/marmidr/twins\n')
+    w(' *****************************************************************************/\n\n')
+    w('#pragma once\n\n')
+    w('#include <stdint.h>\n\n')
+    w('// -----------------------------------------------------------------------------\n\n')
+    w('namespace twins\n{\n\n')
+    w('static constexpr uint32_t WIDTH_TBL_END = 0x%X;\n' % TABLE_END)
+    w('static constexpr unsigned WIDTH_TBL_BLOCK_SHIFT = %d;\n\n' % BLOCK_SHIFT)
+    w('/** @brief Stage 1: code point >> %d -> block index in widthTblBlocks */\n' % BLOCK_SHIFT)
+    w('static const uint8_t widthTblIndex[%d] =\n{\n' % len(stage1))
+    for i in range(0, len(stage1), 16):
+        w('    ' + ' '.join('%3d,' % v for v in stage1[i:i+16]) + '\n')
+    w('};\n\n')
+    w('/** @brief Stage 2: %d code points per block, 2 bits per code point */\n' % BLOCK_SIZE)
+    w('static const uint8_t widthTblBlocks[%d][%d] =\n{\n' % (len(blocks), BLOCK_SIZE // 4))
+    for n, blk in enumerate(blocks):
+        w('    { // %d\n' % n)
+        for i in range(0, len(blk), 16):
+            w('        ' + ' '.join('0x%02X,' % v for v in blk[i:i+16]) + '\n')
+        w('    },\n')
+    w('};\n\n')
+    w('// -----------------------------------------------------------------------------\n\n')
+    w('} // namespace\n')
+
+if __name__ == '__main__':
+    main()
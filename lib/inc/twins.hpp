@@ -198,6 +198,16 @@ enum class ButtonStyle : uint8_t
  */
 using WID = uint16_t;
 
+/**
+ * @brief Tab-order table entry, generated in compile-time by transformWindowFocusOrder();
+ *        table is terminated by entry with wgtIdx == 0
+ */
+struct FocusEntry
+{
+    uint16_t wgtIdx;    /// focusable widget index in the window widgets array
+    uint16_t scopeIdx;  /// index of the nearest Page (or the Window) the Tab navigation cycles within
+};
+
 // moved to external file so it will not be taken into coverage
 #include "twins_window_state.hpp"
 
@@ -361,6 +371,27 @@ struct Widget
     } link;
 };
 
+/**
+ * @brief Compact, column-wise form of the window widgets, generated in compile-time by transformWindowColumns();
+ *        fields used by every widget are kept in separate columns, type-specific properties
+ *        in per-type tables, so the window does not need the Widget array at all
+ * @note  Without the Widget array, state callbacks get pointer to temporary widget copy - do not keep it;
+ *        functions navigating by the widget pointer (getScreenCoord(), getWidgetParent(), wgt::getPageID()...)
+ *        require the Widget array; draw and process such window with drawWidgets(state,...)/processInput(state,...)
+ */
+struct WidgetColumns
+{
+    const WID      *pIds;           /// widget ID
+    const uint8_t  *pTypes;         /// Widget::Type
+    const uint16_t *pParentIdxs;    /// parent index
+    const uint16_t *pChildrenIdxs;  /// first child index
+    const uint8_t  *pChildrenCnts;  /// number of children
+    const Rect     *pRects;         /// position relative to the Window (Window: its own position) and size
+    const uint16_t *pPropIdxs;      /// index in the properties table of the widget type
+    const void     *pProps[Widget::_Count]; /// per-type properties tables, eg. decltype(Widget::label)[]
+    uint16_t        count;          /// number of widgets, terminator excluded
+};
+
 static constexpr WID WIDGET_ID_NONE = 0;    // convenient; default value points to nothing
 static constexpr WID WIDGET_ID_ALL = -1;
 
@@ -390,6 +421,7 @@ struct WidgetProp
         {
             int16_t itemIdx;
             int16_t selIdx;
+            int16_t itemsCount;
         } lbx;
 
         struct
@@ -397,6 +429,7 @@ struct WidgetProp
             int16_t itemIdx;
             int16_t selIdx;
             bool    dropDown;
+            int16_t itemsCount;
         } cbbx;
 
         struct
@@ -441,7 +474,9 @@ enum class MouseMode : uint8_t
 {
     Off,
     M1,
-    M2
+    M2,
+    SGR,        // M2 with SGR extended reports
+    SGRMotion,  // M2 + motion, with SGR extended reports
 };
 
 // -----------------------------------------------------------------------------
@@ -545,14 +580,55 @@ inline void screenRestore(void)     { writeStr(ESC_SCREEN_RESTORE); }
  */
 void mouseMode(MouseMode mode);
 
+/**
+ * @brief Bracketed paste mode; when enabled, pasted text is decoded as single Key::Paste
+ * @note  Text is truncated to TWINS_PASTE_MAX_LENGTH bytes, the size of the static paste buffer
+ */
+void bracketedPaste(bool on);
+
 // -----------------------------------------------------------------------------
 
 /**
  * @brief Decode ANSI keyboard/mouse sequence from \p input and produce readable Key Code \p output
+ * @note  Bytes of pasted text are consumed as they arrive; Key::Paste is returned after the end marker
  * @return Length of sequence if decoded, 0 otherwise
  */
 uint8_t decodeInputSeq(RingBuff<char> &input, KeyCode &output);
 
+/**
+ * @brief Decode ANSI sequence from the lock-free \p input, filled eg. by the UART interrupt
+ */
+uint8_t decodeInputSeq(SpscRingBuff<char> &input, KeyCode &output);
+
+/**
+ * @brief Decode all complete sequences from \p input, but no more than \p count, into \p pOutput array
+ * @note  KeyCode::name of a text key points to its own \c utf8 member;
+ *        decoding stops after Key::Paste, as the next paste would overwrite its text;
+ *        wheel steps and mouse motion reports are merged into single KeyCode - see KeyCode::repeat;
+ *        with \p mergeKeys, also runs of the same Up/Down/PgUp/PgDown keys are merged -
+ *        then every receiver of these keys, including the window and application handlers,
+ *        must apply KeyCode::repeatCount(), or the key presses are lost
+ * @return Number of decoded Key Codes
+ */
+uint16_t decodeInputSeqBatch(RingBuff<char> &input, KeyCode *pOutput, uint16_t count, bool mergeKeys = false);
+uint16_t decodeInputSeqBatch(SpscRingBuff<char> &input, KeyCode *pOutput, uint16_t count, bool mergeKeys = false);
+
+/**
+ * @brief Set time after which lone ESC, not followed by the rest of a sequence, is decoded as Key::Esc;
+ *        default is TWINS_ESC_TIMEOUT_MS; 0 decodes lone ESC immediately.
+ * @note  Time is measured with IPal::getTimeStamp(); if it does not advance (PAL without a clock),
+ *        the ESC is decoded on the second attempt; until decoded, the ESC stays in the input buffer,
+ *        so keep calling decodeInputSeq() while the buffer is not empty
+ */
+void decodeInputSeqEscTimeout(uint16_t timeoutMs);
+
+/**
+ * @brief Returns time [ms] after which the lone ESC, left in the input buffer, is to be decoded again;
+ *        0 if decoder does not wait for the ESC timeout
+ * @note  Incomplete UTF-8 sequence also stays in the buffer, but only new data can complete it
+ */
+uint16_t decodeInputSeqEscPending();
+
 // -----------------------------------------------------------------------------
 
 /**
@@ -579,6 +655,17 @@ inline void drawWidget(const Widget *pWindowWidgets, WID widgetId = WIDGET_ID_AL
     drawWidgets(pWindowWidgets, &widgetId, 1);
 }
 
+/**
+ * @brief Draw selected widgets of the window given by its \p state;
+ *        the only way to draw the window defined by WidgetColumns alone, without the Widget array
+ */
+void drawWidgets(IWindowState &state, const WID *pWidgetIds, uint16_t count);
+
+inline void drawWidget(IWindowState &state, WID widgetId = WIDGET_ID_ALL)
+{
+    drawWidgets(state, &widgetId, 1);
+}
+
 /**
  * @brief Return widget type as string
  */
@@ -604,6 +691,36 @@ const Widget* getWidgetParent(const Widget *pWgt);
  */
 bool processInput(const Widget *pWindow, const KeyCode &kc);
 
+/**
+ * @brief Process keyboard/mouse signal for the window given by its \p state;
+ *        works also for the window defined by WidgetColumns alone
+ */
+bool processInput(IWindowState &state, const KeyCode &kc);
+
+/**
+ * @brief Process \p count keyboard/mouse signals from \p pKeys array, the same as processInput() does;
+ *        widgets invalidated meanwhile are redrawn once, after the whole batch - see deferRedraw();
+ *        batch stops after the key that caused flushDeferredRedraw(), eg. WndManager showed another window,
+ *        as the remaining keys are for the new top window
+ * @param pProcessed if given, receives number of processed Key Codes
+ * @return Number of handled Key Codes
+ */
+uint16_t processInputBatch(const Widget *pWindow, const KeyCode *pKeys, uint16_t count, uint16_t *pProcessed = nullptr);
+uint16_t processInputBatch(IWindowState &state, const KeyCode *pKeys, uint16_t count, uint16_t *pProcessed = nullptr);
+
+/**
+ * @brief Called by invalidateImpl(); while processInputBatch() runs for the \p state,
+ *        stores the \p pIds to be drawn after the batch
+ * @return \b true if stored, so the widgets must not be drawn now
+ */
+bool deferRedraw(IWindowState &state, const WID *pIds, uint16_t count);
+
+/**
+ * @brief Draw the widgets stored by deferRedraw() and stop the running processInputBatch() after the current key;
+ *        called by WndManager before the windows are changed
+ */
+void flushDeferredRedraw();
+
 /**
  * @brief Check if widget is visible, checking all its parents
  */
@@ -622,7 +739,7 @@ void resetInternalState(void);
 /**
  * @brief Checks if point is withing rectangle
  */
-bool isPointWithin(uint8_t col, uint8_t row, const Rect& r);
+bool isPointWithin(uint16_t col, uint16_t row, const Rect& r);
 
 /**
  * @brief Checks if internal rect \p i is within or covers external rectangle \p e
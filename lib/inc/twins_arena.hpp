@@ -0,0 +1,143 @@
+/******************************************************************************
+ * @brief   TWins - arena (bump) allocator
+ * @author  Mariusz Midor
+ *          https://bitbucket.org/marmidr/twins
+ *          https://github.com/marmidr/twins
+ *****************************************************************************/
+
+#pragma once
+#include "twins_common.hpp"
+
+#include <stdint.h>
+#include <assert.h>
+
+/** @brief Size of the arena used by drawing routines; 0 disables the arena */
+#ifndef TWINS_FRAME_ARENA_SIZE
+# define TWINS_FRAME_ARENA_SIZE 2048
+#endif
+
+// -----------------------------------------------------------------------------
+
+namespace twins
+{
+
+/**
+ * @brief Simple bump allocator on fixed buffer;
+ *        blocks are never freed separately - the arena is rewound as a whole
+ */
+class Arena
+{
+public:
+    Arena(void *pBuff, uint32_t size) : mpBuff((uint8_t*)pBuff), mSize(size) {}
+
+    /** @brief Return aligned block or nullptr if arena is exhausted */
+    void* alloc(uint32_t sz)
+    {
+        uint32_t offs = (mUsed + (ALIGN-1)) & ~(ALIGN-1);
+        if (!sz || offs + sz > mSize)
+            return nullptr;
+
+        mUsed = offs + sz;
+        if (mUsed > mUsedMax)
+            mUsedMax = mUsed;
+        return mpBuff + offs;
+    }
+
+    /** @brief Check if \p ptr points to block allocated from this arena */
+    bool owns(const void *ptr) const
+    {
+        return ((const uint8_t*)ptr >= mpBuff) && ((const uint8_t*)ptr < mpBuff + mSize);
+    }
+
+    /** @brief Current position; use it with rewind() */
+    uint32_t mark() const { return mUsed; }
+    /** @brief Release all blocks allocated after the \p mark was taken */
+    void rewind(uint32_t mark) { if (mark < mUsed) mUsed = mark; }
+    void reset() { mUsed = 0; }
+
+    uint32_t size() const { return mSize; }
+    uint32_t used() const { return mUsed; }
+    /** @brief Peak usage; useful to tune TWINS_FRAME_ARENA_SIZE */
+    uint32_t usedMax() const { return mUsedMax; }
+
+private:
+    static constexpr uint32_t ALIGN = sizeof(void*);
+
+    uint8_t *mpBuff;
+    uint32_t mSize;
+    uint32_t mUsed = 0;
+    uint32_t mUsedMax = 0;
+};
+
+/** @brief Arena for temporaries of the drawing functions */
+Arena& frameArena();
+
+/** @brief Allocate \p sz bytes, from frame arena if \p fromArena and it has enough space,
+ *         otherwise from the PAL heap */
+void* frameAlloc(uint32_t sz, bool fromArena = true);
+/** @brief Free block allocated by frameAlloc() */
+void  frameFree(void *ptr);
+
+/** @brief Containers allocator using frame arena */
+struct FrameAllocator
+{
+    static void* memAlloc(uint32_t sz) { return frameAlloc(sz); }
+    static void  memFree(void *ptr) { frameFree(ptr); }
+};
+
+/**
+ * @brief Rewinds frame arena when leaving the scope;
+ *        blocks allocated within the scope must not be used after that
+ */
+class FrameArenaScope
+{
+public:
+    FrameArenaScope() : mMark(frameArena().mark()) {}
+    ~FrameArenaScope() { frameArena().rewind(mMark); }
+
+    FrameArenaScope(const FrameArenaScope&) = delete;
+    FrameArenaScope& operator=(const FrameArenaScope&) = delete;
+
+private:
+    uint32_t mMark;
+};
+
+/**
+ * @brief Fixed-size temporary array, placed in the frame arena
+ */
+template <typename T>
+class FrameArray
+{
+public:
+    FrameArray(uint16_t capacity)
+    {
+        if (capacity)
+        {
+            mpItems = (T*)frameAlloc(capacity * sizeof(T));
+            mCapacity = capacity;
+        }
+    }
+
+    ~FrameArray() { frameFree(mpItems); }
+
+    FrameArray(const FrameArray&) = delete;
+    FrameArray& operator=(const FrameArray&) = delete;
+
+    void append(const T &item) { assert(mSize < mCapacity); if (mSize < mCapacity) mpItems[mSize++] = item; }
+    T* data() { return mpItems; }
+    const T* data() const { return mpItems; }
+    uint16_t size() const { return mSize; }
+    const T* begin() const { return mpItems; }
+    const T* end() const { return mpItems + mSize; }
+    const T& operator[](uint16_t idx) const { return mpItems[idx]; }
+    T& operator[](uint16_t idx) { return mpItems[idx]; }
+
+private:
+    T *mpItems = nullptr;
+    uint16_t mSize = 0;
+    uint16_t mCapacity = 0;
+};
+
+// -----------------------------------------------------------------------------
+
+} // namespace
@@ -7,6 +7,7 @@
 
 #pragma once
 #include "twins_vector.hpp"
+#include "twins_small_vector.hpp"
 #include "twins_string.hpp"
 #include "twins_ringbuffer.hpp"
 
@@ -22,7 +23,7 @@
 namespace twins::cli
 {
 
-using Argv = Vector<const char*>;
+using Argv = SmallVector<const char*, 8>;
 using CmdHandler = std::function<void(twins::cli::Argv &argv)>;
 
 #define TWINS_CLI_HANDLER  [](twins::cli::Argv &argv)
@@ -53,6 +54,17 @@ extern bool verbose;
 /** @brief Echo NL if CR (Enter) key detected */
 extern bool echoNlAfterCr;
 
+/** @brief Handling of line breaks in the pasted text (see twins::bracketedPaste()) */
+enum class PasteNewline : uint8_t
+{
+    Execute,    // every complete line is queued for execution, as if Enter was pressed
+    Space,      // line breaks are replaced with space
+    Ignore,     // text after the first line break is dropped
+};
+
+/** @brief Line breaks handling in the pasted text; default: PasteNewline::Execute */
+extern PasteNewline pasteNewline;
+
 /**
  * @brief Reset internal state: buffers, counters, cursor
  */
@@ -78,6 +90,11 @@ void processInput(const char* data, uint8_t dataLen = 0);
  */
 void processInput(twins::RingBuff<char> &rb);
 
+/**
+ * @brief Process the lock-free ring buffer \p rb, filled eg. by the UART interrupt
+ */
+void processInput(twins::SpscRingBuff<char> &rb);
+
 /**
  * @brief CRLF >
  */
@@ -58,6 +58,15 @@ struct Array
     T data[N] = {};
 };
 
+/** @brief Empty array; no storage at all */
+template <typename T>
+struct Array<T, 0>
+{
+    constexpr const T* begin()                const { return nullptr; }
+    constexpr const T* end()                  const { return nullptr; }
+    constexpr unsigned size()                 const { return 0; }
+};
+
 
 /** @brief Structure holding pointer to first array element and the array size */
 template <typename T>
@@ -75,12 +84,26 @@ using CStrView = twins::Span<const char>;
  */
 struct IPal
 {
+    /** @brief Statistics of one memory pool size-class */
+    struct PoolStats
+    {
+        uint16_t blockSize;
+        uint16_t blocksTotal;
+        uint16_t blocksUsed;
+        uint16_t blocksUsedMax;     // high-water mark
+        uint16_t failures;          // requests of this size-class that found no free block
+    };
+
     struct Stats
     {
         uint16_t memChunks;
         uint16_t memChunksMax;
         int32_t  memAllocated;
         int32_t  memAllocatedMax;
+        uint32_t memAllocCount;     // total number of allocations; useful to measure allocations per frame
+        const PoolStats *pPools;    // per size-class statistics; set by pool-based PAL
+        uint8_t  poolsCount;
+        uint32_t poolFallbacks;     // allocations served by general heap instead of pools
     };
 
     virtual ~IPal() = default;
@@ -108,6 +131,20 @@ struct IPal
 // pointer set by init()
 extern IPal *pPAL;
 
+/** @brief Containers allocator using the PAL heap */
+struct PalAllocator
+{
+    static void* memAlloc(uint32_t sz) { return pPAL->memAlloc(sz); }
+    static void  memFree(void *ptr) { pPAL->memFree(ptr); }
+};
+
+/** @brief Allocator for fixed-capacity containers - never allocates */
+struct NoAllocator
+{
+    static void* memAlloc(uint32_t) { return nullptr; }
+    static void  memFree(void *) {}
+};
+
 
 
 /**
@@ -186,7 +223,8 @@ enum class Key : uint8_t
     F11,
     F12,
     //
-    MouseEvent
+    MouseEvent,
+    Paste
 };
 
 /** Mouse button click events */
@@ -201,6 +239,7 @@ enum class MouseBtn : uint8_t
     ButtonReleased,
     WheelUp,
     WheelDown,
+    Motion,
 };
 
 /** Key modifiers */
@@ -228,9 +267,9 @@ struct KeyCode
             Key      key;
             /** button or wheel event */
             MouseBtn btn;
-            /** 1:1 based terminal coordinates of the event */
-            uint8_t  col;
-            uint8_t  row;
+            /** 1:1 based terminal coordinates of the event; SGR mode reports them beyond 255 */
+            uint16_t col;
+            uint16_t row;
         } mouse;
     };
 
@@ -246,7 +285,17 @@ struct KeyCode
         };
     };
 
+    /** number of identical events (navigation keys, wheel steps, motion reports) coalesced into this one;
+     *  0 is treated as 1 */
+    uint8_t repeat = 0;
+
+    /** used for Key::Paste: pasted text, NUL terminated; valid until the next paste is decoded */
+    CStrView paste = {};
+
     const char *name = nullptr;
+
+    /** @brief Number of events represented by this one */
+    uint8_t repeatCount() const { return repeat ? repeat : 1; }
 };
 
 struct NonCopyable
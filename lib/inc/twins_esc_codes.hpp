@@ -527,6 +527,20 @@
 #define ESC_MOUSE_REPORTING_M2_ON       ANSI_CSI("?1000h")
 #define ESC_MOUSE_REPORTING_M2_OFF      ANSI_CSI("?1000l")
 
+// Mode3: Mode2 + motion, even with no button pressed
+#define ESC_MOUSE_REPORTING_M3_ON       ANSI_CSI("?1003h")
+#define ESC_MOUSE_REPORTING_M3_OFF      ANSI_CSI("?1003l")
+
+// SGR extended reports: ESC [ < b ; col ; row M/m - no 223 coordinates limit, release reported with button code
+#define ESC_MOUSE_REPORTING_SGR_ON      ANSI_CSI("?1006h")
+#define ESC_MOUSE_REPORTING_SGR_OFF     ANSI_CSI("?1006l")
+
+// Bracketed paste: pasted text is wrapped with ESC_PASTE_BEGIN and ESC_PASTE_END markers
+#define ESC_BRACKETED_PASTE_ON          ANSI_CSI("?2004h")
+#define ESC_BRACKETED_PASTE_OFF         ANSI_CSI("?2004l")
+#define ESC_PASTE_BEGIN                 ANSI_CSI("200~")
+#define ESC_PASTE_END                   ANSI_CSI("201~")
+
 //@}
 
 /*******************************************************************************
@@ -551,7 +565,7 @@
 #define ESC_REPORT_CAPABILITIES         ANSI_CSI("c")
 
 /** @brief Maximum ESC sequence length (including null) */
-#define ESC_SEQ_MAX_LENGTH              8
+#define ESC_SEQ_MAX_LENGTH              20
 
 // bash: blink screen until key pressed
 // { while true; do printf \\e[?5h; sleep 0.3; printf \\e[?5l; read -s -n1 -t1 && break; done; }
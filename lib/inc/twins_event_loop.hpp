@@ -0,0 +1,118 @@
+/******************************************************************************
+ * @brief   TWins - event loop - POSIX
+ * @author  Mariusz Midor
+ *          https://bitbucket.org/marmidr/twins
+ *          https://github.com/marmidr/twins
+ *****************************************************************************/
+
+#pragma once
+#include "twins_common.hpp"
+#include "twins_ringbuffer.hpp"
+#include "twins_vector.hpp"
+
+#include <stdint.h>
+#include <poll.h>
+#include <atomic>
+#include <functional>
+
+// -----------------------------------------------------------------------------
+
+namespace twins
+{
+
+/**
+ * @brief Single-threaded event loop: sleeps until a watched file descriptor is readable
+ *        or a timer expires, so idle application does not consume CPU;
+ *        only wakeup() and quit() may be called from other threads
+ * @example
+ *   twins::EventLoop loop;
+ *   loop.addInput(twins::inputPosixFd(), rbKeybInput, [](twins::RingBuff<char> &rb, bool eof) { ... });
+ *   loop.addTimer(500, []() { ... });
+ *   loop.run();
+ */
+class EventLoop : NonCopyable
+{
+public:
+    /** @brief Called when \p fd has data to read; handler reads it by itself */
+    using FdHandler = std::function<void(int fd)>;
+    /** @brief Called when new data were read to \p rb, or \p eof was reached (source is removed then) */
+    using InputHandler = std::function<void(RingBuff<char> &rb, bool eof)>;
+    using TimerHandler = std::function<void(void)>;
+
+    EventLoop();
+    ~EventLoop();
+
+    /** @brief Watch the \p fd; returns \b false if already registered */
+    bool addFd(int fd, FdHandler handler);
+
+    /** @brief Watch the \p fd and read all available data directly into \p rb, before calling \p handler;
+     *         handler should consume the data, as the \p fd is not watched while the \p rb is full;
+     *         returns \b false if already registered */
+    bool addInput(int fd, RingBuff<char> &rb, InputHandler handler);
+
+    /** @brief Stop watching \p fd; the descriptor is not closed */
+    void removeFd(int fd);
+
+    /** @brief Call \p handler after \p periodMs, then every \p periodMs if \p periodic;
+     *  @return timer ID, > 0 */
+    int addTimer(uint32_t periodMs, TimerHandler handler, bool periodic = true);
+
+    /** @brief Cancel the timer */
+    void removeTimer(int timerId);
+
+    /** @brief Check if timer is still active; one-shot timer expires after its handler is called */
+    bool isTimerActive(int timerId) const;
+
+    /** @brief Set handler called by the loop after wakeup() */
+    void setWakeupHandler(TimerHandler handler);
+
+    /** @brief Thread safe; interrupts waiting and calls the wakeup handler, eg. to redraw invalidated widgets */
+    void wakeup();
+
+    /** @brief Thread safe; run() returns as soon as possible */
+    void quit();
+
+    /** @brief Wait up to \p timeoutMs (-1: until an event) and dispatch events;
+     *  @return \b false if quit() was requested */
+    bool runOnce(int timeoutMs = -1);
+
+    /** @brief Dispatch events until quit() */
+    void run();
+
+private:
+    struct Source
+    {
+        int             fd;
+        FdHandler       fdHandler;
+        RingBuff<char> *pRb;
+        InputHandler    inputHandler;
+    };
+
+    struct Timer
+    {
+        int             id;
+        uint32_t        periodMs;
+        uint32_t        deadline;
+        bool            periodic;
+        TimerHandler    handler;
+    };
+
+    Source* findSource(int fd);
+    void readInput(Source &src);
+    void dispatchTimers();
+    /** @brief Remove entries marked for deletion while dispatching */
+    void compact();
+
+private:
+    Vector<Source>      mSources;
+    Vector<Timer>       mTimers;
+    Vector<pollfd>      mPollFds;
+    TimerHandler        mWakeupHandler;
+    int                 mWakeFd[2] = {-1, -1}; // read, write
+    int                 mLastTimerId = 0;
+    std::atomic<bool>   mQuit = {false};
+};
+
+// -----------------------------------------------------------------------------
+
+} // namespace
@@ -8,6 +8,7 @@
 #pragma once
 
 #include <stdint.h>
+#include <string.h>
 #include <type_traits>
 
 // -----------------------------------------------------------------------------
@@ -29,29 +30,40 @@ struct HashDefault
 
     template <typename Tp, typename std::enable_if<
         std::is_same<const char*, Tp>::value || std::is_same<char*, Tp>::value, int>::type = 0>
-    static uint16_t hash(Tp v)
+    static uint32_t hash(Tp v)
     {
-        return bernsteinHashImpl(v, strnlen(v, 15));
+        return bernsteinHashImpl(v, strlen(v));
     }
 
     template <typename Tp, typename std::enable_if<
         std::is_integral<Tp>::value || std::is_enum<Tp>::value, int>::type = 0>
-    static uint16_t hash(Tp v)
+    static uint32_t hash(Tp v)
     {
-        return bernsteinHashImpl(&v, sizeof(v));
+        // the value itself - unique for up to 32-bit keys; Map mixes the bits by itself
+        return foldU64(static_cast<uint64_t>(v));
     }
 
     template <typename Tp, typename std::enable_if<
         std::is_floating_point<Tp>::value, int>::type = 0>
-    static uint16_t hash(Tp v)
+    static uint32_t hash(Tp v)
     {
         // for both -0.0 and 0.0
-        return v != Tp{} ? bernsteinHashImpl(&v, sizeof(v)) : 0;
+        if (v == Tp{})
+            return 0;
+
+        uint64_t bits = 0;
+        memcpy(&bits, &v, sizeof(v) < sizeof(bits) ? sizeof(v) : sizeof(bits));
+        return foldU64(bits);
+    }
+
+    static uint32_t hash(bool v)
+    {
+        return static_cast<uint32_t>(v);
     }
 
-    static uint16_t hash(bool v)
+    static uint32_t foldU64(uint64_t v)
     {
-        return static_cast<uint16_t>(v);
+        return static_cast<uint32_t>(v ^ (v >> 32));
     }
 
 };
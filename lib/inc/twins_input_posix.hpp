@@ -26,6 +26,12 @@ void inputPosixFree();
   */
 const char * inputPosixRead(bool &quitRequested);
 
+/** @brief Terminal file descriptor, opened by inputPosixInit() in non-blocking mode;
+ *         use it with EventLoop::addInput() instead of polling with inputPosixRead()
+ * @return -1 if terminal is not available
+ */
+int inputPosixFd();
+
 // -----------------------------------------------------------------------------
 
 } // namespace
@@ -7,12 +7,12 @@
 
 #pragma once
 #include "twins_common.hpp"
-#include "twins_vector.hpp"
 #include "twins_hash.hpp"
 
 #include <utility>  // std::move
 #include <memory>   // new(addr) T()
 #include <type_traits>
+#include <string.h>
 
 // -----------------------------------------------------------------------------
 
@@ -20,13 +20,14 @@ namespace twins
 {
 
 /**
- * @brief Simple hashing map for Key-Value pairs
+ * @brief Simple hashing map for Key-Value pairs;
+ *        open addressing with Robin Hood probing - all nodes are kept in a single memory block
  */
 template<typename K, typename V, typename H = HashDefault>
 class Map
 {
 public:
-    using Hash = uint16_t;
+    using Hash = uint32_t;
 
     struct Node
     {
@@ -35,134 +36,131 @@ public:
         V       val;
     };
 
-    using Bucket = Vector<Node>;
-    using Buckets = Vector<Bucket>;
-
     class Iter
     {
-    public:
-        struct NodeIdx
-        {
-            uint16_t bktIdx;
-            uint16_t itemIdx;
-            bool operator ==(const NodeIdx& other) const { return bktIdx == other.bktIdx && itemIdx == other.itemIdx; }
-        };
-
     public:
         Iter(void) = delete;
 
         Iter(const Map<K, V, H> &map, bool begin)
-            : mBkts(map.mBuckets)
+            : mMap(map)
         {
-            if (begin)
-            {
-                mIdx.bktIdx = 0;
-                goToNextNonemptyBucket();
-            }
-            else
-            {
-                mIdx.bktIdx = mBkts.size();
-            }
-
-            mIdx.itemIdx = 0;
+            mIdx = begin ? 0 : map.mCapacity;
+            goToNextUsedSlot();
         }
 
         Iter(const Iter &other)
-            : mBkts(other.mBkts), mIdx(other.mIdx)
+            : mMap(other.mMap), mIdx(other.mIdx)
         {}
 
         bool operator == (const Iter &other) const { return mIdx == other.mIdx; }
-        bool operator != (const Iter &other) const { return !(mIdx == other.mIdx); }
+        bool operator != (const Iter &other) const { return mIdx != other.mIdx; }
         const Node * operator -> (void) const { return &operator*(); }
-        const Node & operator * (void)  const { return mBkts[mIdx.bktIdx][mIdx.itemIdx]; }
+        const Node & operator * (void)  const { return mMap.mpNodes[mIdx]; }
 
         // ++it
         const Iter& operator ++(void) const
         {
-            if (mIdx.bktIdx < mBkts.size())
+            if (mIdx < mMap.mCapacity)
             {
-                if (++mIdx.itemIdx >= mBkts[mIdx.bktIdx].size())
-                {
-                    mIdx.itemIdx = 0;
-                    mIdx.bktIdx++;
-                    goToNextNonemptyBucket();
-                }
+                mIdx++;
+                goToNextUsedSlot();
             }
 
             return *this;
         }
 
     private:
-        void goToNextNonemptyBucket() const
+        void goToNextUsedSlot() const
         {
-            while (mIdx.bktIdx < mBkts.size() && mBkts[mIdx.bktIdx].size() == 0)
-                mIdx.bktIdx++;
+            while (mIdx < mMap.mCapacity && mMap.mpDist[mIdx] == 0)
+                mIdx++;
         }
 
     protected:
-        const Buckets &mBkts;
-        mutable NodeIdx mIdx;
+        const Map<K, V, H> &mMap;
+        mutable uint32_t mIdx;
     };
 
 public:
     Map() = default;
-    ~Map() = default;
+    ~Map() { freeSlots(); }
 
-    /** @brief Direct access operator; return existing value, creates new otherwise */
-    V& operator[](const K &key)
+    Map(const Map &other) { *this = other; }
+    Map(Map &&other) noexcept { *this = std::move(other); }
+
+    Map& operator =(const Map &other)
     {
-        if (mBuckets.size() == 0)
+        if (this != &other)
         {
-            // initial buckets count
-            mBuckets.resize(4);
+            clear();
+            for (const auto &node : other)
+                (*this)[node.key] = node.val;
         }
+        return *this;
+    }
 
-        if (mNodes >= (mBuckets.size() * 4))
-            growBuckets();
-
-        auto &node = getNode(key);
-        return node.val;
+    Map& operator =(Map &&other) noexcept
+    {
+        if (this != &other)
+        {
+            freeSlots();
+            std::swap(mpNodes, other.mpNodes);
+            std::swap(mpDist, other.mpDist);
+            std::swap(mCapacity, other.mCapacity);
+            std::swap(mNodes, other.mNodes);
+        }
+        return *this;
     }
 
-    /** @brief Check if given key exists */
-    bool contains(const K &key) const
+    /** @brief Direct access operator; return existing value, creates new otherwise */
+    V& operator[](const K &key)
     {
-        if (!mBuckets.size())
-            return false;
+        const Hash hash = H::hash(key);
 
-        auto hash = H::hash(key);
-        auto bidx = getBucketIdx(hash);
-        const auto &bkt = mBuckets[bidx];
+        if (Node *p_node = findNode(key, hash))
+            return p_node->val;
 
-        for (auto &node : bkt)
-            if ((node.hash == hash) && keysEqual(node.key, key, key_is_cstr{}))
-                return true;
+        // max load factor: 3/4
+        if ((mNodes + 1) * 4 > mCapacity * 3)
+            growSlots();
 
-        return false;
+        mNodes++;
+        return mpNodes[insertNode(Node{hash, key, V{}})].val;
+    }
+
+    /** @brief Check if given key exists */
+    bool contains(const K &key) const
+    {
+        return findNode(key, H::hash(key)) != nullptr;
     }
 
     /** @brief Remove entry */
     void remove(const K &key)
     {
-        if (!mBuckets.size())
+        Node *p_node = findNode(key, H::hash(key));
+        if (!p_node)
             return;
 
-        auto hash = H::hash(key);
-        auto &bkt = mBuckets[getBucketIdx(hash)];
+        // backward-shift deletion: no tombstones
+        uint32_t idx = p_node - mpNodes;
+        uint32_t next = (idx + 1) & (mCapacity - 1);
+        mpNodes[idx].~Node();
 
-        for (uint16_t i = 0; i < bkt.size(); i++)
+        while (mpDist[next] > 1)
         {
-            if ((bkt[i].hash == hash) && keysEqual(bkt[i].key, key, key_is_cstr{}))
-            {
-                bkt.remove(i);
-                mNodes--;
-                break;
-            }
+            new (&mpNodes[idx]) Node(std::move(mpNodes[next]));
+            mpNodes[next].~Node();
+            mpDist[idx] = mpDist[next] - 1;
+            idx = next;
+            next = (next + 1) & (mCapacity - 1);
         }
+
+        mpDist[idx] = 0;
+        mNodes--;
     }
 
     /** @brief Return number of key-value pairs */
-    uint16_t size() const
+    uint32_t size() const
     {
         return mNodes;
     }
@@ -170,50 +168,36 @@ public:
     /** @brief Clear all map entries */
     void clear()
     {
-        if (mBuckets.size())
-        {
-            mNodes = 0;
-            mBuckets.resize(4);
-
-            for (auto &bkt : mBuckets)
-                bkt.clear();
-        }
+        freeSlots();
     }
 
-    /** @brief Number of buckets - for test purposes */
-    uint16_t bucketsCount() const
+    /** @brief Number of slots - for test purposes */
+    uint32_t bucketsCount() const
     {
-        return mBuckets.size();
+        return mCapacity;
     }
 
-    /** @brief Return given bucket - for test purposes */
-    const Bucket* bucket(int16_t idx) const
-    {
-        if (idx < 0 || (uint16_t)idx > bucketsCount())
-            return nullptr;
-
-        return &mBuckets[idx];
-    }
-
-    /** @brief Return elements distribution 0 (worse)..100% (best) */
+    /** @brief Return elements distribution 0 (worse)..100% (best) - average probe length
+     *         compared to the one expected for uniform hash at current load: (1 + 1/(1 - load)) / 2 */
     uint8_t distribution()
     {
         if (mNodes < 2)
             return 100;
 
-        unsigned expected_nodes_per_bkt = mNodes / mBuckets.size();
-        unsigned over_expected = 0;
+        uint64_t probes = 0;
 
-        if (expected_nodes_per_bkt < 2)
-            return 100;
+        for (uint32_t i = 0; i < mCapacity; i++)
+            probes += mpDist[i];
 
-        for (const auto &bkt : mBuckets)
-        {
-            if (bkt.size() > expected_nodes_per_bkt)
-                over_expected += bkt.size() - expected_nodes_per_bkt;
-        }
+        // both scaled by 2 * mNodes * (mCapacity - mNodes)
+        const uint64_t free_slots = mCapacity - mNodes;
+        const uint64_t expected = (uint64_t)mNodes * (free_slots + mCapacity);
+        const uint64_t actual = 2 * probes * free_slots;
 
-        return 100 - (100 * over_expected / mNodes);
+        if (actual <= expected)
+            return 100;
+
+        return 100 * expected / actual;
     }
 
     Iter begin(void) const  { return Iter(*this, true); }
@@ -225,10 +209,16 @@ private:
                             std::true_type, std::false_type
                         >::type;
 
-    inline uint16_t getBucketIdx(Hash hash) const
+    inline uint32_t getHomeIdx(Hash hash) const
     {
-        // mBuckets.size() must be power of 2
-        return hash & (mBuckets.size() - 1);
+        // murmur3 finalizer; spreads weak hashes over the low bits
+        hash ^= hash >> 16;
+        hash *= 0x85ebca6b;
+        hash ^= hash >> 13;
+        hash *= 0xc2b2ae35;
+        hash ^= hash >> 16;
+        // mCapacity must be power of 2
+        return hash & (mCapacity - 1);
     }
 
     template<typename Key>
@@ -243,45 +233,107 @@ private:
         return k1 == k2;
     }
 
-    Node& getNode(const K &key)
+    Node* findNode(const K &key, Hash hash) const
     {
-        auto hash = H::hash(key);
-        auto bidx = getBucketIdx(hash);
-        auto &bkt = mBuckets[bidx];
+        if (!mCapacity)
+            return nullptr;
 
-        for (auto &node : bkt)
-            if ((node.hash == hash) && keysEqual(node.key, key, key_is_cstr{}))
-                return node;
+        uint32_t idx = getHomeIdx(hash);
 
-        auto &node = mBuckets[bidx].append();
-        mNodes++;
-        node.hash = hash;
-        node.key = key;
-        return node;
+        // nodes on probed path that are closer to their home than we - key not found
+        for (uint32_t dist = 1; mpDist[idx] >= dist; dist++)
+        {
+            if ((mpNodes[idx].hash == hash) && keysEqual(mpNodes[idx].key, key, key_is_cstr{}))
+                return &mpNodes[idx];
+
+            idx = (idx + 1) & (mCapacity - 1);
+        }
+
+        return nullptr;
     }
 
-    void growBuckets()
+    /** @brief Insert new node; return index of the slot where it was placed */
+    uint32_t insertNode(Node &&node)
     {
-        auto old_buckets = std::move(mBuckets);
-        mBuckets.resize(old_buckets.size() * 2);
+        uint32_t idx = getHomeIdx(node.hash);
+        uint32_t dist = 1;
+        int32_t placed_idx = -1;
 
-        for (const auto &old_bkt : old_buckets)
+        for (;;)
         {
-            for (auto &old_node : old_bkt)
+            if (mpDist[idx] == 0)
             {
-                auto hash = H::hash(old_node.key);
-                auto bidx = getBucketIdx(hash);
-                auto &node = mBuckets[bidx].append();
-                node.hash = hash;
-                node.key = old_node.key;
-                node.val = std::move(old_node.val);
+                new (&mpNodes[idx]) Node(std::move(node));
+                mpDist[idx] = dist;
+                return placed_idx < 0 ? idx : placed_idx;
             }
+
+            // take the slot from the richer node, then continue with it
+            if (mpDist[idx] < dist)
+            {
+                std::swap(node, mpNodes[idx]);
+                std::swap(dist, mpDist[idx]);
+                if (placed_idx < 0)
+                    placed_idx = idx;
+            }
+
+            idx = (idx + 1) & (mCapacity - 1);
+            dist++;
         }
     }
 
+    void growSlots()
+    {
+        Node *p_old_nodes = mpNodes;
+        uint32_t *p_old_dist = mpDist;
+        uint32_t old_capacity = mCapacity;
+
+        allocSlots(mCapacity ? mCapacity * 2 : 8);
+
+        // stored hashes are reused
+        for (uint32_t i = 0; i < old_capacity; i++)
+        {
+            if (p_old_dist[i])
+            {
+                insertNode(std::move(p_old_nodes[i]));
+                p_old_nodes[i].~Node();
+            }
+        }
+
+        if (p_old_nodes)
+            pPAL->memFree(p_old_nodes);
+    }
+
+    void allocSlots(uint32_t capacity)
+    {
+        // one block: nodes followed by probe distances
+        uint8_t *p_mem = (uint8_t*)pPAL->memAlloc(capacity * (sizeof(Node) + sizeof(uint32_t)));
+        mpNodes = (Node*)p_mem;
+        mpDist = (uint32_t*)(p_mem + capacity * sizeof(Node));
+        mCapacity = capacity;
+        memset(mpDist, 0, capacity * sizeof(uint32_t));
+    }
+
+    void freeSlots()
+    {
+        for (uint32_t i = 0; i < mCapacity; i++)
+            if (mpDist[i])
+                mpNodes[i].~Node();
+
+        if (mpNodes)
+            pPAL->memFree(mpNodes);
+
+        mpNodes = nullptr;
+        mpDist = nullptr;
+        mCapacity = 0;
+        mNodes = 0;
+    }
+
 private:
-    Buckets  mBuckets;
-    uint16_t mNodes = 0;
+    Node     *mpNodes = nullptr;
+    uint32_t *mpDist = nullptr;     // 0: empty slot; otherwise 1 + distance from the node's home slot
+    uint32_t mCapacity = 0;
+    uint32_t mNodes = 0;
 };
 
 // -----------------------------------------------------------------------------
@@ -106,6 +106,7 @@ struct DefaultPAL : twins::IPal
         stats.memChunks++;
         if (stats.memChunks > stats.memChunksMax)
             stats.memChunksMax = stats.memChunks;
+        stats.memAllocCount++;
 
         return ptr;
     #else
@@ -0,0 +1,166 @@
+/******************************************************************************
+ * @brief   TWins - PAL with fixed-block memory pools
+ * @author  Mariusz Midor
+ *          https://bitbucket.org/marmidr/twins
+ *          https://github.com/marmidr/twins
+ *****************************************************************************/
+
+#pragma once
+#include "twins_pal_defimpl.hpp"
+
+#include <stdint.h>
+
+// -----------------------------------------------------------------------------
+
+namespace twins
+{
+
+/**
+ * @brief PAL mixin serving memory requests from size-class pools (32/64/128/256/1024 B)
+ *        placed inside the object, thus avoiding heap fragmentation;
+ *        requests not fitting the pools go to the \p BasePAL heap.
+ *        Pools are guarded by the PAL lock(), so it must be recursive if the PAL is used
+ *        from many threads - allocations happen also under the twins::Locker.
+ * @example
+ *   struct MyPAL : twins::PoolPAL<64, 32, 16, 8, 2> { ... };
+ */
+template <uint16_t Cnt32 = 32, uint16_t Cnt64 = 16, uint16_t Cnt128 = 8, uint16_t Cnt256 = 4, uint16_t Cnt1K = 2, class BasePAL = DefaultPAL>
+struct PoolPAL : BasePAL
+{
+    PoolPAL()
+    {
+        static const uint16_t block_sizes[POOLS_COUNT] = { 32, 64, 128, 256, 1024 };
+        static const uint16_t block_counts[POOLS_COUNT] = { Cnt32, Cnt64, Cnt128, Cnt256, Cnt1K };
+        uint8_t *p_block = mArena;
+
+        for (unsigned p = 0; p < POOLS_COUNT; p++)
+        {
+            auto &pool = mPools[p];
+            pool.pBeg = p_block;
+            pool.pFree = nullptr;
+            mPoolStats[p] = {};
+            mPoolStats[p].blockSize = block_sizes[p];
+            mPoolStats[p].blocksTotal = block_counts[p];
+
+            // build the free list; the last block is on top
+            for (unsigned b = 0; b < block_counts[p]; b++)
+            {
+                *(void**)p_block = pool.pFree;
+                pool.pFree = p_block;
+                p_block += block_sizes[p];
+            }
+
+            pool.pEnd = p_block;
+        }
+
+        this->stats.pPools = mPoolStats;
+        this->stats.poolsCount = POOLS_COUNT;
+    }
+
+    void* memAlloc(uint32_t size) override
+    {
+        PoolLock _lock(*this);
+
+        // smallest fitting class first; when exhausted - try the larger ones
+        bool first_fit = true;
+
+        for (unsigned p = 0; p < POOLS_COUNT; p++)
+        {
+            auto &ps = mPoolStats[p];
+            if (size > ps.blockSize || ps.blocksTotal == 0)
+                continue;
+
+            auto &pool = mPools[p];
+
+            if (pool.pFree)
+            {
+                void *ptr = pool.pFree;
+                pool.pFree = *(void**)ptr;
+
+                if (++ps.blocksUsed > ps.blocksUsedMax)
+                    ps.blocksUsedMax = ps.blocksUsed;
+
+                auto &stats = this->stats;
+                stats.memAllocated += ps.blockSize;
+                if (stats.memAllocated > stats.memAllocatedMax)
+                    stats.memAllocatedMax = stats.memAllocated;
+
+                stats.memChunks++;
+                if (stats.memChunks > stats.memChunksMax)
+                    stats.memChunksMax = stats.memChunks;
+                stats.memAllocCount++;
+                return ptr;
+            }
+
+            if (first_fit)
+            {
+                ps.failures++;
+                first_fit = false;
+            }
+        }
+
+        this->stats.poolFallbacks++;
+        return BasePAL::memAlloc(size);
+    }
+
+    void memFree(void *ptr) override
+    {
+        PoolLock _lock(*this);
+
+        if (ptr >= (void*)mArena && ptr < (void*)(mArena + sizeof(mArena)))
+        {
+            for (unsigned p = 0; p < POOLS_COUNT; p++)
+            {
+                auto &pool = mPools[p];
+
+                if (ptr >= pool.pBeg && ptr < pool.pEnd)
+                {
+                    auto &ps = mPoolStats[p];
+                    *(void**)ptr = pool.pFree;
+                    pool.pFree = ptr;
+                    ps.blocksUsed--;
+                    this->stats.memAllocated -= ps.blockSize;
+                    this->stats.memChunks--;
+                    return;
+                }
+            }
+        }
+
+        BasePAL::memFree(ptr);
+    }
+
+    /** @brief Check if \p ptr belongs to one of the pools */
+    bool isPoolBlock(const void *ptr) const
+    {
+        return ptr >= (const void*)mArena && ptr < (const void*)(mArena + sizeof(mArena));
+    }
+
+protected:
+    /** @brief Scoped PAL lock */
+    struct PoolLock
+    {
+        explicit PoolLock(PoolPAL &pal) : mPal(pal), mLocked(pal.lock(true)) {}
+        ~PoolLock() { if (mLocked) mPal.unlock(); }
+
+        PoolPAL &mPal;
+        bool mLocked;
+    };
+
+    static constexpr unsigned POOLS_COUNT = 5;
+    static constexpr uint32_t ARENA_SIZE = 32u*Cnt32 + 64u*Cnt64 + 128u*Cnt128 + 256u*Cnt256 + 1024u*Cnt1K;
+
+    struct Pool
+    {
+        void *pBeg;
+        void *pEnd;
+        void *pFree;    // free blocks list; first bytes of each free block points to the next one
+    };
+
+    Pool mPools[POOLS_COUNT];
+    IPal::PoolStats mPoolStats[POOLS_COUNT];
+    alignas(sizeof(void*)) uint8_t mArena[ARENA_SIZE > 0 ? ARENA_SIZE : 1];
+};
+
+// -----------------------------------------------------------------------------
+
+}
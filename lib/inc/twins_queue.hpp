@@ -93,4 +93,85 @@ private:
 
 // -----------------------------------------------------------------------------
 
+/**
+ * @brief Queue with compile-time capacity \p N, never touching the heap;
+ *        items written to the full queue are dropped and counted
+ */
+template<typename T, uint16_t N>
+class StaticQueue
+{
+    static_assert(N > 0, "StaticQueue capacity must not be 0");
+
+public:
+    /** @brief Write new item to the queue; returns \b false if queue is full */
+    template <typename Tv>
+    bool write(Tv && item)
+    {
+        if (mSize == N)
+        {
+            if (mOverflows < UINT16_MAX)
+                mOverflows++;
+            return false;
+        }
+
+        mSize++;
+        mItems[mWriteIdx] = std::forward<Tv>(item);
+
+        if (++mWriteIdx == N)
+            mWriteIdx = 0;
+        return true;
+    }
+
+    /** @brief Returns tail item and decrease items counter;
+      *        return default \c {} of empty */
+    T read(void)
+    {
+        if (mSize)
+        {
+            mSize--;
+            auto rd_idx = mReadIdx;
+
+            if (++mReadIdx == N)
+                mReadIdx = 0;
+
+            return std::move(mItems[rd_idx]);
+        }
+
+        return {};
+    }
+
+    /** @brief Returns pointer to the first item to be read or \b nullptr if queue is empty */
+    const T* front(void)
+    {
+        if (mSize)
+            return &mItems[mReadIdx];
+
+        return nullptr;
+    }
+
+    /** @brief Remove all items */
+    void clear(void)
+    {
+        for (auto &item : mItems)
+            item = T{};
+        mSize = mWriteIdx = mReadIdx = 0;
+    }
+
+    /** @brief Return queue size */
+    uint16_t size(void) const { return mSize; }
+    /** @brief Return queue capacity */
+    static constexpr uint16_t capacity(void) { return N; }
+    /** @brief Number of write() calls rejected due to full queue */
+    uint16_t overflows(void) const { return mOverflows; }
+
+private:
+    T         mItems[N] = {};
+    uint16_t  mSize = 0;
+    uint16_t  mWriteIdx = 0;
+    uint16_t  mReadIdx = 0;
+    uint16_t  mOverflows = 0;
+};
+
+// -----------------------------------------------------------------------------
+
 } // namespace
@@ -108,15 +108,20 @@ public:
         if (mSize + dataSize > mCapacity)
             return false;
 
-        uint32_t toCopy = dataSize;
+        // at most two memcpy: up to the buffer end and from the buffer begin
+        uint16_t widx = mWriteIdx;
+        uint16_t first = mCapacity - widx;
+        if (first > dataSize)
+            first = dataSize;
 
-        while (toCopy--)
-        {
-            mpBuff[mWriteIdx++] = *data++;
-            if (mWriteIdx == mCapacity)
-                mWriteIdx = 0;
-        }
+        memcpy(mpBuff + widx, data, first * sizeof(T));
+        memcpy(mpBuff, data + first, (dataSize - first) * sizeof(T));
+
+        widx += dataSize;
+        if (widx >= mCapacity)
+            widx -= mCapacity;
 
+        mWriteIdx = widx;
         mSize += dataSize;
         return true;
     }
@@ -156,19 +161,8 @@ public:
         if (mSize == 0)
             return 0;
 
-        if (count > mSize)
-            count = mSize;
-
-        uint32_t toCopy = count;
-
-        while (toCopy--)
-        {
-            *buffer++ = mpBuff[mReadIdx++];
-            if (mReadIdx == mCapacity)
-                mReadIdx = 0;
-        }
-
-        mSize -= count;
+        count = copy(buffer, count);
+        skip(count);
         return count;
     }
 
@@ -185,19 +179,66 @@ public:
         if (count > mSize)
             count = mSize;
 
-        uint32_t toCopy = count;
-        uint16_t head = mReadIdx;
-
-        while (toCopy--)
-        {
-            *buffer++ = mpBuff[head++];
-            if (head == mCapacity)
-                head = 0;
-        }
+        Span<const T> first, second;
+        readSpans(first, second);
+        if (first.size > count)
+            first.size = count;
 
+        memcpy(buffer, first.data, first.size * sizeof(T));
+        memcpy(buffer + first.size, second.data, (count - first.size) * sizeof(T));
         return count;
     }
 
+    /** @brief Get up to two contiguous spans of data to read, not changing the read pointer;
+     *         the \p second one is not empty only if the data wraps around the buffer end
+     *  @return total number of elements available
+     */
+    uint16_t readSpans(Span<const T> &first, Span<const T> &second) const
+    {
+        assert(mpBuff);
+        const uint16_t ridx = mReadIdx;
+        const uint16_t sz = mSize;
+        const uint16_t to_end = mCapacity - ridx;
+
+        first.data = mpBuff + ridx;
+        first.size = sz < to_end ? sz : to_end;
+        second.data = mpBuff;
+        second.size = sz - first.size;
+        return sz;
+    }
+
+    /** @brief Get up to two contiguous spans of free space, to be filled directly (eg. by DMA or read());
+     *         then call commitWrite() with the number of elements actually written
+     *  @return total free space
+     */
+    uint16_t writeSpans(Span<T> &first, Span<T> &second)
+    {
+        assert(mpBuff);
+        const uint16_t widx = mWriteIdx;
+        const uint16_t free_sz = mCapacity - mSize;
+        const uint16_t to_end = mCapacity - widx;
+
+        first.data = mpBuff + widx;
+        first.size = free_sz < to_end ? free_sz : to_end;
+        second.data = mpBuff;
+        second.size = free_sz - first.size;
+        return free_sz;
+    }
+
+    /** @brief Moves write pointer forward by \p count items written through writeSpans() */
+    void commitWrite(uint16_t count)
+    {
+        if (count > mCapacity - mSize)
+            count = mCapacity - mSize;
+
+        uint16_t widx = mWriteIdx + count;
+        if (widx >= mCapacity)
+            widx -= mCapacity;
+
+        mWriteIdx = widx;
+        mSize += count;
+    }
+
     /** @brief Returns a pointer to contiguous data, not changing the read pointer.
      *  @param if \p dataSz is given, set value to contiguous data size
      */
@@ -230,10 +271,12 @@ public:
         if (count > mSize)
             count = mSize;
 
+        uint16_t ridx = mReadIdx + count;
+        if (ridx >= mCapacity)
+            ridx -= mCapacity;
+
+        mReadIdx = ridx;
         mSize -= count;
-        mReadIdx += count;
-        if (mReadIdx >= mCapacity)
-            mReadIdx -= mCapacity;
     }
 
 private:
@@ -248,4 +291,197 @@ private:
 
 // -----------------------------------------------------------------------------
 
+/**
+ * @brief Lock-free ring buffer for single producer (eg. UART RX interrupt)
+ *        and single consumer (main loop); only read and write indexes are shared.
+ *        Producer calls: write(), isFull(); consumer calls all the others.
+ * @tparam T trivial type, like int of any size
+ * @note capacity must be power of 2, up to 32768
+ */
+template <typename T>
+class SpscRingBuff
+{
+public:
+    SpscRingBuff() = default;
+    SpscRingBuff(const SpscRingBuff&) = delete;
+    SpscRingBuff(SpscRingBuff&&) = delete;
+
+    /** @brief Initialize with external static buffer of size N */
+    template<uint16_t N>
+    SpscRingBuff(T (&buffer)[N])
+    {
+        initStatic<N>(buffer);
+    }
+
+    ~SpscRingBuff()
+    {
+        if (mpBuff && !mStaticBuff)
+            pPAL->memFree(mpBuff);
+    }
+
+    /** @brief Initialize with external static buffer of size N */
+    template<uint16_t N>
+    void initStatic(T (&buffer)[N])
+    {
+        static_assert(N && (N & (N-1)) == 0 && N <= 0x8000, "N must be power of 2");
+        assert(!(mpBuff && !mStaticBuff));
+
+        mpBuff = buffer;
+        mMask = N - 1;
+        mStaticBuff = true;
+    }
+
+    /** @brief Initialize the internal buffer using twins::IOS memAlloc() */
+    void init(uint16_t bufferSize)
+    {
+        if (mpBuff)
+            return;
+
+        assert(pPAL);
+        assert(bufferSize && (bufferSize & (bufferSize-1)) == 0 && bufferSize <= 0x8000);
+        mpBuff = (T*)pPAL->memAlloc(bufferSize * sizeof(T));
+        mMask = bufferSize - 1;
+    }
+
+    /** @brief Drop all unread data; consumer side */
+    void clear()
+    {
+        mReadIdx.store(mWriteIdx.load(std::memory_order_acquire), std::memory_order_release);
+    }
+
+    /** @brief Returns data length written */
+    uint16_t size() const
+    {
+        return uint16_t(mWriteIdx.load(std::memory_order_acquire) - mReadIdx.load(std::memory_order_acquire));
+    }
+
+    /** @brief Returns buffer capacity */
+    uint16_t capacity() const { return mpBuff ? mMask + 1 : 0; }
+
+    /** @brief returns true if buffer is full */
+    bool isFull() const { return size() == capacity(); }
+
+    /** @brief Write \p data into the buffer; producer side
+     *  @return false if buffer is full
+     */
+    bool write(T data)
+    {
+        assert(mpBuff);
+        const uint16_t widx = mWriteIdx.load(std::memory_order_relaxed);
+
+        if (uint16_t(widx - mReadIdx.load(std::memory_order_acquire)) > mMask)
+            return false;
+
+        mpBuff[widx & mMask] = data;
+        mWriteIdx.store(widx + 1, std::memory_order_release);
+        return true;
+    }
+
+    /** @brief Write array \p data of \p dataSize elements into the buffer; producer side
+     *  @return false if no space left for entire data
+     */
+    bool write(const T *data, uint16_t dataSize)
+    {
+        assert(mpBuff);
+        const uint16_t widx = mWriteIdx.load(std::memory_order_relaxed);
+
+        if (uint16_t(widx - mReadIdx.load(std::memory_order_acquire)) + dataSize > mMask + 1u)
+            return false;
+
+        const uint16_t pos = widx & mMask;
+        uint16_t first = mMask + 1 - pos;
+        if (first > dataSize)
+            first = dataSize;
+
+        memcpy(mpBuff + pos, data, first * sizeof(T));
+        memcpy(mpBuff, data + first, (dataSize - first) * sizeof(T));
+
+        // publish all at once
+        mWriteIdx.store(widx + dataSize, std::memory_order_release);
+        return true;
+    }
+
+    /** @brief Write null-terminated C string */
+    bool write(const char* data)
+    {
+        return data ? write(data, strlen(data)) : 0;
+    }
+
+    /** @brief Read single element into \p item
+     *  @return false if buffer is empty
+     */
+    bool read(T &item)
+    {
+        return read(&item, 1) == 1;
+    }
+
+    /** @brief Read \p count elements into the \p buffer, but no more that \p size()
+     *  @return number of elements copied
+     */
+    uint16_t read(T *buffer, uint16_t count)
+    {
+        count = copy(buffer, count);
+        skip(count);
+        return count;
+    }
+
+    /** @brief Copy \p count elements into the \p buffer, but no more that \p size()
+     *         not changing the internal state
+     *  @return number of elements copied
+     */
+    uint16_t copy(T *buffer, uint16_t count) const
+    {
+        Span<const T> first, second;
+        const uint16_t sz = readSpans(first, second);
+        if (count > sz)
+            count = sz;
+        if (first.size > count)
+            first.size = count;
+
+        memcpy(buffer, first.data, first.size * sizeof(T));
+        memcpy(buffer + first.size, second.data, (count - first.size) * sizeof(T));
+        return count;
+    }
+
+    /** @brief Get up to two contiguous spans of data to read, not changing the read pointer; consumer side
+     *  @return total number of elements available
+     */
+    uint16_t readSpans(Span<const T> &first, Span<const T> &second) const
+    {
+        assert(mpBuff);
+        const uint16_t ridx = mReadIdx.load(std::memory_order_relaxed);
+        const uint16_t sz = uint16_t(mWriteIdx.load(std::memory_order_acquire) - ridx);
+        const uint16_t pos = ridx & mMask;
+        const uint16_t to_end = mMask + 1 - pos;
+
+        first.data = mpBuff + pos;
+        first.size = sz < to_end ? sz : to_end;
+        second.data = mpBuff;
+        second.size = sz - first.size;
+        return sz;
+    }
+
+    /** @brief Moves read pointer forward by \p count items, but no more than \p size elements */
+    void skip(uint16_t count)
+    {
+        const uint16_t sz = size();
+        if (count > sz)
+            count = sz;
+
+        // release: the producer may overwrite the slots after it sees the new index
+        mReadIdx.store(mReadIdx.load(std::memory_order_relaxed) + count, std::memory_order_release);
+    }
+
+private:
+    // free running indexes; wrapped with mMask only when accessing the buffer
+    std::atomic<uint16_t> mWriteIdx {};
+    std::atomic<uint16_t> mReadIdx {};
+
+    uint16_t mMask {};
+    bool     mStaticBuff {};
+    T *      mpBuff {};
+};
+
+// -----------------------------------------------------------------------------
+
 } // namespace
@@ -0,0 +1,294 @@
+/******************************************************************************
+ * @brief   TWins - vector container with inline storage
+ * @author  Mariusz Midor
+ *          https://bitbucket.org/marmidr/twins
+ *          https://github.com/marmidr/twins
+ *****************************************************************************/
+
+#pragma once
+#include "twins_common.hpp"
+
+#include <utility>  // std::move
+#include <memory>   // new(addr) T()
+#include <initializer_list>
+#include <type_traits>
+#include <assert.h>
+
+// -----------------------------------------------------------------------------
+
+namespace twins
+{
+
+/**
+ * @brief Vector keeping first \p N items inside the object;
+ *        memory for more items is taken from \p Alloc (PalAllocator, FrameAllocator, NoAllocator);
+ *        with NoAllocator, append() beyond \p N items fails and returns \b false
+ */
+template <class T, unsigned N, class SizeT = uint16_t, class Alloc = PalAllocator>
+class SmallVector
+{
+    static_assert(N > 0, "Inline capacity must not be 0; use Vector instead");
+
+public:
+    using ItemType = T;
+    using SizeType = SizeT;
+
+    SmallVector() = default;
+
+    /** @brief Copy constructor */
+    SmallVector(const SmallVector &other)
+    {
+        append(other.data(), other.size());
+    }
+
+    /** @brief Constructor from array of items */
+    template<typename Tv>
+    SmallVector(const Tv* pItems, SizeT count)
+    {
+        append(pItems, count);
+    }
+
+    /** @brief Constructor from initializer_list */
+    template<typename Tv>
+    explicit SmallVector(const std::initializer_list<Tv> &items)
+    {
+        append(items);
+    }
+
+    /** @brief Move constructor */
+    SmallVector(SmallVector &&other)
+    {
+        *this = std::move(other);
+    }
+
+    ~SmallVector()
+    {
+        clear();
+    }
+
+    /** @brief Copy assign */
+    SmallVector & operator = (const SmallVector &other)
+    {
+        if (&other != this)
+        {
+            clear();
+            append(other.data(), other.size());
+        }
+        return *this;
+    }
+
+    /** @brief Move assign */
+    SmallVector & operator = (SmallVector &&other)
+    {
+        if (&other == this)
+            return *this;
+
+        clear();
+
+        if (other.isInline())
+        {
+            moveContent(mpItems, other.mpItems, other.mSize);
+            mSize = other.mSize;
+            other.clear();
+        }
+        else
+        {
+            // take over the other buffer
+            mpItems = other.mpItems;
+            mSize = other.mSize;
+            mCapacity = other.mCapacity;
+            other.mpItems = other.inlineItems();
+            other.mSize = 0;
+            other.mCapacity = N;
+        }
+
+        return *this;
+    }
+
+    /** @brief Direct access operator; \b Note: may lead to crash in case of invalid \p idx */
+    T & operator [] (SizeT idx)
+    {
+        assert(idx < mSize);
+        return mpItems[idx];
+    }
+
+    const T & operator [] (SizeT idx) const
+    {
+        assert(idx < mSize);
+        return mpItems[idx];
+    }
+
+    /** @brief Direct safe access operator; Returns \b nullptr in case of invalid \p idx */
+    T * getAt(SizeT idx)
+    {
+        return idx < mSize ? &mpItems[idx] : nullptr;
+    }
+
+    /** @brief Get last element */
+    T * back(void)
+    {
+        return mSize ? &mpItems[mSize - 1] : nullptr;
+    }
+
+    T * data(void) { return mpItems; }
+    const T * data(void) const { return mpItems; }
+
+    /** @brief Returns vector current size (number of items) */
+    SizeT size(void) const { return mSize; }
+
+    /** @brief Vector capacity */
+    SizeT capacity(void) const { return mCapacity; }
+
+    /** @brief Check if items are stored inside the object */
+    bool isInline(void) const { return mpItems == inlineItems(); }
+
+    /** @brief Reserve capacity (higher than current) to avoid memory reallocations;
+     *         returns \b false if allocator failed */
+    bool reserve(SizeT newCapacity)
+    {
+        if (newCapacity <= mCapacity)
+            return true;
+
+        auto* p_new_items = (T*)Alloc::memAlloc(newCapacity * sizeof(T));
+        if (!p_new_items)
+            return false;
+
+        moveContent(p_new_items, mpItems, mSize);
+        destroyContent();
+        if (!isInline())
+            Alloc::memFree(mpItems);
+
+        mpItems = p_new_items;
+        mCapacity = newCapacity;
+        return true;
+    }
+
+    /** @brief Add new element at the end by copy or move (push back) */
+    template<typename Tv>
+    bool append(Tv &&val)
+    {
+        if (!growAsNecessary())
+            return false;
+
+        new (&mpItems[mSize++]) T(std::forward<Tv>(val));
+        return true;
+    }
+
+    /** @brief Append empty element and return pointer to it, or \b nullptr when full */
+    T* append(void)
+    {
+        if (!growAsNecessary())
+            return nullptr;
+
+        return new (&mpItems[mSize++]) T{};
+    }
+
+    /** @brief Append given array of elements by copy */
+    template<typename Tv>
+    bool append(const Tv* pItems, SizeT count)
+    {
+        if (!growAsNecessary(count))
+            return false;
+
+        for (SizeT i = 0; i < count; i++)
+            new (&mpItems[mSize++]) T(pItems[i]);
+
+        return true;
+    }
+
+    /** @brief Append given initialzier list by copy */
+    template<typename Tv>
+    bool append(const std::initializer_list<Tv> &items)
+    {
+        return append(items.begin(), items.size());
+    }
+
+    /** @brief Delete element at \p idx */
+    bool remove(SizeT idx, bool preserveOrder = false)
+    {
+        if (idx >= mSize)
+            return false;
+
+        if (preserveOrder)
+        {
+            for (SizeT i = idx; i + 1 < mSize; i++)
+                mpItems[i] = std::move(mpItems[i+1]);
+        }
+        else if (idx != mSize - 1)
+        {
+            std::swap(mpItems[idx], mpItems[mSize - 1]);
+        }
+
+        mpItems[--mSize].~T();
+        return true;
+    }
+
+    /** @brief Simpy check if vector contains \p val */
+    bool contains(const T &val) const
+    {
+        for (SizeT i = 0; i < mSize; i++)
+            if (mpItems[i] == val)
+                return true;
+
+        return false;
+    }
+
+    /** @brief Remove all items and free memory */
+    void clear(void)
+    {
+        destroyContent();
+        if (!isInline())
+            Alloc::memFree(mpItems);
+
+        mpItems = inlineItems();
+        mCapacity = N;
+        mSize = 0;
+    }
+
+    T* begin(void) { return mpItems; }
+    T* end(void)   { return mpItems + mSize; }
+
+    const T* begin(void) const { return mpItems; }
+    const T* end(void)   const { return mpItems + mSize; }
+
+protected:
+    bool growAsNecessary(SizeT growBy = 1)
+    {
+        if (mCapacity >= mSize + growBy)
+            return true;
+
+        SizeT new_capacity = mCapacity * 2;
+        if (new_capacity < mSize + growBy)
+            new_capacity = mSize + growBy;
+
+        bool ok = reserve(new_capacity);
+        // with NoAllocator the capacity is fixed by design - caller gets false
+        assert((ok || std::is_same<Alloc, NoAllocator>::value) && "SmallVector: out of memory");
+        return ok;
+    }
+
+    T* inlineItems() { return reinterpret_cast<T*>(mInlineItems); }
+    const T* inlineItems() const { return reinterpret_cast<const T*>(mInlineItems); }
+
+    void destroyContent()
+    {
+        for (SizeT i = 0; i < mSize; i++)
+            mpItems[i].~T();
+    }
+
+    static void moveContent(T *pDst, T *pSrc, SizeT count)
+    {
+        for (SizeT i = 0; i < count; i++)
+            new (&pDst[i]) T(std::move(pSrc[i]));
+    }
+
+protected:
+    alignas(T) uint8_t mInlineItems[N * sizeof(T)];
+    T *      mpItems = inlineItems();
+    SizeT    mSize = 0;
+    SizeT    mCapacity = N;
+};
+
+//------------------------------------------------------------------------------
+
+}
@@ -10,6 +10,7 @@
 
 #include <utility>  // std::move
 #include <memory>   // new(addr) T()
+#include <stdint.h>
 
 // -----------------------------------------------------------------------------
 
@@ -79,6 +80,8 @@ public:
 
     /** @brief Return stack size */
     uint16_t size() const { return mSize; }
+    /** @brief Return number of items to pop; same as size(), for compatibility with StaticStack */
+    uint16_t depth() const { return mSize; }
 
 private:
     bool growAsNecessary()
@@ -135,4 +138,96 @@ private:
 
 // -----------------------------------------------------------------------------
 
+/**
+ * @brief Stack with compile-time capacity \p N, never touching the heap;
+ *        items pushed onto the full stack are dropped and counted,
+ *        and the matching pop() returns \b nullptr, keeping push/pop pairs in step
+ */
+template<typename T, uint16_t N>
+class StaticStack
+{
+    static_assert(N > 0, "StaticStack capacity must not be 0");
+
+public:
+    StaticStack() = default;
+    StaticStack(const StaticStack&) = delete;
+    StaticStack(StaticStack&&) = delete;
+
+    /** @brief Push new item onto the stack by copy or move */
+    template <typename Tv>
+    void push(Tv && item)
+    {
+        if (mDepth < UINT16_MAX)
+            mDepth++;
+
+        if (mSize == N)
+        {
+            if (mOverflows < UINT16_MAX)
+                mOverflows++;
+            return;
+        }
+
+        mItems[mSize++] = std::forward<Tv>(item);
+        if (mSize > mSizeMax)
+            mSizeMax = mSize;
+    }
+
+    /** @brief Returns pointer to to the top item and decrease stack size,
+     *         or \b nullptr if stack is empty or the matching push() was dropped */
+    T* pop()
+    {
+        if (mDepth > mSize)
+        {
+            mDepth--;
+            return nullptr;
+        }
+
+        if (mSize)
+        {
+            mDepth--;
+            mSize--;
+            return mItems + mSize;
+        }
+
+        return nullptr;
+    }
+
+    /** @brief Returns pointer to the top-item or \b nullptr if stack is empty */
+    T* top()
+    {
+        if (mSize)
+            return mItems + mSize - 1;
+
+        return nullptr;
+    }
+
+    /** @brief Remove all items; \p force is for compatibility with Stack */
+    void clear(bool force = false)
+    {
+        (void)force;
+        mSize = 0;
+        mDepth = 0;
+    }
+
+    /** @brief Return stack size */
+    uint16_t size() const { return mSize; }
+    /** @brief Return number of items to pop, including the dropped ones */
+    uint16_t depth() const { return mDepth; }
+    /** @brief Return stack capacity */
+    static constexpr uint16_t capacity() { return N; }
+    /** @brief Peak stack size; useful to tune \p N */
+    uint16_t sizeMax() const { return mSizeMax; }
+    /** @brief Number of push() calls rejected due to full stack */
+    uint16_t overflows() const { return mOverflows; }
+
+private:
+    T           mItems[N] = {};
+    uint16_t    mSize = 0;
+    uint16_t    mDepth = 0;
+    uint16_t    mSizeMax = 0;
+    uint16_t    mOverflows = 0;
+};
+
+// -----------------------------------------------------------------------------
+
 } // namespace
@@ -12,6 +12,11 @@
 
 // -----------------------------------------------------------------------------
 
+// 32-bit size and geometric buffer growth, for huge texts
+#ifndef TWINS_LARGE_STRING
+# define TWINS_LARGE_STRING     0
+#endif
+
 namespace twins
 {
 
@@ -21,6 +26,14 @@ namespace twins
 class String
 {
 public:
+#if TWINS_LARGE_STRING
+    using SizeType = uint32_t;
+    using IndexType = int32_t;
+#else
+    using SizeType = uint16_t;
+    using IndexType = int16_t;
+#endif
+
     String(const char *s);
     String() = default;
     String(const String &other) : String(other.cstr()) {}
@@ -28,37 +41,40 @@ public:
     ~String();
 
     /** @brief Append \p repeat of given string \p s */
-    String& append(const char *s, int16_t repeat = 1);
+    String& append(const char *s, IndexType repeat = 1);
     /** @brief Append new string \p s, size of \p sLen bytes */
-    String& appendLen(const char *s, int16_t sLen);
+    String& appendLen(const char *s, IndexType sLen);
     /** @brief Append \p repeat of given characters \p c */
-    String& append(char c, int16_t repeat = 1);
+    String& append(char c, IndexType repeat = 1);
     /** @brief Append new string \p s */
     inline String& append(const String &s) { return append(s.cstr()); }
     /** @brief Append formatted string */
     String& appendFmt(const char *fmt, ...);
     void appendVFmt(const char *fmt, va_list ap);
     /** @brief Trim string that is too long to fit; optionally append ellipsis ... at the \p trimPos */
-    String& trim(int16_t trimPos, bool addEllipsis = false, bool ignoreESC = false);
+    String& trim(IndexType trimPos, bool addEllipsis = false, bool ignoreESC = false);
     /** @brief Erase \p len characters from string at \p pos */
-    String& erase(int16_t pos, int16_t len = 1);
+    String& erase(IndexType pos, IndexType len = 1);
     /** @brief Insert string \p s at \p pos */
-    String& insert(int16_t pos, const char *s, int16_t repeat = 1);
+    String& insert(IndexType pos, const char *s, IndexType repeat = 1);
     /** @brief If shorter than \p newWidth - add spaces; if longer - calls trim */
-    void setWidth(int16_t newWidth, bool addEllipsis = false);
+    void setWidth(IndexType newWidth, bool addEllipsis = false);
     /** @brief Set size to zero; release buffer memory only if capacity >= \p threshordToFree */
-    String& clear(uint16_t threshordToFree = 500);
+    String& clear(SizeType threshordToFree = 500);
     /** @brief Return string size, in bytes */
-    inline uint16_t size() const { return mSize; }
+    inline SizeType size() const { return mSize; }
     /** @brief Return length of UTF-8 string, ignoring ESC sequences inside it
-     *         and recognizing double-width glyphs */
-    uint16_t u8len(bool ignoreESC = false, bool realWidth = false) const;
+     *         and recognizing double-width glyphs;
+     *         u8len() and width() results are cached until the string is modified */
+    SizeType u8len(bool ignoreESC = false, bool realWidth = false) const;
     /** @brief Text width on terminal */
-    inline uint16_t width() const { return u8len(true, true); }
+    inline SizeType width() const { return u8len(true, true); }
     /** @brief Return C-style string buffer */
-    inline const char* cstr() const { return mpBuff ? mpBuff : ""; }
+    inline const char* cstr() const { return mpBuff; }
     /** @brief Reserve buffer if u know the string size in advance */
-    void reserve(uint16_t newCapacity);
+    void reserve(SizeType newCapacity);
+    /** @brief Take buffers from the frame arena; only for temporaries that do not outlive drawing call */
+    void useFrameArena() { mFrameTemp = true; }
     /** @brief Useful tests */
     bool startsWith(const char *str) const;
     bool endsWith(const char *str) const;
@@ -80,20 +96,35 @@ public:
     static uint16_t escLen(const char *str, const char *strEnd = nullptr);
     /** @brief Return length of UTF-8 string \p str, ignoring ESC sequences inside it
      *         and recognizing double-width glyphs */
-    static uint16_t u8len(const char *str, const char *strEnd = nullptr, bool ignoreESC = false, bool realWidth = false);
+    static SizeType u8len(const char *str, const char *strEnd = nullptr, bool ignoreESC = false, bool realWidth = false);
     /** @brief Text width on terminal */
-    static inline uint16_t width(const char *str, const char *strEnd = nullptr) { return u8len(str, strEnd, true, true); }
+    static inline SizeType width(const char *str, const char *strEnd = nullptr) { return u8len(str, strEnd, true, true); }
+    /** @brief Terminal columns occupied by code point \p cp: 0 (combining, joiners), 1 or 2 (wide, fullwidth) */
+    static uint8_t charWidth(uint32_t cp);
     /** @brief Return pointer to \p str moved by \p toSkip UTF-8 characters, omitting ESC sequences */
     static const char* u8skip(const char *str, unsigned toSkip, bool ignoreESC = true);
 
 protected:
+    /** @brief Short strings are stored inside the object, without heap allocation */
+    static constexpr uint16_t INLINE_CAPACITY = 24;
+
     void freeBuff();
-    uint16_t alignCapacity(uint16_t newCapacity) const;
+    void growAsNecessary(SizeType newSize);
+    SizeType alignCapacity(SizeType newCapacity) const;
     bool sourceIsOurs(const char *s) const { return (s >= mpBuff) && (s < mpBuff + mCapacity); }
-
-    char* mpBuff = nullptr;
-    uint16_t mCapacity = 0;
-    uint16_t mSize = 0;
+    bool isInline() const { return mpBuff == mInlineBuff; }
+    void invalidateCache() { mCachedLenValid = mCachedWidthValid = false; }
+
+    char* mpBuff = mInlineBuff;
+    SizeType mCapacity = INLINE_CAPACITY;
+    SizeType mSize = 0;
+    /** @brief Cached u8len() and width(); other u8len() modes are counted every time */
+    mutable SizeType mCachedLen = 0;
+    mutable SizeType mCachedWidth = 0;
+    mutable bool mCachedLenValid = false;
+    mutable bool mCachedWidthValid = false;
+    bool mFrameTemp = false;
+    char mInlineBuff[INLINE_CAPACITY] = {};
 };
 
 
@@ -130,16 +161,16 @@ public:
      */
     char* data()
     {
-        if (!mpBuff)
-            append("");
+        invalidateCache();
         return mpBuff;
     }
 
     /**
      * @brief Unsafe access operator
      */
-    char& operator[](uint16_t idx)
+    char& operator[](SizeType idx)
     {
+        invalidateCache();
         return mpBuff[idx];
     }
 };
@@ -123,6 +123,217 @@ constexpr twins::Array<twins::Widget, N> transforWindowDefinition()
     return arr;
 }
 
+/**
+ * @brief Widget types that may receive focus by Tab navigation
+ */
+constexpr bool isFocusableType(Widget::Type type)
+{
+    return type == Widget::TextEdit ||
+           type == Widget::CheckBox ||
+           type == Widget::Radio ||
+           type == Widget::Button ||
+           type == Widget::ListBox ||
+           type == Widget::ComboBox ||
+           type == Widget::TextBox;
+}
+
+/**
+ * @brief Count all focusable widgets in pointed window
+ */
+constexpr int getFocusablesCount(const twins::Widget *pWgt)
+{
+    int n = isFocusableType(pWgt->type);
+
+    for (const auto *ch = pWgt->link.pChildren; ch && ch->id != twins::WIDGET_ID_NONE; ch++)
+        n += getFocusablesCount(ch);
+
+    return n;
+}
+
+/**
+ * @brief Recurrent Tab-order table generation - depth-first walk over transformed widgets array
+ * @par arr Destination Tab-order table
+ * @par wgts Transformed window widgets
+ */
+template<unsigned F, unsigned N>
+constexpr int transformFocusOrderToArray(twins::Array<twins::FocusEntry, F> &arr, const twins::Array<twins::Widget, N> &wgts, const int wgtIdx, int scopeIdx, int freeSlotIdx)
+{
+    const auto &wgt = wgts[wgtIdx];
+
+    // Tab never leaves the Page
+    if (wgt.type == Widget::Page)
+        scopeIdx = wgtIdx;
+
+    if (isFocusableType(wgt.type))
+    {
+        arr[freeSlotIdx].wgtIdx = wgtIdx;
+        arr[freeSlotIdx].scopeIdx = scopeIdx;
+        freeSlotIdx++;
+    }
+
+    for (int i = 0; i < wgt.link.childrenCnt; i++)
+        freeSlotIdx = transformFocusOrderToArray<F, N>(arr, wgts, wgt.link.childrenIdx + i, scopeIdx, freeSlotIdx);
+
+    return freeSlotIdx;
+}
+
+/**
+ * @brief Generate flat Tab-order table for the window;
+ *        pass it to WindowStateBase::setFocusOrder() to speed-up the focus navigation
+ */
+template<const twins::Widget *pWINDOW, int F = getFocusablesCount(pWINDOW) + 1>
+constexpr twins::Array<twins::FocusEntry, F> transformWindowFocusOrder()
+{
+    const auto wgts = transforWindowDefinition<pWINDOW>();
+    twins::Array<twins::FocusEntry, F> arr;
+
+    // last entry remains {0, 0} - the terminator
+    transformFocusOrderToArray<F>(arr, wgts, 0, 0, 0);
+    return arr;
+}
+
+/**
+ * @brief Count widgets of given \p type in pointed window
+ */
+constexpr int getWgtsCountOfType(const twins::Widget *pWgt, Widget::Type type)
+{
+    int n = pWgt->type == type;
+
+    for (const auto *ch = pWgt->link.pChildren; ch && ch->id != twins::WIDGET_ID_NONE; ch++)
+        n += getWgtsCountOfType(ch, type);
+
+    return n;
+}
+
+/**
+ * @brief Storage for the widget columns and per-type properties; use getColumns() to get the columns view
+ */
+template<const twins::Widget *pWINDOW, int N = getWgtsCount(pWINDOW) + 1>
+struct WidgetColumnsArray
+{
+    twins::Array<twins::WID, N>     ids;
+    twins::Array<uint8_t, N>        types;
+    twins::Array<uint16_t, N>       parentIdxs;
+    twins::Array<uint16_t, N>       childrenIdxs;
+    twins::Array<uint8_t, N>        childrenCnts;
+    twins::Array<twins::Rect, N>    rects;
+    twins::Array<uint16_t, N>       propIdxs;
+
+    // only the types present in the window take space
+    twins::Array<decltype(Widget::window),      getWgtsCountOfType(pWINDOW, Widget::Window)>      window;
+    twins::Array<decltype(Widget::panel),       getWgtsCountOfType(pWINDOW, Widget::Panel)>       panel;
+    twins::Array<decltype(Widget::label),       getWgtsCountOfType(pWINDOW, Widget::Label)>       label;
+    twins::Array<decltype(Widget::textedit),    getWgtsCountOfType(pWINDOW, Widget::TextEdit)>    textedit;
+    twins::Array<decltype(Widget::checkbox),    getWgtsCountOfType(pWINDOW, Widget::CheckBox)>    checkbox;
+    twins::Array<decltype(Widget::radio),       getWgtsCountOfType(pWINDOW, Widget::Radio)>       radio;
+    twins::Array<decltype(Widget::button),      getWgtsCountOfType(pWINDOW, Widget::Button)>      button;
+    twins::Array<decltype(Widget::led),         getWgtsCountOfType(pWINDOW, Widget::Led)>         led;
+    twins::Array<decltype(Widget::pagectrl),    getWgtsCountOfType(pWINDOW, Widget::PageCtrl)>    pagectrl;
+    twins::Array<decltype(Widget::page),        getWgtsCountOfType(pWINDOW, Widget::Page)>        page;
+    twins::Array<decltype(Widget::progressbar), getWgtsCountOfType(pWINDOW, Widget::ProgressBar)> progressbar;
+    twins::Array<decltype(Widget::listbox),     getWgtsCountOfType(pWINDOW, Widget::ListBox)>     listbox;
+    twins::Array<decltype(Widget::combobox),    getWgtsCountOfType(pWINDOW, Widget::ComboBox)>    combobox;
+    twins::Array<decltype(Widget::textbox),     getWgtsCountOfType(pWINDOW, Widget::TextBox)>     textbox;
+
+    constexpr twins::WidgetColumns getColumns() const
+    {
+        twins::WidgetColumns cols = {
+            ids.begin(), types.begin(), parentIdxs.begin(), childrenIdxs.begin(), childrenCnts.begin(),
+            rects.begin(), propIdxs.begin(), {}, N - 1
+        };
+
+        // CustomWgt and Layer have no properties
+        cols.pProps[Widget::Window]      = window.begin();
+        cols.pProps[Widget::Panel]       = panel.begin();
+        cols.pProps[Widget::Label]       = label.begin();
+        cols.pProps[Widget::TextEdit]    = textedit.begin();
+        cols.pProps[Widget::CheckBox]    = checkbox.begin();
+        cols.pProps[Widget::Radio]       = radio.begin();
+        cols.pProps[Widget::Button]      = button.begin();
+        cols.pProps[Widget::Led]         = led.begin();
+        cols.pProps[Widget::PageCtrl]    = pagectrl.begin();
+        cols.pProps[Widget::Page]        = page.begin();
+        cols.pProps[Widget::ProgressBar] = progressbar.begin();
+        cols.pProps[Widget::ListBox]     = listbox.begin();
+        cols.pProps[Widget::ComboBox]    = combobox.begin();
+        cols.pProps[Widget::TextBox]     = textbox.begin();
+        return cols;
+    }
+};
+
+template<typename T, unsigned N>
+constexpr void setWidgetProps(twins::Array<T, N> &arr, unsigned idx, const T &props)
+{
+    arr[idx] = props;
+}
+
+template<typename T>
+constexpr void setWidgetProps(twins::Array<T, 0> &, unsigned, const T &)
+{
+}
+
+/**
+ * @brief Generate compact, column-wise form of the window;
+ *        pass it to WindowStateBase::setWidgetColumns() - the Widget array is not needed then,
+ *        so only this table goes to flash
+ */
+template<const twins::Widget *pWINDOW>
+constexpr WidgetColumnsArray<pWINDOW> transformWindowColumns()
+{
+    const auto wgts = transforWindowDefinition<pWINDOW>();
+    WidgetColumnsArray<pWINDOW> cols;
+    twins::Array<uint16_t, Widget::_Count> type_counts;
+
+    // terminator left empty
+    for (unsigned i = 0; i < wgts.size() - 1; i++)
+    {
+        const auto &wgt = wgts[i];
+        cols.ids[i] = wgt.id;
+        cols.types[i] = wgt.type;
+        cols.parentIdxs[i] = wgt.link.parentIdx;
+        cols.childrenIdxs[i] = wgt.link.childrenIdx;
+        cols.childrenCnts[i] = wgt.link.childrenCnt;
+        cols.rects[i].coord = wgt.coord;
+        cols.rects[i].size = wgt.size;
+
+        const uint16_t prop_idx = type_counts[wgt.type]++;
+        cols.propIdxs[i] = prop_idx;
+
+        switch (wgt.type)
+        {
+        case Widget::Window:      setWidgetProps(cols.window, prop_idx, wgt.window); break;
+        case Widget::Panel:       setWidgetProps(cols.panel, prop_idx, wgt.panel); break;
+        case Widget::Label:       setWidgetProps(cols.label, prop_idx, wgt.label); break;
+        case Widget::TextEdit:    setWidgetProps(cols.textedit, prop_idx, wgt.textedit); break;
+        case Widget::CheckBox:    setWidgetProps(cols.checkbox, prop_idx, wgt.checkbox); break;
+        case Widget::Radio:       setWidgetProps(cols.radio, prop_idx, wgt.radio); break;
+        case Widget::Button:      setWidgetProps(cols.button, prop_idx, wgt.button); break;
+        case Widget::Led:         setWidgetProps(cols.led, prop_idx, wgt.led); break;
+        case Widget::PageCtrl:    setWidgetProps(cols.pagectrl, prop_idx, wgt.pagectrl); break;
+        case Widget::Page:        setWidgetProps(cols.page, prop_idx, wgt.page); break;
+        case Widget::ProgressBar: setWidgetProps(cols.progressbar, prop_idx, wgt.progressbar); break;
+        case Widget::ListBox:     setWidgetProps(cols.listbox, prop_idx, wgt.listbox); break;
+        case Widget::ComboBox:    setWidgetProps(cols.combobox, prop_idx, wgt.combobox); break;
+        case Widget::TextBox:     setWidgetProps(cols.textbox, prop_idx, wgt.textbox); break;
+        default: break;
+        }
+
+        // Window keeps its own position; children are relative to the Window
+        if (i == 0 || wgt.link.parentIdx == 0)
+            continue;
+
+        // parent always precede it's children, so it's position is already calculated
+        const auto &parent = wgts[wgt.link.parentIdx];
+        cols.rects[i].coord.col += cols.rects[wgt.link.parentIdx].coord.col;
+        cols.rects[i].coord.row += cols.rects[wgt.link.parentIdx].coord.row;
+
+        if (parent.type == Widget::PageCtrl)
+            cols.rects[i].coord.col += parent.pagectrl.tabWidth;
+    }
+
+    return cols;
+}
+
 // -----------------------------------------------------------------------------
 
 } // namespace
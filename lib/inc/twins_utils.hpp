@@ -9,6 +9,7 @@
 
 #include "twins_string.hpp"
 #include "twins_vector.hpp"
+#include "twins_small_vector.hpp"
 #include "twins_common.hpp"
 
 #include <assert.h>
@@ -24,13 +25,16 @@ const char* strnchr(const char *str, int strSz, char c);
 /** @brief Like \b strchr() but with pointed end of string */
 const char* strechr(const char *str, const char *estr, char c);
 
+/** @brief Words of the splitWords(); up to 8 entries are kept without heap allocation */
+using Words = twins::SmallVector<twins::CStrView, 8>;
+
 /** @brief Split string into separate words using any of \p delim characters as delimiters
  *  @param str input string
  *  @param delim set of whitespace characters delimiting words
  *  @param storeDelim if true, every second entry returned is delimiter before next word
  *  @return vector of pointers to the beginning of text lines
  */
-twins::Vector<twins::CStrView> splitWords(const char *str, const char *delim = " \t\n", bool storeDelim = false);
+Words splitWords(const char *str, const char *delim = " \t\n", bool storeDelim = false);
 
 /** @brief Insert \p newLine and ellipsis to ensure the line length is always < \p maxLineLen
  *  @param str input string
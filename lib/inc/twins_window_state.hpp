@@ -13,6 +13,7 @@
 
 /** @brief Forward declaration */
 struct Widget;
+struct WidgetColumns;
 
 template <class T>
 class Vector;
@@ -48,6 +49,8 @@ public:
     virtual bool isFocused(const twins::Widget* pWgt) { return false; }
     virtual bool isVisible(const twins::Widget* pWgt) { return true; }
     virtual twins::WID& getFocusedID() = 0;
+    virtual const twins::FocusEntry* getFocusOrder() const { return nullptr; }
+    virtual const twins::WidgetColumns* getWidgetColumns() const { return nullptr; }
     // widget-specific queries
     virtual void getWindowCoord(const twins::Widget* pWgt, twins::Coord &coord) {}
     virtual void getWindowTitle(const twins::Widget* pWgt, twins::String &title) {}
@@ -65,6 +68,15 @@ public:
     virtual int  getRadioIndex(const twins::Widget* pWgt) { return -1; }
     virtual void getTextBoxState(const twins::Widget* pWgt, const twins::Vector<twins::CStrView> **ppLines, int16_t &topLine) {}
     virtual void getButtonText(const twins::Widget* pWgt, twins::String &out) {}
+    // zero-copy text queries, tried before their String counterparts;
+    // returned text must remain valid until the widget drawing is finished;
+    // view with data == nullptr means "not provided"
+    virtual twins::CStrView getLabelTextView(const twins::Widget* pWgt) { return {}; }
+    virtual twins::CStrView getTextEditTextView(const twins::Widget* pWgt) { return {}; }
+    virtual twins::CStrView getLedTextView(const twins::Widget* pWgt) { return {}; }
+    virtual twins::CStrView getListBoxItemView(const twins::Widget* pWgt, int itemIdx) { return {}; }
+    virtual twins::CStrView getComboBoxItemView(const twins::Widget* pWgt, int itemIdx) { return {}; }
+    virtual twins::CStrView getButtonTextView(const twins::Widget* pWgt) { return {}; }
 
 public:
     // requests
@@ -7,6 +7,9 @@
 
 #pragma once
 #include "twins.hpp"
+#include "twins_vector.hpp"
+
+#include <string.h>
 
  // -----------------------------------------------------------------------------
 
@@ -38,15 +41,247 @@ public:
         return pWgt->id == mFocusedId;
     }
 
+    const twins::FocusEntry* getFocusOrder() const override
+    {
+        return mpFocusOrder;
+    }
+
+    /** @brief Set the Tab-order table generated by transformWindowFocusOrder() */
+    void setFocusOrder(const twins::FocusEntry* pFocusOrder)
+    {
+        mpFocusOrder = pFocusOrder;
+    }
+
+    const twins::WidgetColumns* getWidgetColumns() const override
+    {
+        return mpColumns;
+    }
+
+    /** @brief Set the compact window form generated by transformWindowColumns(); the Widget array passed to init() may be \b nullptr then */
+    void setWidgetColumns(const twins::WidgetColumns* pColumns)
+    {
+        mpColumns = pColumns;
+    }
+
+    // --- default event handlers, updating the properties store ---
+
+    void onCheckboxToggle(const twins::Widget* pWgt) override
+    {
+        updateProp(pWgt->id, [](WidgetProp &p) { p.chbx.checked = !p.chbx.checked; });
+    }
+
+    void onListBoxSelect(const twins::Widget* pWgt, int16_t selIdx) override
+    {
+        updateProp(pWgt->id, [=](WidgetProp &p) { p.lbx.selIdx = selIdx; });
+    }
+
+    void onListBoxChange(const twins::Widget* pWgt, int16_t newIdx) override
+    {
+        updateProp(pWgt->id, [=](WidgetProp &p) { p.lbx.itemIdx = newIdx; p.lbx.selIdx = newIdx; });
+    }
+
+    void onComboBoxSelect(const twins::Widget* pWgt, int16_t selIdx) override
+    {
+        updateProp(pWgt->id, [=](WidgetProp &p) { p.cbbx.selIdx = selIdx; });
+    }
+
+    void onComboBoxChange(const twins::Widget* pWgt, int16_t newIdx) override
+    {
+        updateProp(pWgt->id, [=](WidgetProp &p) { p.cbbx.itemIdx = newIdx; });
+    }
+
+    void onComboBoxDrop(const twins::Widget* pWgt, bool dropState) override
+    {
+        updateProp(pWgt->id, [=](WidgetProp &p)
+        {
+            p.cbbx.dropDown = dropState;
+            if (dropState) p.cbbx.selIdx = p.cbbx.itemIdx;
+        });
+    }
+
+    void onTextBoxScroll(const twins::Widget* pWgt, int16_t topLine) override
+    {
+        updateProp(pWgt->id, [=](WidgetProp &p) { p.txtbx.topLine = topLine; });
+    }
+
+    // --- default state queries, served from the properties store ---
+
+    bool isEnabled(const twins::Widget* pWgt) override
+    {
+        const auto *p_prop = getProp(pWgt);
+        return p_prop ? p_prop->enabled : true;
+    }
+
+    bool getCheckboxChecked(const twins::Widget* pWgt) override
+    {
+        const auto *p_prop = getProp(pWgt);
+        return p_prop ? p_prop->chbx.checked : false;
+    }
+
+    bool getLedLit(const twins::Widget* pWgt) override
+    {
+        const auto *p_prop = getProp(pWgt);
+        return p_prop ? p_prop->led.lit : false;
+    }
+
+    void getLedText(const twins::Widget* pWgt, twins::String &out) override
+    {
+        const auto *p_prop = getProp(pWgt);
+        if (p_prop && p_prop->led.txt)
+            out = p_prop->led.txt;
+    }
+
+    twins::CStrView getLedTextView(const twins::Widget* pWgt) override
+    {
+        const auto *p_prop = getProp(pWgt);
+        if (p_prop && p_prop->led.txt)
+            return { p_prop->led.txt, (unsigned)strlen(p_prop->led.txt) };
+        return {};
+    }
+
+    void getProgressBarState(const twins::Widget* pWgt, int32_t &pos, int32_t &max) override
+    {
+        if (const auto *p_prop = getProp(pWgt))
+        {
+            pos = p_prop->pgbar.pos;
+            max = p_prop->pgbar.max;
+        }
+    }
+
+    void getListBoxState(const twins::Widget* pWgt, int16_t &itemIdx, int16_t &selIdx, int16_t &itemsCount) override
+    {
+        if (const auto *p_prop = getProp(pWgt))
+        {
+            itemIdx = p_prop->lbx.itemIdx;
+            selIdx = p_prop->lbx.selIdx;
+            itemsCount = p_prop->lbx.itemsCount;
+        }
+    }
+
+    void getComboBoxState(const twins::Widget* pWgt, int16_t &itemIdx, int16_t &selIdx, int16_t &itemsCount, bool &dropDown) override
+    {
+        if (const auto *p_prop = getProp(pWgt))
+        {
+            itemIdx = p_prop->cbbx.itemIdx;
+            selIdx = p_prop->cbbx.selIdx;
+            itemsCount = p_prop->cbbx.itemsCount;
+            dropDown = p_prop->cbbx.dropDown;
+        }
+    }
+
+    void getTextBoxState(const twins::Widget* pWgt, const twins::Vector<twins::CStrView> **ppLines, int16_t &topLine) override
+    {
+        if (const auto *p_prop = getProp(pWgt))
+            topLine = p_prop->txtbx.topLine;
+    }
+
+    // --- optional properties store ---
+
+    /** @brief Allocate the store of properties, one entry per window widget; call after init() and setWidgetColumns() */
+    void initPropStore()
+    {
+        unsigned n = 0;
+        if (mpWgts)
+        {
+            while (mpWgts[n].type != Widget::None)
+                n++;
+        }
+        else if (mpColumns)
+        {
+            n = mpColumns->count;
+        }
+
+        mProps.resize(n);
+        memset((void*)mProps.data(), 0, n * sizeof(WidgetProp));
+        for (auto &prop : mProps)
+            prop.enabled = true;
+    }
+
+    /** @brief Returns widget properties or \b nullptr if store is not allocated */
+    const WidgetProp* getProp(const twins::Widget* pWgt) const
+    {
+        if (pWgt->link.ownIdx < mProps.size())
+            return &mProps[pWgt->link.ownIdx];
+        return nullptr;
+    }
+
+    /**
+     * @brief Modify widget properties by \p modifier(WidgetProp&);
+     *        the widget is invalidated only if properties really changed
+     * @return \b true if changed
+     */
+    template<typename Fn>
+    bool updateProp(twins::WID id, Fn modifier)
+    {
+        const int idx = getWidgetIdx(id);
+        if (idx < 0 || idx >= mProps.size())
+            return false;
+
+        auto &prop = mProps[idx];
+        const WidgetProp prev = prop;
+        modifier(prop);
+
+        if (memcmp(&prev, &prop, sizeof(prop)) == 0)
+            return false;
+
+        invalidate(id);
+        return true;
+    }
+
+    bool setEnabled(twins::WID id, bool enabled)
+    {
+        return updateProp(id, [=](WidgetProp &p) { p.enabled = enabled; });
+    }
+
+    bool setCheckboxChecked(twins::WID id, bool checked)
+    {
+        return updateProp(id, [=](WidgetProp &p) { p.chbx.checked = checked; });
+    }
+
+    bool setLedLit(twins::WID id, bool lit)
+    {
+        return updateProp(id, [=](WidgetProp &p) { p.led.lit = lit; });
+    }
+
+    bool setLedText(twins::WID id, const char *txt)
+    {
+        return updateProp(id, [=](WidgetProp &p) { p.led.txt = txt; });
+    }
+
+    bool setProgressBarState(twins::WID id, int32_t pos, int32_t max)
+    {
+        return updateProp(id, [=](WidgetProp &p) { p.pgbar.pos = pos; p.pgbar.max = max; });
+    }
+
+    bool setListBoxState(twins::WID id, int16_t itemIdx, int16_t selIdx, int16_t itemsCount)
+    {
+        return updateProp(id, [=](WidgetProp &p) { p.lbx.itemIdx = itemIdx; p.lbx.selIdx = selIdx; p.lbx.itemsCount = itemsCount; });
+    }
+
+    bool setComboBoxState(twins::WID id, int16_t itemIdx, int16_t selIdx, int16_t itemsCount, bool dropDown)
+    {
+        return updateProp(id, [=](WidgetProp &p) { p.cbbx.itemIdx = itemIdx; p.cbbx.selIdx = selIdx; p.cbbx.itemsCount = itemsCount; p.cbbx.dropDown = dropDown; });
+    }
+
+    bool setTextBoxTopLine(twins::WID id, int16_t topLine)
+    {
+        return updateProp(id, [=](WidgetProp &p) { p.txtbx.topLine = topLine; });
+    }
+
+    // ---
+
     void invalidateImpl(const twins::WID *pId, uint16_t count, bool instantly) override
     {
         if (count == 1 && *pId == twins::WIDGET_ID_NONE)
             return;
 
+        if (twins::deferRedraw(*this, pId, count))
+            return;
+
         // state or focus changed - widget must be repainted
-        if (getWidgets())
+        if (getWidgets() || getWidgetColumns())
         {
-            twins::drawWidgets(getWidgets(), pId, count);
+            twins::drawWidgets(static_cast<IWindowState&>(*this), pId, count);
             twins::flushBuffer();
         }
         else
@@ -55,9 +290,32 @@ public:
         }
     }
 
+protected:
+    /** @brief Index of widget \p id in the Widget array or in the columns, or -1 if not found */
+    int getWidgetIdx(twins::WID id) const
+    {
+        if (mpWgts)
+        {
+            const auto *p_wgt = twins::getWidget(mpWgts, id);
+            return p_wgt ? p_wgt->link.ownIdx : -1;
+        }
+
+        if (mpColumns)
+        {
+            for (unsigned i = 0; i < mpColumns->count; i++)
+                if (mpColumns->pIds[i] == id)
+                    return i;
+        }
+
+        return -1;
+    }
+
 protected:
     WID mFocusedId;
     const Widget* mpWgts = nullptr;
+    const FocusEntry* mpFocusOrder = nullptr;
+    const WidgetColumns* mpColumns = nullptr;
+    Vector<WidgetProp> mProps;
 };
 
 //------------------------------------------------------------------------------
@@ -0,0 +1,329 @@
+/******************************************************************************
+ * @brief   TWins - static-dispatch (CRTP) window state
+ * @author  Mariusz Midor
+ *          https://bitbucket.org/marmidr/twins
+ *          https://github.com/marmidr/twins
+ *****************************************************************************/
+
+#pragma once
+#include "twins.hpp"
+
+#include <type_traits>
+
+ // -----------------------------------------------------------------------------
+
+namespace twins
+{
+
+/** @brief Member function signature, without the class and const qualifier */
+template <class T>
+struct MemberFnSig;
+
+template <class C, class R, class... Args>
+struct MemberFnSig<R (C::*)(Args...)> { using Class = C; using Type = R(Args...); };
+
+template <class C, class R, class... Args>
+struct MemberFnSig<R (C::*)(Args...) const> { using Class = C; using Type = R(Args...); };
+
+/** @brief Evaluates to \b true if member function pointer types \p D and \p B have the same signature */
+template <class D, class B>
+struct IsSameMemberFnSig : std::is_same<typename MemberFnSig<D>::Type, typename MemberFnSig<B>::Type> {};
+
+/**
+ * @brief Put in the body of the WindowStateT<Derived> method to make sure it replaces the default one;
+ *        misspelled name or different signature is reported in compile-time, like with \b override
+ */
+#define TWINS_STATE_OVERRIDE(method) \
+    static_assert(twins::IsSameMemberFnSig< \
+            decltype(&std::decay<decltype(*this)>::type::method), \
+            decltype(&twins::WindowStateT<typename std::decay<decltype(*this)>::type>::method)>::value, \
+        "WindowStateT: " #method "() signature differs from the IWindowState::" #method "()")
+
+/**
+ * @brief Window state base with static dispatch;
+ *        Derived class defines plain (non-virtual) methods with IWindowState names,
+ *        hiding the defaults below. The virtual interface, returned from getInterface(),
+ *        is used by the Window widget definition, the WndManager and the default invalidateImpl().
+ *        Opt-in: with TWINS_INSTANTIATE_WINDOW_STATE(Derived) put in one .cpp file,
+ *        twins::drawWidgets(state, ...) and twins::processInput(state, kc) run the library code
+ *        instantiated for the Derived class, so its methods are called without virtual dispatch
+ *        and trivial getters are inlined.
+ *        Derived method with different signature than the default is a compile-time error;
+ *        use TWINS_STATE_OVERRIDE() to catch misspelled method names as well.
+ * @code.cpp
+ *      struct WndMainState : twins::WindowStateT<WndMainState>
+ *      {
+ *          bool isEnabled(const twins::Widget* pWgt) { TWINS_STATE_OVERRIDE(isEnabled); return pWgt->id != ID_BTN_NO; }
+ *      };
+ *
+ *      static WndMainState wndMain;
+ *      twins::IWindowState* getWndMain() { return wndMain.getInterface(); }
+ *      ...
+ *      twins::processInput(wndMain, kc);
+ *
+ *      // wnd_main.cpp
+ *      #include "twins_window_state_crtp_inst.hpp"
+ *      TWINS_INSTANTIATE_WINDOW_STATE(WndMainState);
+ * @endcode
+ */
+template <class Derived>
+class WindowStateT
+{
+public:
+    WindowStateT() { checkDerived(); }
+    WindowStateT(const WindowStateT&) = delete;
+    WindowStateT& operator=(const WindowStateT&) = delete;
+
+    /** @brief Returns virtual interface to be used by the library */
+    IWindowState* getInterface() { return &mAdapter; }
+
+    // default implementation
+    void init(const twins::Widget *pWindowWgts)
+    {
+        mFocusedId = WIDGET_ID_NONE;
+        mpWgts = pWindowWgts;
+    }
+
+    const twins::Widget* getWidgets() const { return mpWgts; }
+    // events
+    void onButtonDown(const twins::Widget* pWgt, const twins::KeyCode &kc) {}
+    void onButtonUp(const twins::Widget* pWgt, const twins::KeyCode &kc) {}
+    void onButtonClick(const twins::Widget* pWgt, const twins::KeyCode &kc) {}
+    bool onButtonKey(const twins::Widget* pWgt, const twins::KeyCode &kc) { return false; }
+    void onTextEditChange(const twins::Widget* pWgt, twins::String &&str) {}
+    bool onTextEditInputEvt(const twins::Widget* pWgt, const twins::KeyCode &kc, twins::String &str, int16_t &cursorPos) { return false; }
+    void onCheckboxToggle(const twins::Widget* pWgt) {}
+    void onPageControlPageChange(const twins::Widget* pWgt, uint8_t newPageIdx) {}
+    void onListBoxSelect(const twins::Widget* pWgt, int16_t selIdx) {}
+    void onListBoxChange(const twins::Widget* pWgt, int16_t newIdx) {}
+    void onComboBoxSelect(const twins::Widget* pWgt, int16_t selIdx) {}
+    void onComboBoxChange(const twins::Widget* pWgt, int16_t newIdx) {}
+    void onComboBoxDrop(const twins::Widget* pWgt, bool dropState) {}
+    void onRadioSelect(const twins::Widget* pWgt) {}
+    void onTextBoxScroll(const twins::Widget* pWgt, int16_t topLine) {}
+    void onCustomWidgetDraw(const twins::Widget* pWgt) {}
+    bool onCustomWidgetInputEvt(const twins::Widget* pWgt, const twins::KeyCode &kc) { return false; }
+    bool onWindowUnhandledInputEvt(const twins::Widget* pWgt, const twins::KeyCode &kc) { return false; }
+    // common state queries
+    bool isEnabled(const twins::Widget* pWgt) { return true; }
+    bool isFocused(const twins::Widget* pWgt) { return pWgt->id == mFocusedId; }
+    bool isVisible(const twins::Widget* pWgt) { return true; }
+    twins::WID& getFocusedID() { return mFocusedId; }
+    const twins::FocusEntry* getFocusOrder() const { return nullptr; }
+    const twins::WidgetColumns* getWidgetColumns() const { return nullptr; }
+    // widget-specific queries
+    void getWindowCoord(const twins::Widget* pWgt, twins::Coord &coord) {}
+    void getWindowTitle(const twins::Widget* pWgt, twins::String &title) {}
+    bool getCheckboxChecked(const twins::Widget* pWgt) { return false; }
+    void getLabelText(const twins::Widget* pWgt, twins::String &out) {}
+    void getTextEditText(const twins::Widget* pWgt, twins::String &out, bool editMode) {}
+    bool getLedLit(const twins::Widget* pWgt) { return false; }
+    void getLedText(const twins::Widget* pWgt, twins::String &out) {}
+    void getProgressBarState(const twins::Widget* pWgt, int32_t &pos, int32_t &max) {}
+    int  getPageCtrlPageIndex(const twins::Widget* pWgt) { return 0; }
+    void getListBoxState(const twins::Widget* pWgt, int16_t &itemIdx, int16_t &selIdx, int16_t &itemsCount) {}
+    void getListBoxItem(const twins::Widget* pWgt, int itemIdx, twins::String &out) {}
+    void getComboBoxState(const twins::Widget* pWgt, int16_t &itemIdx, int16_t &selIdx, int16_t &itemsCount, bool &dropDown) {}
+    void getComboBoxItem(const twins::Widget* pWgt, int itemIdx, twins::String &out) {}
+    int  getRadioIndex(const twins::Widget* pWgt) { return -1; }
+    void getTextBoxState(const twins::Widget* pWgt, const twins::Vector<twins::CStrView> **ppLines, int16_t &topLine) {}
+    void getButtonText(const twins::Widget* pWgt, twins::String &out) {}
+    twins::CStrView getLabelTextView(const twins::Widget* pWgt) { return {}; }
+    twins::CStrView getTextEditTextView(const twins::Widget* pWgt) { return {}; }
+    twins::CStrView getLedTextView(const twins::Widget* pWgt) { return {}; }
+    twins::CStrView getListBoxItemView(const twins::Widget* pWgt, int itemIdx) { return {}; }
+    twins::CStrView getComboBoxItemView(const twins::Widget* pWgt, int itemIdx) { return {}; }
+    twins::CStrView getButtonTextView(const twins::Widget* pWgt) { return {}; }
+
+    // requests
+    void invalidate(twins::WID id, bool instantly = false)                                { derived().invalidateImpl(&id, 1, instantly); }
+    void invalidate(const std::initializer_list<twins::WID> &ids, bool instantly = false) { derived().invalidateImpl(ids.begin(), ids.size(), instantly); }
+
+    void invalidateImpl(const twins::WID *pId, uint16_t count, bool instantly)
+    {
+        if (count == 1 && *pId == twins::WIDGET_ID_NONE)
+            return;
+
+        if (twins::deferRedraw(*getInterface(), pId, count))
+            return;
+
+        // state or focus changed - widget must be repainted
+        if (mpWgts || derived().getWidgetColumns())
+        {
+            twins::drawWidgets(*getInterface(), pId, count);
+            twins::flushBuffer();
+        }
+        else
+        {
+            TWINS_LOG_E("Window state not initialized");
+        }
+    }
+
+protected:
+    Derived& derived() { return static_cast<Derived&>(*this); }
+    const Derived& derived() const { return static_cast<const Derived&>(*this); }
+
+private:
+    /** @brief Derived is complete here */
+    static void checkDerived()
+    {
+    #define TWINS_CHECK_SIG(method) \
+        static_assert(IsSameMemberFnSig<decltype(&Derived::method), decltype(&WindowStateT::method)>::value, \
+            "WindowStateT: " #method "() signature differs from the IWindowState::" #method "()")
+
+        TWINS_CHECK_SIG(init);
+        TWINS_CHECK_SIG(getWidgets);
+        TWINS_CHECK_SIG(onButtonDown);
+        TWINS_CHECK_SIG(onButtonUp);
+        TWINS_CHECK_SIG(onButtonClick);
+        TWINS_CHECK_SIG(onButtonKey);
+        TWINS_CHECK_SIG(onTextEditChange);
+        TWINS_CHECK_SIG(onTextEditInputEvt);
+        TWINS_CHECK_SIG(onCheckboxToggle);
+        TWINS_CHECK_SIG(onPageControlPageChange);
+        TWINS_CHECK_SIG(onListBoxSelect);
+        TWINS_CHECK_SIG(onListBoxChange);
+        TWINS_CHECK_SIG(onComboBoxSelect);
+        TWINS_CHECK_SIG(onComboBoxChange);
+        TWINS_CHECK_SIG(onComboBoxDrop);
+        TWINS_CHECK_SIG(onRadioSelect);
+        TWINS_CHECK_SIG(onTextBoxScroll);
+        TWINS_CHECK_SIG(onCustomWidgetDraw);
+        TWINS_CHECK_SIG(onCustomWidgetInputEvt);
+        TWINS_CHECK_SIG(onWindowUnhandledInputEvt);
+        TWINS_CHECK_SIG(isEnabled);
+        TWINS_CHECK_SIG(isFocused);
+        TWINS_CHECK_SIG(isVisible);
+        TWINS_CHECK_SIG(getFocusedID);
+        TWINS_CHECK_SIG(getFocusOrder);
+        TWINS_CHECK_SIG(getWidgetColumns);
+        TWINS_CHECK_SIG(getWindowCoord);
+        TWINS_CHECK_SIG(getWindowTitle);
+        TWINS_CHECK_SIG(getCheckboxChecked);
+        TWINS_CHECK_SIG(getLabelText);
+        TWINS_CHECK_SIG(getTextEditText);
+        TWINS_CHECK_SIG(getLedLit);
+        TWINS_CHECK_SIG(getLedText);
+        TWINS_CHECK_SIG(getProgressBarState);
+        TWINS_CHECK_SIG(getPageCtrlPageIndex);
+        TWINS_CHECK_SIG(getListBoxState);
+        TWINS_CHECK_SIG(getListBoxItem);
+        TWINS_CHECK_SIG(getComboBoxState);
+        TWINS_CHECK_SIG(getComboBoxItem);
+        TWINS_CHECK_SIG(getRadioIndex);
+        TWINS_CHECK_SIG(getTextBoxState);
+        TWINS_CHECK_SIG(getButtonText);
+        TWINS_CHECK_SIG(getLabelTextView);
+        TWINS_CHECK_SIG(getTextEditTextView);
+        TWINS_CHECK_SIG(getLedTextView);
+        TWINS_CHECK_SIG(getListBoxItemView);
+        TWINS_CHECK_SIG(getComboBoxItemView);
+        TWINS_CHECK_SIG(getButtonTextView);
+        TWINS_CHECK_SIG(invalidateImpl);
+
+    #undef TWINS_CHECK_SIG
+    }
+
+protected:
+    WID mFocusedId = WIDGET_ID_NONE;
+    const Widget* mpWgts = nullptr;
+
+private:
+    /** @brief The only place where the virtual calls are resolved */
+    class Adapter final : public IWindowState
+    {
+    public:
+        Adapter(WindowStateT *pOwner) : mpOwner(pOwner) {}
+
+        void init(const twins::Widget *pWindowWgts) override { d().init(pWindowWgts); }
+        const twins::Widget *getWidgets() const override { return cd().getWidgets(); }
+        // events
+        void onButtonDown(const twins::Widget* pWgt, const twins::KeyCode &kc) override { d().onButtonDown(pWgt, kc); }
+        void onButtonUp(const twins::Widget* pWgt, const twins::KeyCode &kc) override { d().onButtonUp(pWgt, kc); }
+        void onButtonClick(const twins::Widget* pWgt, const twins::KeyCode &kc) override { d().onButtonClick(pWgt, kc); }
+        bool onButtonKey(const twins::Widget* pWgt, const twins::KeyCode &kc) override { return d().onButtonKey(pWgt, kc); }
+        void onTextEditChange(const twins::Widget* pWgt, twins::String &&str) override { d().onTextEditChange(pWgt, std::move(str)); }
+        bool onTextEditInputEvt(const twins::Widget* pWgt, const twins::KeyCode &kc, twins::String &str, int16_t &cursorPos) override { return d().onTextEditInputEvt(pWgt, kc, str, cursorPos); }
+        void onCheckboxToggle(const twins::Widget* pWgt) override { d().onCheckboxToggle(pWgt); }
+        void onPageControlPageChange(const twins::Widget* pWgt, uint8_t newPageIdx) override { d().onPageControlPageChange(pWgt, newPageIdx); }
+        void onListBoxSelect(const twins::Widget* pWgt, int16_t selIdx) override { d().onListBoxSelect(pWgt, selIdx); }
+        void onListBoxChange(const twins::Widget* pWgt, int16_t newIdx) override { d().onListBoxChange(pWgt, newIdx); }
+        void onComboBoxSelect(const twins::Widget* pWgt, int16_t selIdx) override { d().onComboBoxSelect(pWgt, selIdx); }
+        void onComboBoxChange(const twins::Widget* pWgt, int16_t newIdx) override { d().onComboBoxChange(pWgt, newIdx); }
+        void onComboBoxDrop(const twins::Widget* pWgt, bool dropState) override { d().onComboBoxDrop(pWgt, dropState); }
+        void onRadioSelect(const twins::Widget* pWgt) override { d().onRadioSelect(pWgt); }
+        void onTextBoxScroll(const twins::Widget* pWgt, int16_t topLine) override { d().onTextBoxScroll(pWgt, topLine); }
+        void onCustomWidgetDraw(const twins::Widget* pWgt) override { d().onCustomWidgetDraw(pWgt); }
+        bool onCustomWidgetInputEvt(const twins::Widget* pWgt, const twins::KeyCode &kc) override { return d().onCustomWidgetInputEvt(pWgt, kc); }
+        bool onWindowUnhandledInputEvt(const twins::Widget* pWgt, const twins::KeyCode &kc) override { return d().onWindowUnhandledInputEvt(pWgt, kc); }
+        // common state queries
+        bool isEnabled(const twins::Widget* pWgt) override { return d().isEnabled(pWgt); }
+        bool isFocused(const twins::Widget* pWgt) override { return d().isFocused(pWgt); }
+        bool isVisible(const twins::Widget* pWgt) override { return d().isVisible(pWgt); }
+        twins::WID& getFocusedID() override { return d().getFocusedID(); }
+        const twins::FocusEntry* getFocusOrder() const override { return cd().getFocusOrder(); }
+        const twins::WidgetColumns* getWidgetColumns() const override { return cd().getWidgetColumns(); }
+        // widget-specific queries
+        void getWindowCoord(const twins::Widget* pWgt, twins::Coord &coord) override { d().getWindowCoord(pWgt, coord); }
+        void getWindowTitle(const twins::Widget* pWgt, twins::String &title) override { d().getWindowTitle(pWgt, title); }
+        bool getCheckboxChecked(const twins::Widget* pWgt) override { return d().getCheckboxChecked(pWgt); }
+        void getLabelText(const twins::Widget* pWgt, twins::String &out) override { d().getLabelText(pWgt, out); }
+        void getTextEditText(const twins::Widget* pWgt, twins::String &out, bool editMode) override { d().getTextEditText(pWgt, out, editMode); }
+        bool getLedLit(const twins::Widget* pWgt) override { return d().getLedLit(pWgt); }
+        void getLedText(const twins::Widget* pWgt, twins::String &out) override { d().getLedText(pWgt, out); }
+        void getProgressBarState(const twins::Widget* pWgt, int32_t &pos, int32_t &max) override { d().getProgressBarState(pWgt, pos, max); }
+        int  getPageCtrlPageIndex(const twins::Widget* pWgt) override { return d().getPageCtrlPageIndex(pWgt); }
+        void getListBoxState(const twins::Widget* pWgt, int16_t &itemIdx, int16_t &selIdx, int16_t &itemsCount) override { d().getListBoxState(pWgt, itemIdx, selIdx, itemsCount); }
+        void getListBoxItem(const twins::Widget* pWgt, int itemIdx, twins::String &out) override { d().getListBoxItem(pWgt, itemIdx, out); }
+        void getComboBoxState(const twins::Widget* pWgt, int16_t &itemIdx, int16_t &selIdx, int16_t &itemsCount, bool &dropDown) override { d().getComboBoxState(pWgt, itemIdx, selIdx, itemsCount, dropDown); }
+        void getComboBoxItem(const twins::Widget* pWgt, int itemIdx, twins::String &out) override { d().getComboBoxItem(pWgt, itemIdx, out); }
+        int  getRadioIndex(const twins::Widget* pWgt) override { return d().getRadioIndex(pWgt); }
+        void getTextBoxState(const twins::Widget* pWgt, const twins::Vector<twins::CStrView> **ppLines, int16_t &topLine) override { d().getTextBoxState(pWgt, ppLines, topLine); }
+        void getButtonText(const twins::Widget* pWgt, twins::String &out) override { d().getButtonText(pWgt, out); }
+        twins::CStrView getLabelTextView(const twins::Widget* pWgt) override { return d().getLabelTextView(pWgt); }
+        twins::CStrView getTextEditTextView(const twins::Widget* pWgt) override { return d().getTextEditTextView(pWgt); }
+        twins::CStrView getLedTextView(const twins::Widget* pWgt) override { return d().getLedTextView(pWgt); }
+        twins::CStrView getListBoxItemView(const twins::Widget* pWgt, int itemIdx) override { return d().getListBoxItemView(pWgt, itemIdx); }
+        twins::CStrView getComboBoxItemView(const twins::Widget* pWgt, int itemIdx) override { return d().getComboBoxItemView(pWgt, itemIdx); }
+        twins::CStrView getButtonTextView(const twins::Widget* pWgt) override { return d().getButtonTextView(pWgt); }
+
+    protected:
+        void invalidateImpl(const twins::WID *pId, uint16_t count, bool instantly) override { d().invalidateImpl(pId, count, instantly); }
+
+    private:
+        // Derived is complete and constructed when any of the methods is called
+        Derived& d() { return static_cast<Derived&>(*mpOwner); }
+        const Derived& cd() const { return static_cast<const Derived&>(*mpOwner); }
+
+    private:
+        WindowStateT *mpOwner;
+    };
+
+    Adapter mAdapter { this };
+};
+
+//------------------------------------------------------------------------------
+
+/**
+ * @brief Draw selected widgets of the static-dispatch window state;
+ *        requires TWINS_INSTANTIATE_WINDOW_STATE(Derived)
+ */
+template <class Derived>
+void drawWidgets(WindowStateT<Derived> &state, const WID *pWidgetIds, uint16_t count);
+
+template <class Derived>
+inline void drawWidgets(WindowStateT<Derived> &state, const std::initializer_list<WID> &ids)
+{
+    drawWidgets(state, ids.begin(), ids.size());
+}
+
+/**
+ * @brief Process keyboard/mouse signal with the static-dispatch window state;
+ *        requires TWINS_INSTANTIATE_WINDOW_STATE(Derived)
+ */
+template <class Derived>
+bool processInput(WindowStateT<Derived> &state, const KeyCode &kc);
+
+//------------------------------------------------------------------------------
+
+}
@@ -0,0 +1,44 @@
+/******************************************************************************
+ * @brief   TWins - widget engine instantiation for the static-dispatch window state;
+ *          include in one .cpp file only, next to TWINS_INSTANTIATE_WINDOW_STATE()
+ * @author  Mariusz Midor
+ *          https://bitbucket.org/marmidr/twins
+ *          https://github.com/marmidr/twins
+ *****************************************************************************/
+
+#pragma once
+#include "twins_window_state_crtp.hpp"
+#include "../src/twins_widget_draw_impl.hpp"
+
+// -----------------------------------------------------------------------------
+
+namespace twins
+{
+
+template <class Derived>
+void drawWidgets(WindowStateT<Derived> &state, const WID *pWidgetIds, uint16_t count)
+{
+    if (count == 0)
+        return;
+
+    Derived &derived = static_cast<Derived&>(state);
+    CallCtxT<Derived> ctx(derived.getWidgets(), &derived);
+    drawWidgetsImpl(ctx, pWidgetIds, count);
+}
+
+template <class Derived>
+bool processInput(WindowStateT<Derived> &state, const KeyCode &kc)
+{
+    Derived &derived = static_cast<Derived&>(state);
+    CallCtxT<Derived> ctx(derived.getWidgets(), &derived);
+    return processInputImpl(ctx, kc);
+}
+
+// -----------------------------------------------------------------------------
+
+}
+
+/** @brief Instantiates twins::drawWidgets(state, ...) and twins::processInput(state, kc) for the \p Derived */
+#define TWINS_INSTANTIATE_WINDOW_STATE(Derived) \
+    template void twins::drawWidgets<Derived>(twins::WindowStateT<Derived>&, const twins::WID*, uint16_t); \
+    template bool twins::processInput<Derived>(twins::WindowStateT<Derived>&, const twins::KeyCode&)
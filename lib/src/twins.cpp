@@ -20,6 +20,14 @@
  #define TWINS_PRECISE_TIMESTAMP    0
 #endif
 
+#ifndef TWINS_STATIC_STACKS
+ #define TWINS_STATIC_STACKS        1
+#endif
+
+#ifndef TWINS_FONT_STACK_DEPTH
+ #define TWINS_FONT_STACK_DEPTH     32
+#endif
+
 namespace twins
 {
 struct StubPAL : twins::IPal
@@ -55,9 +63,15 @@ struct TwinsState
     int8_t  attrFaint = 0;
 
     /** @brief Font colors and attribute stacks */
+#if TWINS_STATIC_STACKS
+    StaticStack<ColorFG, TWINS_FONT_STACK_DEPTH> stackClFg;
+    StaticStack<ColorBG, TWINS_FONT_STACK_DEPTH> stackClBg;
+    StaticStack<FontAttrib, TWINS_FONT_STACK_DEPTH> stackAttr;
+#else
     Stack<ColorFG> stackClFg;
     Stack<ColorBG> stackClBg;
     Stack<FontAttrib> stackAttr;
+#endif
 
     /** logRaw() state */
     FontMementoManual logRawFontMemento;
@@ -72,9 +86,9 @@ TwinsState& g_ts = (TwinsState&)ts_buff;
 /** */
 void FontMementoManual::store()
 {
-    szFg = g_ts.stackClFg.size();
-    szBg = g_ts.stackClBg.size();
-    szAttr = g_ts.stackAttr.size();
+    szFg = g_ts.stackClFg.depth();
+    szBg = g_ts.stackClBg.depth();
+    szAttr = g_ts.stackAttr.depth();
 
     // stackClFg.push(currentClFg);
     // stackClBg.push(currentClBg);
@@ -82,9 +96,9 @@ void FontMementoManual::store()
 
 void FontMementoManual::restore()
 {
-    popClFg(g_ts.stackClFg.size() - szFg);
-    popClBg(g_ts.stackClBg.size() - szBg);
-    popAttr(g_ts.stackAttr.size() - szAttr);
+    popClFg(g_ts.stackClFg.depth() - szFg);
+    popClBg(g_ts.stackClBg.depth() - szBg);
+    popAttr(g_ts.stackAttr.depth() - szAttr);
 }
 
 // -----------------------------------------------------------------------------
@@ -396,7 +410,7 @@ void mouseMode(MouseMode mode)
     switch (mode)
     {
     case MouseMode::Off:
-        writeStr(ESC_MOUSE_REPORTING_M1_OFF ESC_MOUSE_REPORTING_M2_OFF);
+        writeStr(ESC_MOUSE_REPORTING_M1_OFF ESC_MOUSE_REPORTING_M2_OFF ESC_MOUSE_REPORTING_M3_OFF ESC_MOUSE_REPORTING_SGR_OFF);
         break;
     case MouseMode::M1:
         writeStr(ESC_MOUSE_REPORTING_M1_ON);
@@ -404,11 +418,22 @@ void mouseMode(MouseMode mode)
     case MouseMode::M2:
         writeStr(ESC_MOUSE_REPORTING_M2_ON);
         break;
+    case MouseMode::SGR:
+        writeStr(ESC_MOUSE_REPORTING_M2_ON ESC_MOUSE_REPORTING_SGR_ON);
+        break;
+    case MouseMode::SGRMotion:
+        writeStr(ESC_MOUSE_REPORTING_M3_ON ESC_MOUSE_REPORTING_SGR_ON);
+        break;
     default:
         break;
     }
 }
 
+void bracketedPaste(bool on)
+{
+    writeStr(on ? ESC_BRACKETED_PASTE_ON : ESC_BRACKETED_PASTE_OFF);
+}
+
 // -----------------------------------------------------------------------------
 
 void pushClFg(ColorFG cl)
@@ -420,8 +445,10 @@ void pushClFg(ColorFG cl)
 
 void popClFg(int n)
 {
-    while (g_ts.stackClFg.size() && (n-- > 0))
-        g_ts.currentClFg = *g_ts.stackClFg.pop();
+    // color of the dropped push is unknown - the current one stays
+    while (g_ts.stackClFg.depth() && (n-- > 0))
+        if (auto *p_cl = g_ts.stackClFg.pop())
+            g_ts.currentClFg = *p_cl;
 
     writeStr(encodeCl(g_ts.currentClFg));
 }
@@ -443,8 +470,9 @@ void pushClBg(ColorBG cl)
 
 void popClBg(int n)
 {
-    while (g_ts.stackClBg.size() && (n-- > 0))
-        g_ts.currentClBg = *g_ts.stackClBg.pop();
+    while (g_ts.stackClBg.depth() && (n-- > 0))
+        if (auto *p_cl = g_ts.stackClBg.pop())
+            g_ts.currentClBg = *p_cl;
 
     writeStr(encodeCl(g_ts.currentClBg));
 }
@@ -477,9 +505,11 @@ void pushAttr(FontAttrib attr)
 
 void popAttr(int n)
 {
-    while (g_ts.stackAttr.size() && (n-- > 0))
+    while (g_ts.stackAttr.depth() && (n-- > 0))
     {
         auto *pAttr = g_ts.stackAttr.pop();
+        if (!pAttr)
+            continue;
 
         switch (*pAttr)
         {
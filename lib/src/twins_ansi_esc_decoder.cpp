@@ -4,9 +4,7 @@
  *          https://bitbucket.org/marmidr/twins
  *          https://github.com/marmidr/twins
  * @note    Based on Python script : https://wiki.bash-hackers.org/scripting/terminalcodes
- *          constexpr sorted array based on @stryku example:
- *              https://stackoverflow.com/questions/19559808/constexpr-initialization-of-array-to-sort-contents
- *          and https://ideone.com/CeeJUy
+ *          ESC sequences map is compiled into a state machine at compile time
  *****************************************************************************/
 
 #include "twins.hpp"
@@ -22,6 +20,19 @@
 # define TWINS_USE_KEY_NAMES 1
 #endif
 
+/** @brief Size of the bracketed paste buffer (static RAM); longer pastes are truncated;
+ *         0 disables Key::Paste - pasted text is decoded as regular keys */
+#ifndef TWINS_PASTE_MAX_LENGTH
+# define TWINS_PASTE_MAX_LENGTH 256
+#endif
+
+static_assert(TWINS_PASTE_MAX_LENGTH < UINT16_MAX);
+
+/** @brief Default time [ms] after which lone ESC is decoded as Key::Esc */
+#ifndef TWINS_ESC_TIMEOUT_MS
+# define TWINS_ESC_TIMEOUT_MS 25
+#endif
+
 
 #if TWINS_USE_KEY_NAMES
 # define KEY_DEF(seq, name, code, mod)   seq, name, (Key)code, mod, sizeof(seq)-1,
@@ -63,52 +74,110 @@ struct CtrlMap
 
 // -----------------------------------------------------------------------------
 
-/// @brief constexpr comparison operator needed for sort function
-constexpr bool operator <(const SeqMap &left, const SeqMap &right)
+/// @brief constexpr check if \p s1 and \p s2 have the same prefix of length \p len
+constexpr bool cex_same_prefix(const char *s1, const char *s2, unsigned len)
 {
-    const char *pl = left.seq;
-    const char *pr = right.seq;
+    for (unsigned i = 0; i < len; i++)
+        if (s1[i] != s2[i])
+            return false;
 
-    while (*pl == *pr)
-        pl++, pr++;
-    return *pl < *pr;
+    return true;
 }
 
-/// @brief constexpr swap
-template<class T>
-constexpr void cex_swap(T& lho, T& rho)
+/// @brief number of state machine states: the root + distinct proper prefixes of all sequences
+template <unsigned N>
+constexpr unsigned cex_dfa_states(const Array<SeqMap, N> &map)
 {
-    T tmp = std::move(lho);
-    lho = std::move(rho);
-    rho = std::move(tmp);
-}
+    unsigned states = 1;
 
-/// @brief constexpr sort
-template <typename T, unsigned N>
-constexpr void cex_sort_impl(Array<T, N> &array, unsigned left, unsigned right)
-{
-    if (left < right)
+    for (unsigned i = 0; i < N; i++)
     {
-        unsigned m = left;
+        for (unsigned l = 1; l < map[i].seqlen; l++)
+        {
+            bool seen = false;
 
-        for (unsigned i = left + 1; i < right; i++)
-            if (array[i] < array[left])
-                cex_swap(array[++m], array[i]);
+            for (unsigned j = 0; j < i && !seen; j++)
+                seen = map[j].seqlen > l && cex_same_prefix(map[i].seq, map[j].seq, l);
 
-        cex_swap(array[left], array[m]);
+            if (!seen)
+                states++;
+        }
+    }
+
+    return states;
+}
 
-        cex_sort_impl(array, left, m);
-        cex_sort_impl(array, m + 1, right);
+/// @brief number of distinct bytes used by all sequences
+template <unsigned N>
+constexpr unsigned cex_dfa_classes(const Array<SeqMap, N> &map)
+{
+    bool used[128] = {};
+    unsigned classes = 0;
+
+    for (unsigned i = 0; i < N; i++)
+    {
+        for (unsigned l = 0; l < map[i].seqlen; l++)
+        {
+            const uint8_t c = map[i].seq[l];
+
+            if (!used[c])
+            {
+                used[c] = true;
+                classes++;
+            }
+        }
     }
+
+    return classes;
 }
 
-/// @brief returns constexpr sorted array
-template <typename T, unsigned N>
-constexpr Array<T, N> cex_sort_arr(Array<T, N> array)
+/**
+ * @brief ESC sequences state machine: input byte is mapped to its class,
+ *        then \c next[state][class] gives the next state, the decoded key or 0 if sequence is unknown
+ */
+template <unsigned NStates, unsigned NClasses>
+struct EscDfa
+{
+    static constexpr uint16_t ACCEPT = 0x8000; // ACCEPT | index of the key in the map
+
+    uint8_t  byteClass[128] = {};               // 0: byte not used in any sequence; 1 + class otherwise
+    uint16_t next[NStates][NClasses] = {};
+};
+
+/// @brief returns constexpr state machine for given sequences \p map; no sequence may be a prefix of another
+template <unsigned NStates, unsigned NClasses, unsigned N>
+constexpr EscDfa<NStates, NClasses> cex_build_dfa(const Array<SeqMap, N> &map)
 {
-    auto sorted_array = array;
-    cex_sort_impl(sorted_array, 0, N);
-    return sorted_array;
+    EscDfa<NStates, NClasses> dfa{};
+    uint8_t classes = 0;
+    uint16_t states = 1;
+
+    for (unsigned i = 0; i < N; i++)
+    {
+        uint16_t st = 0;
+
+        for (unsigned l = 0; l < map[i].seqlen; l++)
+        {
+            const uint8_t c = map[i].seq[l];
+            if (!dfa.byteClass[c])
+                dfa.byteClass[c] = ++classes;
+
+            uint16_t &nx = dfa.next[st][dfa.byteClass[c] - 1];
+
+            if (l == map[i].seqlen - 1u)
+            {
+                nx = EscDfa<NStates, NClasses>::ACCEPT | i;
+            }
+            else
+            {
+                if (!nx)
+                    nx = states++;
+                st = nx;
+            }
+        }
+    }
+
+    return dfa;
 }
 
 // -----------------------------------------------------------------------------
@@ -278,10 +347,13 @@ constexpr Array<SeqMap, 155> esc_keys_map_unsorted
     // + Shift + Alt
 };
 
-constexpr auto esc_keys_map_sorted = cex_sort_arr(esc_keys_map_unsorted);
+constexpr auto esc_keys_dfa = cex_build_dfa<
+        cex_dfa_states(esc_keys_map_unsorted),
+        cex_dfa_classes(esc_keys_map_unsorted)
+    >(esc_keys_map_unsorted);
 
 
-const CtrlMap ctrl_keys_map[] =
+constexpr CtrlMap ctrl_keys_map[] =
 {
     // KEY_DEF( 0, "C-2", '2', KEY_MOD_CTRL)
     KEY_DEF(0x01, "C-A", 'A', KEY_MOD_CTRL)
@@ -313,7 +385,7 @@ const CtrlMap ctrl_keys_map[] =
 };
 
 
-const CtrlMap special_keys_map[] =
+constexpr CtrlMap special_keys_map[] =
 {
     KEY_DEF((char)Ansi::DEL,  "Backspace",  Key::Backspace, KEY_MOD_SPECIAL)
     KEY_DEF((char)Ansi::HT,   "Tab",        Key::Tab,       KEY_MOD_SPECIAL)
@@ -329,42 +401,87 @@ const CtrlMap special_keys_map[] =
 
 // -----------------------------------------------------------------------------
 
+/// @brief single byte keys lookup: 0 - none, 1 + i for special_keys_map[i], 0x80 + i for ctrl_keys_map[i]
+constexpr Array<uint8_t, 128> cex_single_keys()
+{
+    Array<uint8_t, 128> keys{};
+
+    for (unsigned i = 0; i < sizeof(ctrl_keys_map) / sizeof(ctrl_keys_map[0]); i++)
+        keys[(uint8_t)ctrl_keys_map[i].c] = 0x80 + i;
+
+    // special keys conflicts with ctrl_keys_map[] but have higher priority
+    for (unsigned i = 0; i < sizeof(special_keys_map) / sizeof(special_keys_map[0]); i++)
+        keys[(uint8_t)special_keys_map[i].c] = 1 + i;
+
+    return keys;
+}
+
+constexpr auto single_keys = cex_single_keys();
+
+// -----------------------------------------------------------------------------
+
 /**
- * @brief fast binary search of key-sequence \p seq in sorted \p map
- * @return pointer if found, nullptr otherwise
+ * @brief Length of UTF-8 sequence at \p seq, 0 if invalid or not complete within \p seqSz bytes
  */
-static const SeqMap *binary_search(const char *seq, const SeqMap map[], unsigned mapsize)
+static int utf8seqlenBounded(const char *seq, unsigned seqSz)
 {
-    if (!seq || !*seq || !mapsize)
-        return nullptr;
+    const uint8_t lead = seq[0];
+    unsigned expected = 1;
+
+    if ((lead & 0xE0) == 0xC0)
+        expected = 2;
+    else if ((lead & 0xF0) == 0xE0)
+        expected = 3;
+    else if ((lead & 0xF8) == 0xF0)
+        expected = 4;
+
+    // utf8seqlen() would read past the end
+    if (expected > seqSz)
+        return 0;
 
-    int lo = 0;
-    int hi = mapsize - 1;
-    int mid = (hi - lo) / 2;
-    //short steps = 1;
+    return utf8seqlen(seq);
+}
 
-    do
-    {
-        // map[mid].seq must not necessary be equal to seq, but be at the beginning of it
-        int compare = strncmp(seq, map[mid].seq, map[mid].seqlen);
+/**
+ * @brief Decode mouse button code \p code common for X10 and SGR reports; \p released is set for SGR 'm'
+ */
+static void decodeMouse(KeyCode &output, unsigned code, bool released)
+{
+    output.mouse.key = Key::MouseEvent;
+    output.mouse.btn = MouseBtn::None;
+    output.repeat = 1;
 
-        if (compare == 0)
+    if (released)
+    {
+        output.mouse.btn = MouseBtn::ButtonReleased;
+    }
+    else if (code & 0x20)
+    {
+        output.mouse.btn = MouseBtn::Motion;
+    }
+    else
+    {
+        switch (code & 0xC3)
         {
-            //printf("binar.found in %u steps\n", steps);
-            return &map[mid];
+        case 0x00: output.mouse.btn = MouseBtn::ButtonLeft; break;
+        case 0x01: output.mouse.btn = MouseBtn::ButtonMid; break;
+        case 0x02: output.mouse.btn = MouseBtn::ButtonRight; break;
+        case 0x03: output.mouse.btn = MouseBtn::ButtonReleased; break;
+        case 0x80: output.mouse.btn = MouseBtn::ButtonGoBack; break;
+        case 0x81: output.mouse.btn = MouseBtn::ButtonGoForward; break;
+        case 0x40: output.mouse.btn = MouseBtn::WheelUp; break;
+        case 0x41: output.mouse.btn = MouseBtn::WheelDown; break;
+        default: break;
         }
-        else if (compare > 0)
-            lo = mid + 1;
-        else
-            hi = mid - 1;
-
-        mid = lo + ((hi - lo) / 2);
-        //steps++;
     }
-    while (hi >= lo);
 
-    // seq not found
-    return nullptr;
+    if (code & 0x04) output.m_shift = 1;
+    if (code & 0x08) output.m_alt = 1;
+    if (code & 0x10) output.m_ctrl = 1;
+
+    #if TWINS_USE_KEY_NAMES
+    output.name = output.mouse.btn == MouseBtn::Motion ? "MouseMove" : "MouseClk";
+    #endif
 }
 
 // -----------------------------------------------------------------------------
@@ -372,6 +489,38 @@ static const SeqMap *binary_search(const char *seq, const SeqMap map[], unsigned
 static uint8_t decodeFailCtr = 0;
 static uint8_t prevCR = 0;
 static bool prevEscIgnored = false;
+static uint32_t prevEscTimestamp = 0;
+static uint16_t escTimeoutMs = TWINS_ESC_TIMEOUT_MS;
+static uint32_t lastTimestamp = 0;
+static bool palClockRuns = false;
+
+/** @brief PAL time stamp; notes if the PAL clock runs at all, as the stub implementations return 0 */
+static uint32_t getEscTimeStamp()
+{
+    const uint32_t ts = pPAL ? pPAL->getTimeStamp() : 0;
+    if (ts != lastTimestamp)
+        palClockRuns = true;
+    lastTimestamp = ts;
+    return ts;
+}
+
+/** @brief State machine position within incomplete ESC sequence, to resume when more data arrives */
+static struct
+{
+    const void *pInput;
+    uint16_t    state;
+    uint8_t     pos;    // 0: nothing to resume; otherwise index of the next byte to feed
+} escDfa;
+
+static constexpr uint8_t PASTE_MARKER_LEN = sizeof(ESC_PASTE_BEGIN)-1;
+static char pasteBuff[TWINS_PASTE_MAX_LENGTH + 1];
+
+/** @brief Bracketed paste in progress */
+static struct
+{
+    bool        active;
+    uint16_t    size;
+} paste;
 
 void decodeInputSeqReset()
 {
@@ -379,23 +528,100 @@ void decodeInputSeqReset()
     decodeFailCtr = 0;
     prevCR = 0;
     prevEscIgnored = false;
+    lastTimestamp = 0;
+    palClockRuns = false;
+    escDfa = {};
+    paste = {};
 }
 
-uint8_t decodeInputSeq(RingBuff<char> &input, KeyCode &output)
+/**
+ * @brief Collect pasted text until the end marker; text above TWINS_PASTE_MAX_LENGTH
+ *        and ESC characters are dropped
+ * @return Length of the end marker when paste is complete, 0 otherwise
+ */
+template <class RB>
+static uint8_t decodePaste(RB &input, KeyCode &output)
+{
+    while (input.size())
+    {
+        Span<const char> span1, span2;
+        input.readSpans(span1, span2);
+
+        const char *p_esc = (const char*)memchr(span1.data, (char)Ansi::ESC, span1.size);
+        const uint16_t text_sz = p_esc ? p_esc - span1.data : span1.size;
+
+        if (text_sz)
+        {
+            uint16_t to_copy = TWINS_PASTE_MAX_LENGTH - paste.size;
+            if (to_copy > text_sz)
+                to_copy = text_sz;
+
+            memcpy(pasteBuff + paste.size, span1.data, to_copy);
+            paste.size += to_copy;
+            input.skip(text_sz);
+            continue;
+        }
+
+        char marker[PASTE_MARKER_LEN];
+        const uint16_t n = input.copy(marker, PASTE_MARKER_LEN);
+
+        if (memcmp(marker, ESC_PASTE_END, n) != 0)
+        {
+            // ESC within the pasted text
+            input.skip(1);
+            continue;
+        }
+
+        if (n < PASTE_MARKER_LEN)
+            return 0; // wait for the rest of the marker
+
+        input.skip(PASTE_MARKER_LEN);
+        pasteBuff[paste.size] = '\0';
+        paste.active = false;
+
+        output.key = Key::Paste;
+        output.mod_all = KEY_MOD_SPECIAL;
+        output.paste = {pasteBuff, paste.size};
+        #if TWINS_USE_KEY_NAMES
+        output.name = "Paste";
+        #endif
+        return PASTE_MARKER_LEN;
+    }
+
+    return 0;
+}
+
+template <class RB>
+static uint8_t decodeInputSeqImpl(RB &input, KeyCode &output)
 {
     output.key = Key::None;
     output.mod_all = 0;
+    output.repeat = 0;
+    output.paste = {};
     output.name = "<?>";
 
     if (input.size() == 0)
         return 0;
 
-    char seq[ESC_SEQ_MAX_LENGTH];
+    char seq_buff[ESC_SEQ_MAX_LENGTH];
 
     while (input.size())
     {
-        auto seq_sz = input.copy(seq, ESC_SEQ_MAX_LENGTH-1);
-        seq[seq_sz] = '\0';
+        if (paste.active)
+            return decodePaste(input, output);
+
+        // parse in place if the sequence does not wrap around the buffer end
+        Span<const char> span1, span2;
+        uint16_t seq_sz = input.readSpans(span1, span2);
+        if (seq_sz > ESC_SEQ_MAX_LENGTH-1)
+            seq_sz = ESC_SEQ_MAX_LENGTH-1;
+
+        const char *seq = span1.data;
+        if (span1.size < seq_sz)
+        {
+            input.copy(seq_buff, seq_sz);
+            seq = seq_buff;
+        }
         prevCR >>= 1; // set = 2 and then shift is faster than: if(prevCR) prevCR--;
 
         // 1. ANSI escape sequence
@@ -412,53 +638,115 @@ uint8_t decodeInputSeq(RingBuff<char> &input, KeyCode &output)
             // check mouse code
             if (seq_sz >= 6 && seq[1] == '[' && seq[2] == 'M')
             {
-                output.mouse.key = Key::MouseEvent;
-                const char mouse_btn = seq[3] - ' ';
+                const uint8_t mouse_btn = seq[3] - ' ';
+                decodeMouse(output, mouse_btn, false);
+                // TWINS_LOG_D("MouseBtn:0x%x", (unsigned)mouse_btn);
+                output.mouse.col = seq[4] - ' ';
+                output.mouse.row = seq[5] - ' ';
+                input.skip(6);
+                return 6;
+            }
+
+            // check bracketed paste markers
+            if (seq[1] == '[' && seq[2] == '2')
+            {
+                const unsigned n = seq_sz < PASTE_MARKER_LEN ? seq_sz : PASTE_MARKER_LEN;
+                const bool begin = memcmp(seq, ESC_PASTE_BEGIN, n) == 0;
 
-                switch (mouse_btn & 0xE3)
+                if (begin || memcmp(seq, ESC_PASTE_END, n) == 0)
                 {
-                case 0x00: output.mouse.btn = MouseBtn::ButtonLeft; break;
-                case 0x01: output.mouse.btn = MouseBtn::ButtonMid; break;
-                case 0x02: output.mouse.btn = MouseBtn::ButtonRight; break;
-                case 0x03: output.mouse.btn = MouseBtn::ButtonReleased; break;
-                case 0x80: output.mouse.btn = MouseBtn::ButtonGoBack; break;
-                case 0x81: output.mouse.btn = MouseBtn::ButtonGoForward; break;
-                case 0x40: output.mouse.btn = MouseBtn::WheelUp; break;
-                case 0x41: output.mouse.btn = MouseBtn::WheelDown; break;
-                default: break;
+                    if (n < PASTE_MARKER_LEN)
+                        return 0; // wait for the rest of the marker
+
+                    input.skip(PASTE_MARKER_LEN);
+
+                    if (begin && TWINS_PASTE_MAX_LENGTH > 0)
+                        paste = {true, 0};
+
+                    continue;
                 }
+            }
 
-                // TWINS_LOG_D("MouseBtn:0x%x", (unsigned)mouse_btn);
+            // check SGR (1006) mouse code: ESC [ < btn ; col ; row M|m
+            if (seq[1] == '[' && seq[2] == '<')
+            {
+                uint16_t params[3] = {};
+                unsigned param = 0;
+                unsigned pos = 3;
 
-                if (mouse_btn & 0x04) output.m_shift = 1;
-                if (mouse_btn & 0x08) output.m_alt = 1;
-                if (mouse_btn & 0x10) output.m_ctrl = 1;
+                for (; pos < seq_sz; pos++)
+                {
+                    const char c = seq[pos];
 
-                output.mouse.col = seq[4] - ' ';
-                output.mouse.row = seq[5] - ' ';
+                    if (c >= '0' && c <= '9')
+                    {
+                        const uint32_t val = params[param] * 10u + (c - '0');
+                        params[param] = val > UINT16_MAX ? UINT16_MAX : val;
+                    }
+                    else if (c == ';' && param < 2)
+                    {
+                        param++;
+                    }
+                    else
+                    {
+                        break;
+                    }
+                }
 
-                #if TWINS_USE_KEY_NAMES
-                output.name = "MouseClk";
-                #endif
+                if (pos < seq_sz && param == 2 && (seq[pos] == 'M' || seq[pos] == 'm'))
+                {
+                    decodeMouse(output, params[0], seq[pos] == 'm');
+                    output.mouse.col = params[1];
+                    output.mouse.row = params[2];
+                    input.skip(pos + 1);
+                    return pos + 1;
+                }
 
-                input.skip(6);
-                return 6;
+                // incomplete or invalid - handled as unknown sequence below
             }
 
-            // binary search: find key map in max 7 steps
-            if (auto *p_km = binary_search(seq+1, esc_keys_map_sorted.begin(), esc_keys_map_sorted.size()))
+            // feed the state machine with bytes not seen yet
+            uint16_t st = 0;
+            unsigned pos = 1;
+
+            if (escDfa.pos && escDfa.pInput == &input && escDfa.pos <= seq_sz)
             {
-                output.key = p_km->key;
-                output.mod_all = p_km->mod;
-                #if TWINS_USE_KEY_NAMES
-                output.name = p_km->name;
-                #endif
-                input.skip(1 + p_km->seqlen); // +1 for ESC
-                return 1 + p_km->seqlen;
+                st = escDfa.state;
+                pos = escDfa.pos;
+            }
+
+            escDfa = {};
+
+            for (; pos < seq_sz; pos++)
+            {
+                const uint8_t c = seq[pos];
+                const uint8_t cls = c < 128 ? esc_keys_dfa.byteClass[c] : 0;
+                st = cls ? esc_keys_dfa.next[st][cls - 1] : 0;
+
+                if (!st)
+                    break;
+
+                if (st & esc_keys_dfa.ACCEPT)
+                {
+                    const auto &km = esc_keys_map_unsorted[st & ~esc_keys_dfa.ACCEPT];
+                    output.key = km.key;
+                    output.mod_all = km.mod;
+                    #if TWINS_USE_KEY_NAMES
+                    output.name = km.name;
+                    #endif
+                    input.skip(1 + km.seqlen); // +1 for ESC
+                    return 1 + km.seqlen;
+                }
             }
 
-            // ESC sequence invalid or unknown?
-            if (seq_sz > 3) // 3 is mimimum ESC seq len
+            if (st)
+            {
+                // valid, but incomplete sequence - resume here next time
+                escDfa.pInput = &input;
+                escDfa.state = st;
+                escDfa.pos = pos;
+            }
+            else if (seq_sz > 3) // ESC sequence invalid or unknown; 3 is mimimum ESC seq len
             {
                 bool esc_found = false;
                 // data is long enough to store ESC sequence
@@ -480,6 +768,7 @@ uint8_t decodeInputSeq(RingBuff<char> &input, KeyCode &output)
             if (++decodeFailCtr == 3)
             {
                 decodeFailCtr = 0;
+                escDfa = {};
                 input.clear();
             }
 
@@ -488,75 +777,74 @@ uint8_t decodeInputSeq(RingBuff<char> &input, KeyCode &output)
         else
         {
             // single character
-            if (seq[0] == (char)Ansi::ESC && seq_sz == 1 && !prevEscIgnored)
+            if (seq[0] == (char)Ansi::ESC && seq_sz == 1 && escTimeoutMs)
             {
-                // avoid situations where ESC not followed by another code
+                // avoid situations where ESC followed by the rest of sequence, not received yet,
                 // is decoded as freestanding Esc key
-                prevEscIgnored = true;
-                return 0;
+                if (!prevEscIgnored)
+                {
+                    prevEscIgnored = true;
+                    prevEscTimestamp = getEscTimeStamp();
+                    return 0;
+                }
+
+                // without the PAL clock, decoded on the second attempt
+                const uint32_t now = getEscTimeStamp();
+                if (palClockRuns && now - prevEscTimestamp < escTimeoutMs)
+                    return 0;
             }
 
             prevEscIgnored = false;
-            bool skip = false;
+            const uint8_t key_idx = (uint8_t)seq[0] < 128 ? single_keys[(uint8_t)seq[0]] : 0;
 
             // 2. check for special key
-            // note: it conflicts with ctrl_keys_map[] but has higher priority
-            for (const auto &km : special_keys_map)
+            if (key_idx && key_idx < 0x80)
             {
-                if (seq[0] == km.c)
-                {
-                    if (seq[0] == (char)Ansi::CR)
-                    {
-                        // CR   -> treat as LF
-                        // CRLF -> ignore LF
-                        //   LF -> LF
-                        prevCR = 2;
-                    }
-                    else if (seq[0] == (char)Ansi::LF && prevCR)
-                    {
-                        input.skip(1);
-                        prevCR = 0;
-                        skip = true;
-                        break;
-                    }
+                const auto &km = special_keys_map[key_idx - 1];
 
-                    output.key = km.key;
-                    output.mod_all = km.mod;
-                    #if TWINS_USE_KEY_NAMES
-                    output.name = km.name;
-                    #endif
+                if (seq[0] == (char)Ansi::CR)
+                {
+                    // CR   -> treat as LF
+                    // CRLF -> ignore LF
+                    //   LF -> LF
+                    prevCR = 2;
+                }
+                else if (seq[0] == (char)Ansi::LF && prevCR)
+                {
                     input.skip(1);
-                    return 1;
+                    prevCR = 0;
+                    continue;
                 }
-            }
 
-            if (skip) continue;
+                output.key = km.key;
+                output.mod_all = km.mod;
+                #if TWINS_USE_KEY_NAMES
+                output.name = km.name;
+                #endif
+                input.skip(1);
+                return 1;
+            }
 
             // 3. check for one of Ctrl+[A..Z]
-            for (const auto &km : ctrl_keys_map)
+            if (key_idx)
             {
-                if (seq[0] == km.c)
-                {
-                    output.utf8[0] = (char)km.key;
-                    output.utf8[1] = '\0';
-                    output.mod_all = km.mod;
-                    #if TWINS_USE_KEY_NAMES
-                    output.name = km.name;
-                    #endif
-                    input.skip(1);
-                    return 1;
-                }
+                const auto &km = ctrl_keys_map[key_idx - 0x80];
+                output.utf8[0] = (char)km.key;
+                output.utf8[1] = '\0';
+                output.mod_all = km.mod;
+                #if TWINS_USE_KEY_NAMES
+                output.name = km.name;
+                #endif
+                input.skip(1);
+                return 1;
             }
 
             // 4. regular ASCII character or UTF-8 sequence
-            int sl = utf8seqlen(seq);
+            int sl = utf8seqlenBounded(seq, seq_sz);
             if (sl > 0)
             {
                 // copy UTF-8 seq
-                output.utf8[0] = seq[0];
-                output.utf8[1] = seq[1];
-                output.utf8[2] = seq[2];
-                output.utf8[3] = seq[3];
+                memcpy(output.utf8, seq, sl);
                 output.utf8[sl] = '\0';
                 #if TWINS_USE_KEY_NAMES
                 output.name = output.utf8;
@@ -579,6 +867,101 @@ uint8_t decodeInputSeq(RingBuff<char> &input, KeyCode &output)
     return 0;
 }
 
+void decodeInputSeqEscTimeout(uint16_t timeoutMs)
+{
+    escTimeoutMs = timeoutMs;
+}
+
+uint16_t decodeInputSeqEscPending()
+{
+    if (!prevEscIgnored)
+        return 0;
+
+    const uint32_t elapsed = getEscTimeStamp() - prevEscTimestamp;
+    if (!palClockRuns)
+        return escTimeoutMs;
+
+    return elapsed < escTimeoutMs ? uint16_t(escTimeoutMs - elapsed) : 1;
+}
+
+uint8_t decodeInputSeq(RingBuff<char> &input, KeyCode &output)
+{
+    return decodeInputSeqImpl(input, output);
+}
+
+uint8_t decodeInputSeq(SpscRingBuff<char> &input, KeyCode &output)
+{
+    return decodeInputSeqImpl(input, output);
+}
+
+/**
+ * @brief Check if \p next can be merged into \p prev: both are motion or wheel events of the same kind,
+ *        wheel at the same position, or - if \p mergeKeys - the same navigation keys (arrows Up/Down, PgUp/PgDown)
+ */
+static bool canCoalesce(const KeyCode &prev, const KeyCode &next, bool mergeKeys)
+{
+    if (prev.key != next.key || prev.mod_all != next.mod_all || prev.repeat == UINT8_MAX)
+        return false;
+
+    if (next.key == Key::MouseEvent)
+    {
+        if (prev.mouse.btn != next.mouse.btn)
+            return false;
+
+        if (next.mouse.btn == MouseBtn::Motion)
+            return true;
+
+        return (next.mouse.btn == MouseBtn::WheelUp || next.mouse.btn == MouseBtn::WheelDown) &&
+            prev.mouse.col == next.mouse.col && prev.mouse.row == next.mouse.row;
+    }
+
+    // key and utf8 share the memory
+    return mergeKeys && next.m_spec &&
+        (next.key == Key::Up || next.key == Key::Down || next.key == Key::PgUp || next.key == Key::PgDown);
+}
+
+template <class RB>
+static uint16_t decodeInputSeqBatchImpl(RB &input, KeyCode *pOutput, uint16_t count, bool mergeKeys)
+{
+    uint16_t n = 0;
+
+    while (n < count && decodeInputSeqImpl(input, pOutput[n]))
+    {
+        if (pOutput[n].key == Key::Paste)
+        {
+            n++;
+            break;
+        }
+
+        if (n && canCoalesce(pOutput[n-1], pOutput[n], mergeKeys))
+        {
+            if (pOutput[n].key == Key::MouseEvent)
+            {
+                // motion: the last position counts
+                pOutput[n-1].mouse.col = pOutput[n].mouse.col;
+                pOutput[n-1].mouse.row = pOutput[n].mouse.row;
+            }
+            pOutput[n-1].repeat = pOutput[n-1].repeatCount() + 1;
+        }
+        else
+        {
+            n++;
+        }
+    }
+
+    return n;
+}
+
+uint16_t decodeInputSeqBatch(RingBuff<char> &input, KeyCode *pOutput, uint16_t count, bool mergeKeys)
+{
+    return decodeInputSeqBatchImpl(input, pOutput, count, mergeKeys);
+}
+
+uint16_t decodeInputSeqBatch(SpscRingBuff<char> &input, KeyCode *pOutput, uint16_t count, bool mergeKeys)
+{
+    return decodeInputSeqBatchImpl(input, pOutput, count, mergeKeys);
+}
+
 // -----------------------------------------------------------------------------
 
 }
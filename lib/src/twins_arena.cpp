@@ -0,0 +1,45 @@
+/******************************************************************************
+ * @brief   TWins - arena (bump) allocator
+ * @author  Mariusz Midor
+ *          https://bitbucket.org/marmidr/twins
+ *          https://github.com/marmidr/twins
+ *****************************************************************************/
+
+#include "twins_arena.hpp"
+
+// -----------------------------------------------------------------------------
+
+namespace twins
+{
+
+#if TWINS_FRAME_ARENA_SIZE > 0
+alignas(void*) static uint8_t frameArenaBuff[TWINS_FRAME_ARENA_SIZE];
+#else
+alignas(void*) static uint8_t frameArenaBuff[1];
+#endif
+
+static Arena frameArenaObj(frameArenaBuff, TWINS_FRAME_ARENA_SIZE);
+
+Arena& frameArena()
+{
+    return frameArenaObj;
+}
+
+void* frameAlloc(uint32_t sz, bool fromArena)
+{
+    if (fromArena)
+        if (void *p = frameArenaObj.alloc(sz))
+            return p;
+
+    return pPAL->memAlloc(sz);
+}
+
+void frameFree(void *ptr)
+{
+    if (ptr && !frameArenaObj.owns(ptr))
+        pPAL->memFree(ptr);
+}
+
+// -----------------------------------------------------------------------------
+
+} // namespace
@@ -9,6 +9,7 @@
 #include "twins_cli.hpp"
 #include "twins_ringbuffer.hpp"
 #include "twins_queue.hpp"
+#include "twins_utf8str.hpp"
 
 #include <string.h>
 
@@ -48,6 +49,7 @@ CliState& g_cs = (CliState&)cs_buff;
 // global variables
 bool verbose = true;
 bool echoNlAfterCr = false;
+PasteNewline pasteNewline = PasteNewline::Execute;
 
 // -----------------------------------------------------------------------------
 
@@ -111,14 +113,156 @@ void processInput(const char* data, uint8_t dataLen)
     }
 }
 
-void processInput(twins::RingBuff<char> &rb)
+/** @brief Sequence to be echoed; RingBuff content stays valid until next write - use it in place */
+static const char* peekSeq(twins::RingBuff<char> &rb, char *buff)
+{
+    Span<const char> span1, span2;
+    uint16_t sz = rb.readSpans(span1, span2);
+    if (sz > ESC_SEQ_MAX_LENGTH)
+        sz = ESC_SEQ_MAX_LENGTH;
+
+    if (span1.size >= sz)
+        return span1.data;
+
+    // copy bytes from ringbufer to linear local array capable of storing the longest ANSI sequence
+    rb.copy(buff, sz);
+    return buff;
+}
+
+/** @brief Sequence to be echoed; SpscRingBuff slots may be overwritten once decoded - take a copy */
+static const char* peekSeq(twins::SpscRingBuff<char> &rb, char *buff)
+{
+    rb.copy(buff, ESC_SEQ_MAX_LENGTH);
+    return buff;
+}
+
+/** @brief Queue the current line for execution and store it in the history */
+static void enterLine()
+{
+    if (g_cs.lineBuff.size())
+    {
+        // ensure cursor moves to new line when Enter was hit, but single \r was received
+        if (echoNlAfterCr) twins::writeChar('\n');
+
+        // append to history, limit history size;
+        // prevents password to be stored in history
+        if (!g_cs.passwordMode)
+        {
+            int idx = 0;
+            if (auto *str = g_cs.history.find(g_cs.lineBuff, &idx))
+            {
+                // move to top
+                String tmp = std::move(*str);
+                g_cs.history.remove(idx, true);
+                g_cs.history.append(std::move(tmp));
+            }
+            else
+            {
+                g_cs.history.append(g_cs.lineBuff);
+                if (g_cs.history.size() > TWINS_CLI_MAXHIST)
+                    g_cs.history.remove(0, true);
+            }
+        }
+        g_cs.historyIdx = g_cs.history.size();
+        g_cs.cmdQue.write(std::move(g_cs.lineBuff));
+        g_cs.lineBuff.clear();
+    }
+    else
+    {
+        prompt(true);
+    }
+
+    g_cs.cursorPos = 0;
+}
+
+/** @brief Insert pasted \p text at the cursor with single echo per line; line breaks according to pasteNewline */
+static void pasteText(CStrView text)
+{
+    const char *p = text.data;
+    const char *p_end = text.data + text.size;
+    String chunk;
+
+    while (p < p_end)
+    {
+        // printable part of the line, within the line length limit
+        bool overflow = false;
+        unsigned n_chars = 0;
+        chunk.clear();
+
+        while (p < p_end && *p != '\r' && *p != '\n')
+        {
+            const int sl = utf8seqlen(p);
+            if (sl <= 0 || p + sl > p_end)
+                break;
+
+            if (g_cs.lineBuff.size() + chunk.size() + sl > TWINS_CLI_MAXCMDLEN)
+                overflow = true;
+
+            // tab becomes space; other control codes and the part not fitting the line are dropped
+            if (!overflow && *p == '\t')
+            {
+                chunk.append(' ');
+                n_chars++;
+            }
+            else if (!overflow && (uint8_t)*p >= ' ' && *p != 0x7F)
+            {
+                chunk.appendLen(p, sl);
+                n_chars++;
+            }
+
+            p += sl;
+        }
+
+        if (p < p_end && *p != '\r' && *p != '\n')
+            p++; // invalid UTF-8 byte
+
+        if (n_chars)
+        {
+            g_cs.lineBuff.insert(g_cs.cursorPos, chunk.cstr());
+            g_cs.cursorPos += n_chars;
+
+            writeStrFmt(ESC_CHAR_INSERT_FMT, n_chars);
+            if (g_cs.passwordMode)
+                writeChar('*', n_chars);
+            else
+                writeStrLen(chunk.cstr(), chunk.size());
+        }
+
+        if (overflow)
+            writeStr(ESC_BELL);
+
+        if (p < p_end && (*p == '\r' || *p == '\n'))
+        {
+            // CRLF is a single line break
+            if (*p == '\r' && p + 1 < p_end && p[1] == '\n')
+                p++;
+            p++;
+
+            if (pasteNewline == PasteNewline::Ignore)
+                break;
+
+            if (pasteNewline == PasteNewline::Execute)
+            {
+                enterLine();
+            }
+            else if (g_cs.lineBuff.size() < TWINS_CLI_MAXCMDLEN)
+            {
+                g_cs.lineBuff.insert(g_cs.cursorPos, " ");
+                g_cs.cursorPos++;
+                writeStr(ESC_CHAR_INSERT(1) " ");
+            }
+        }
+    }
+}
+
+template <class RB>
+static void processInputImpl(RB &rb)
 {
-    char seq[ESC_SEQ_MAX_LENGTH];
+    char seq_buff[ESC_SEQ_MAX_LENGTH];
 
     while (true)
     {
-        // copy bytes from ringbufer to linear local array capable of storing the longest ANSI sequence
-        rb.copy(seq, sizeof(seq));
+        const char *p_seq = peekSeq(rb, seq_buff); // echo decoded sequence
 
         KeyCode kc = {};
         uint8_t seq_sz = decodeInputSeq(rb, kc);
@@ -129,9 +273,6 @@ void processInput(twins::RingBuff<char> &rb)
         if (seq_sz >= ESC_SEQ_MAX_LENGTH)
             seq_sz = ESC_SEQ_MAX_LENGTH-1;
 
-        seq[seq_sz] = '\0';
-        const char *p_seq = seq; // echo decoded sequence
-
         if (kc.m_spec || kc.m_ctrl)
         {
             // fprintf(stderr, ESC_FG_RED "^" ESC_FG_DEFAULT); fflush(stderr);
@@ -143,7 +284,7 @@ void processInput(twins::RingBuff<char> &rb)
                 // history inactive in password mode
                 if (g_cs.history.size() && !g_cs.passwordMode)
                 {
-                    g_cs.historyIdx += kc.key == Key::Up ? -1 : 1;
+                    g_cs.historyIdx += (kc.key == Key::Up ? -1 : 1) * kc.repeatCount();
 
                     if (g_cs.historyIdx < 0)
                         g_cs.historyIdx = 0;
@@ -223,40 +364,12 @@ void processInput(twins::RingBuff<char> &rb)
                 p_seq = nullptr; // suppress echo
                 break;
             case Key::Enter:
-                if (g_cs.lineBuff.size())
-                {
-                    // ensure cursor moves to new line when Enter was hit, but single \r was received
-                    if (echoNlAfterCr) twins::writeChar('\n');
-
-                    // append to history, limit history size;
-                    // prevents password to be stored in history
-                    if (!g_cs.passwordMode)
-                    {
-                        int idx = 0;
-                        if (auto *str = g_cs.history.find(g_cs.lineBuff, &idx))
-                        {
-                            // move to top
-                            String tmp = std::move(*str);
-                            g_cs.history.remove(idx, true);
-                            g_cs.history.append(std::move(tmp));
-                        }
-                        else
-                        {
-                            g_cs.history.append(g_cs.lineBuff);
-                            if (g_cs.history.size() > TWINS_CLI_MAXHIST)
-                                g_cs.history.remove(0, true);
-                        }
-                    }
-                    g_cs.historyIdx = g_cs.history.size();
-                    g_cs.cmdQue.write(std::move(g_cs.lineBuff));
-                    g_cs.lineBuff.clear();
-                }
-                else
-                {
-                    prompt(true);
-                }
+                enterLine();
+                p_seq = nullptr; // suppress echo
+                break;
+            case Key::Paste:
+                pasteText(kc.paste);
                 p_seq = nullptr; // suppress echo
-                g_cs.cursorPos = 0;
                 break;
             default:
                 break;
@@ -294,6 +407,16 @@ void processInput(twins::RingBuff<char> &rb)
     flushBuffer();
 }
 
+void processInput(twins::RingBuff<char> &rb)
+{
+    processInputImpl(rb);
+}
+
+void processInput(twins::SpscRingBuff<char> &rb)
+{
+    processInputImpl(rb);
+}
+
 History& getHistory(void)
 {
     return g_cs.history;
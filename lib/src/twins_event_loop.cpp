@@ -0,0 +1,322 @@
+/******************************************************************************
+ * @brief   TWins - event loop - POSIX
+ * @author  Mariusz Midor
+ *          https://bitbucket.org/marmidr/twins
+ *          https://github.com/marmidr/twins
+ *****************************************************************************/
+
+#include "twins_event_loop.hpp"
+
+#include <errno.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <time.h>
+#include <sys/uio.h>
+#if defined __linux__
+# include <sys/eventfd.h>
+#endif
+
+// -----------------------------------------------------------------------------
+
+namespace twins
+{
+
+/** @brief Monotonic time; wraps after ~49 days, so compare only the differences */
+static uint32_t nowMs()
+{
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)ts.tv_sec * 1000u + (uint32_t)(ts.tv_nsec / 1000000);
+}
+
+static inline int32_t msUntil(uint32_t deadline, uint32_t now)
+{
+    return (int32_t)(deadline - now);
+}
+
+// -----------------------------------------------------------------------------
+
+EventLoop::EventLoop()
+{
+#if defined __linux__
+    mWakeFd[0] = mWakeFd[1] = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+#else
+    if (pipe(mWakeFd) == 0)
+    {
+        for (int fd : mWakeFd)
+        {
+            fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+            fcntl(fd, F_SETFD, FD_CLOEXEC);
+        }
+    }
+#endif
+}
+
+EventLoop::~EventLoop()
+{
+    if (mWakeFd[0] >= 0)
+        close(mWakeFd[0]);
+    if (mWakeFd[1] >= 0 && mWakeFd[1] != mWakeFd[0])
+        close(mWakeFd[1]);
+}
+
+bool EventLoop::addFd(int fd, FdHandler handler)
+{
+    if (fd < 0 || findSource(fd))
+        return false;
+
+    mSources.append(Source{fd, std::move(handler), nullptr, nullptr});
+    return true;
+}
+
+bool EventLoop::addInput(int fd, RingBuff<char> &rb, InputHandler handler)
+{
+    if (fd < 0 || findSource(fd))
+        return false;
+
+    mSources.append(Source{fd, nullptr, &rb, std::move(handler)});
+    return true;
+}
+
+void EventLoop::removeFd(int fd)
+{
+    // removed later by compact(), as we may be in the middle of dispatching
+    if (auto *p_src = findSource(fd))
+        p_src->fd = -1;
+}
+
+int EventLoop::addTimer(uint32_t periodMs, TimerHandler handler, bool periodic)
+{
+    if (++mLastTimerId <= 0)
+        mLastTimerId = 1;
+
+    mTimers.append(Timer{mLastTimerId, periodMs, nowMs() + periodMs, periodic, std::move(handler)});
+    return mLastTimerId;
+}
+
+void EventLoop::removeTimer(int timerId)
+{
+    for (auto &tmr : mTimers)
+    {
+        if (tmr.id == timerId)
+        {
+            tmr.id = 0;
+            break;
+        }
+    }
+}
+
+bool EventLoop::isTimerActive(int timerId) const
+{
+    if (timerId <= 0)
+        return false;
+
+    for (const auto &tmr : mTimers)
+        if (tmr.id == timerId)
+            return true;
+
+    return false;
+}
+
+void EventLoop::setWakeupHandler(TimerHandler handler)
+{
+    mWakeupHandler = std::move(handler);
+}
+
+void EventLoop::wakeup()
+{
+#if defined __linux__
+    uint64_t one = 1;
+    ssize_t rc = write(mWakeFd[1], &one, sizeof(one));
+#else
+    char one = 1;
+    ssize_t rc = write(mWakeFd[1], &one, sizeof(one));
+#endif
+    // EAGAIN: counter/pipe full, so the loop is going to wake up anyway
+    (void)rc;
+}
+
+void EventLoop::quit()
+{
+    mQuit = true;
+    wakeup();
+}
+
+bool EventLoop::runOnce(int timeoutMs)
+{
+    compact();
+
+    if (mQuit)
+        return false;
+
+    // sleep until the nearest timer deadline
+    const uint32_t now = nowMs();
+
+    for (const auto &tmr : mTimers)
+    {
+        int32_t dt = msUntil(tmr.deadline, now);
+        if (dt < 0) dt = 0;
+        if (timeoutMs < 0 || dt < timeoutMs)
+            timeoutMs = dt;
+    }
+
+    // watched descriptors: [0] is the wakeup fd
+    mPollFds.resize(mSources.size() + 1);
+    mPollFds[0] = pollfd{mWakeFd[0], POLLIN, 0};
+    for (int i = 0; i < mSources.size(); i++)
+    {
+        // negative fd is ignored by poll(): input with full buffer waits until the data are consumed
+        const auto &src = mSources[i];
+        const bool paused = src.pRb && src.pRb->isFull();
+        mPollFds[i + 1] = pollfd{paused ? -1 : src.fd, POLLIN, 0};
+    }
+
+    int rc = poll(mPollFds.data(), mPollFds.size(), timeoutMs);
+
+    if (rc > 0)
+    {
+        if (mPollFds[0].revents)
+        {
+            uint64_t cnt;
+            while (read(mWakeFd[0], &cnt, sizeof(cnt)) > 0) {}
+
+            if (mWakeupHandler && !mQuit)
+            {
+                auto handler = mWakeupHandler;
+                handler();
+            }
+        }
+
+        // sources added by handlers are not in mPollFds yet
+        const int polled = mPollFds.size() - 1;
+
+        for (int i = 0; i < polled && !mQuit; i++)
+        {
+            if (!mPollFds[i + 1].revents || mSources[i].fd != mPollFds[i + 1].fd)
+                continue;
+
+            if (mSources[i].pRb)
+            {
+                readInput(mSources[i]);
+            }
+            else
+            {
+                // handler may add new sources, what would move the one being called
+                auto handler = mSources[i].fdHandler;
+                handler(mSources[i].fd);
+            }
+        }
+    }
+
+    if (!mQuit)
+        dispatchTimers();
+
+    return !mQuit;
+}
+
+void EventLoop::run()
+{
+    while (runOnce())
+        ;
+
+    // allow to run the loop again
+    mQuit = false;
+}
+
+EventLoop::Source* EventLoop::findSource(int fd)
+{
+    if (fd < 0)
+        return nullptr;
+
+    for (auto &src : mSources)
+        if (src.fd == fd)
+            return &src;
+
+    return nullptr;
+}
+
+void EventLoop::readInput(Source &src)
+{
+    const int fd = src.fd;
+    RingBuff<char> &rb = *src.pRb;
+    auto handler = src.inputHandler;
+    bool eof = false;
+    bool got_data = false;
+
+    // whole burst in one syscall, directly into the ring buffer
+    Span<char> first, second;
+
+    if (rb.writeSpans(first, second))
+    {
+        iovec iov[2] = {
+            { first.data, first.size },
+            { second.data, second.size },
+        };
+
+        ssize_t nb = readv(fd, iov, second.size ? 2 : 1);
+
+        if (nb > 0)
+        {
+            rb.commitWrite((uint16_t)nb);
+            got_data = true;
+        }
+        else if (nb == 0)
+            eof = true;
+        else if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)
+            eof = true;
+    }
+
+    if (eof)
+        removeFd(fd);
+
+    if (handler && (got_data || eof))
+        handler(rb, eof);
+}
+
+void EventLoop::dispatchTimers()
+{
+    const uint32_t now = nowMs();
+
+    // timers added by handlers are checked in the next iteration
+    const int count = mTimers.size();
+
+    for (int i = 0; i < count && !mQuit; i++)
+    {
+        auto &tmr = mTimers[i];
+
+        if (tmr.id == 0 || msUntil(tmr.deadline, now) > 0)
+            continue;
+
+        if (tmr.periodic && tmr.periodMs)
+        {
+            tmr.deadline += tmr.periodMs;
+            // skip missed periods instead of firing them in a burst
+            if (msUntil(tmr.deadline, now) <= 0)
+                tmr.deadline = now + tmr.periodMs;
+        }
+        else
+        {
+            tmr.id = 0;
+        }
+
+        auto handler = tmr.handler;
+        if (handler)
+            handler();
+    }
+}
+
+void EventLoop::compact()
+{
+    for (int i = mSources.size() - 1; i >= 0; i--)
+        if (mSources[i].fd < 0)
+            mSources.remove(i, true);
+
+    for (int i = mTimers.size() - 1; i >= 0; i--)
+        if (mTimers[i].id == 0)
+            mTimers.remove(i, true);
+}
+
+// -----------------------------------------------------------------------------
+
+} // namespace
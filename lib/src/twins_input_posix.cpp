@@ -22,17 +22,17 @@
 namespace twins
 {
 
-static int         ttyFileNo;
+static int         ttyFileNo = -1;
 static char        termEOFcode;
 static termios     termIOs;
 static uint16_t    termKeyTimeoutMs;
-static char        termBuff[8];
+static char        termBuff[64];
 
 // -----------------------------------------------------------------------------
 
 static void readKey()
 {
-    // read up to 8 bytes
+    // read up to 63 bytes; pasted text comes in large chunks
     int nb = read(ttyFileNo, termBuff, sizeof(termBuff)-1);
     if (nb == -1) nb = 0;
     termBuff[nb] = '\0';
@@ -101,6 +101,7 @@ void inputPosixFree()
         tcsetattr(ttyFileNo, TCSAFLUSH, &termIOs);
         checkErrNo(__LINE__);
         close(ttyFileNo);
+        ttyFileNo = -1;
     }
 }
 
@@ -119,6 +120,11 @@ const char* inputPosixRead(bool &quitRequested)
     return termBuff;
 }
 
+int inputPosixFd()
+{
+    return ttyFileNo;
+}
+
 // -----------------------------------------------------------------------------
 
 }
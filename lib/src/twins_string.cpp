@@ -7,7 +7,9 @@
 
 #include "twins_common.hpp"
 #include "twins_string.hpp"
+#include "twins_arena.hpp"
 #include "twins_utf8str.hpp"
+#include "twins_string_width_tbl.hpp"
 
 #include <stdint.h>
 #include <stdarg.h>
@@ -16,6 +18,10 @@
 #include <assert.h>
 #include <utility> //std::swap
 
+#if defined(__SSE2__)
+# include <emmintrin.h>
+#endif
+
 // -----------------------------------------------------------------------------
 
 namespace twins
@@ -34,45 +40,59 @@ String::String(String &&other) noexcept
 
 String::~String()
 {
-    if (mpBuff)
-        pPAL->memFree(mpBuff);
+    if (!isInline())
+        frameFree(mpBuff);
 }
 
-String& String::append(const char *s, int16_t repeat)
+String& String::append(const char *s, IndexType repeat)
 {
     if (repeat <= 0 || !s || sourceIsOurs(s))
         return *this;
 
-    unsigned sl = strlen(s);
-    reserve(mSize + repeat * sl);
+    const SizeType sl = strlen(s);
+    const SizeType total = repeat * sl;
+    growAsNecessary(mSize + total);
     char *p = mpBuff + mSize;
-    mSize += repeat * sl;
-    while (repeat--)
-        p = strcat(p, s);
+
+    if (sl)
+    {
+        // copy once, then keep doubling already copied part
+        memcpy(p, s, sl);
+
+        for (SizeType copied = sl; copied < total; )
+        {
+            SizeType n = MIN(copied, total - copied);
+            memcpy(p + copied, p, n);
+            copied += n;
+        }
+    }
+
+    mSize += total;
+    invalidateCache();
     mpBuff[mSize] = '\0';
     return *this;
 }
 
-String& String::appendLen(const char *s, int16_t sLen)
+String& String::appendLen(const char *s, IndexType sLen)
 {
     if (sLen <= 0 || !s || sourceIsOurs(s))
         return *this;
 
-    reserve(mSize + sLen);
+    growAsNecessary(mSize + sLen);
     strncat(mpBuff + mSize, s, sLen);
     mSize += sLen;
+    invalidateCache();
     mpBuff[mSize] = '\0';
     return *this;
 }
 
-String& String::append(char c, int16_t repeat)
+String& String::append(char c, IndexType repeat)
 {
     if (repeat <= 0) return *this;
-    reserve(mSize + repeat);
-    char *p = mpBuff + mSize;
+    growAsNecessary(mSize + repeat);
+    memset(mpBuff + mSize, c, repeat);
     mSize += repeat;
-    while (repeat--)
-        *p++ = c;
+    invalidateCache();
     mpBuff[mSize] = '\0';
     return *this;
 }
@@ -106,11 +126,12 @@ void String::appendVFmt(const char *fmt, va_list ap)
             if (n < freespace)
             {
                 mSize += n;
+                invalidateCache();
                 break;
             }
 
             // printf("too small buffer\n");
-            reserve(mCapacity + n + 10);
+            growAsNecessary(mSize + n);
         }
         else
         {
@@ -121,9 +142,9 @@ void String::appendVFmt(const char *fmt, va_list ap)
     } while (retry--);
 }
 
-String& String::trim(int16_t trimPos, bool addEllipsis, bool ignoreESC)
+String& String::trim(IndexType trimPos, bool addEllipsis, bool ignoreESC)
 {
-    if (trimPos < 0 || trimPos >= mSize)
+    if (trimPos < 0 || (SizeType)trimPos >= mSize)
         return *this;
 
     if (addEllipsis && trimPos > 0)
@@ -149,6 +170,7 @@ String& String::trim(int16_t trimPos, bool addEllipsis, bool ignoreESC)
         return *this;
 
     mSize = p - mpBuff;
+    invalidateCache();
     char last = mpBuff[mSize];
 
     if (addEllipsis && last == ' ')
@@ -159,9 +181,9 @@ String& String::trim(int16_t trimPos, bool addEllipsis, bool ignoreESC)
     return *this;
 }
 
-String& String::erase(int16_t pos, int16_t len)
+String& String::erase(IndexType pos, IndexType len)
 {
-    if (pos < 0 || pos >= mSize || len <= 0)
+    if (pos < 0 || (SizeType)pos >= mSize || len <= 0)
         return *this;
 
     char *p = mpBuff;
@@ -191,11 +213,12 @@ String& String::erase(int16_t pos, int16_t len)
 
     memmove(erase_at, erase_at + bytes_to_erase, mSize - (erase_at - mpBuff));
     mSize -= bytes_to_erase;
+    invalidateCache();
     mpBuff[mSize] = '\0';
     return *this;
 }
 
-String& String::insert(int16_t pos, const char *s, int16_t repeat)
+String& String::insert(IndexType pos, const char *s, IndexType repeat)
 {
     if (pos < 0 || (!s || !*s) || repeat < 1 || sourceIsOurs(s))
         return *this;
@@ -219,10 +242,10 @@ String& String::insert(int16_t pos, const char *s, int16_t repeat)
         return *this;
 
     char *insert_at = p;
-    unsigned src_len = strlen(s);
-    unsigned bytes_to_insert = src_len * repeat;
+    SizeType src_len = strlen(s);
+    SizeType bytes_to_insert = src_len * repeat;
 
-    reserve(mSize + bytes_to_insert);
+    growAsNecessary(mSize + bytes_to_insert);
     memmove(insert_at + bytes_to_insert, insert_at, mSize - (insert_at - mpBuff));
     while (repeat--)
     {
@@ -230,11 +253,12 @@ String& String::insert(int16_t pos, const char *s, int16_t repeat)
         insert_at += src_len;
     }
     mSize += bytes_to_insert;
+    invalidateCache();
     mpBuff[mSize] = '\0';
     return *this;
 }
 
-void String::setWidth(int16_t newWidth, bool addEllipsis)
+void String::setWidth(IndexType newWidth, bool addEllipsis)
 {
     if (newWidth < 0)
         return;
@@ -242,17 +266,23 @@ void String::setWidth(int16_t newWidth, bool addEllipsis)
     int w = width();
 
     if (w <= newWidth)
+    {
         append(' ', newWidth - w);
+        // padded with spaces - width is known
+        mCachedWidth = newWidth;
+        mCachedWidthValid = true;
+    }
     else
         trim(newWidth, addEllipsis, true);
 }
 
-String& String::clear(uint16_t threshordToFree)
+String& String::clear(SizeType threshordToFree)
 {
     if (mCapacity > alignCapacity(threshordToFree))
         freeBuff();
 
     mSize = 0;
+    invalidateCache();
     if (mpBuff)
         *mpBuff = '\0';
 
@@ -281,9 +311,30 @@ String& String::operator=(String &&other)
 {
     if (this != &other)
     {
-        std::swap(mpBuff,    other.mpBuff);
-        std::swap(mCapacity, other.mCapacity);
-        std::swap(mSize,     other.mSize);
+        if (other.isInline() || frameArena().owns(other.mpBuff))
+        {
+            // short or temporary string - just copy it
+            clear();
+            appendLen(other.mpBuff, other.mSize);
+        }
+        else
+        {
+            // take over the other buffer
+            freeBuff();
+            mpBuff = other.mpBuff;
+            mCapacity = other.mCapacity;
+            mSize = other.mSize;
+            mCachedLen = other.mCachedLen;
+            mCachedWidth = other.mCachedWidth;
+            mCachedLenValid = other.mCachedLenValid;
+            mCachedWidthValid = other.mCachedWidthValid;
+            other.mpBuff = other.mInlineBuff;
+            other.mCapacity = INLINE_CAPACITY;
+        }
+
+        other.mSize = 0;
+        other.invalidateCache();
+        *other.mpBuff = '\0';
     }
     return *this;
 }
@@ -329,12 +380,32 @@ int String::find(const char *str) const
     return p - cstr();
 }
 
-uint16_t String::u8len(bool ignoreESC, bool realWidth) const
+String::SizeType String::u8len(bool ignoreESC, bool realWidth) const
 {
+    if (!ignoreESC && !realWidth)
+    {
+        if (!mCachedLenValid)
+        {
+            mCachedLen = u8len(mpBuff, mpBuff + mSize, false, false);
+            mCachedLenValid = true;
+        }
+        return mCachedLen;
+    }
+
+    if (ignoreESC && realWidth)
+    {
+        if (!mCachedWidthValid)
+        {
+            mCachedWidth = u8len(mpBuff, mpBuff + mSize, true, true);
+            mCachedWidthValid = true;
+        }
+        return mCachedWidth;
+    }
+
     return u8len(mpBuff, mpBuff + mSize, ignoreESC, realWidth);
 }
 
-uint16_t String::alignCapacity(uint16_t newCapacity) const
+String::SizeType String::alignCapacity(SizeType newCapacity) const
 {
     // extra byte for NUL
     newCapacity++;
@@ -348,40 +419,47 @@ uint16_t String::alignCapacity(uint16_t newCapacity) const
     return newCapacity;
 }
 
-void String::reserve(uint16_t newCapacity)
+void String::reserve(SizeType newCapacity)
 {
-    newCapacity = alignCapacity(newCapacity);
-
+    // extra byte for NUL
     if (newCapacity < mCapacity)
         return;
 
-    if (!mpBuff)
-    {
-        // first-time buffer allocation
-        mpBuff = (char*)pPAL->memAlloc(newCapacity);
-        mCapacity = newCapacity;
-        *mpBuff = '\0';
-        mSize = 0;
+    newCapacity = alignCapacity(newCapacity);
+
+    // reallocation needed
+    char *pnew = (char*)frameAlloc(newCapacity, mFrameTemp);
+    memcpy(pnew, mpBuff, mSize+1);
+    if (!isInline())
+        frameFree(mpBuff);
+    mpBuff = pnew;
+    mCapacity = newCapacity;
+}
+
+void String::growAsNecessary(SizeType newSize)
+{
+    if (newSize < mCapacity)
         return;
-    }
 
-    if (newCapacity > mCapacity)
-    {
-        // reallocation needed
-        char *pnew = (char*)pPAL->memAlloc(newCapacity);
-        mCapacity = newCapacity;
-        memcpy(pnew, mpBuff, mSize+1);
-        pPAL->memFree(mpBuff);
-        mpBuff = pnew;
-    }
+#if TWINS_LARGE_STRING
+    // amortized growth, to make appending in a loop linear
+    SizeType geometric = mCapacity + mCapacity / 2;
+    if (newSize < geometric)
+        newSize = geometric;
+#endif
+
+    reserve(newSize);
 }
 
 void String::freeBuff()
 {
-    if (mpBuff) pPAL->memFree(mpBuff);
-    mpBuff = nullptr;
-    mCapacity = 0;
+    if (!isInline())
+        frameFree(mpBuff);
+    mpBuff = mInlineBuff;
+    mCapacity = INLINE_CAPACITY;
     mSize = 0;
+    invalidateCache();
+    *mpBuff = '\0';
 }
 
 uint16_t String::escLen(const char *str, const char *strEnd)
@@ -433,29 +511,116 @@ uint16_t String::escLen(const char *str, const char *strEnd)
     return 0;
 }
 
-struct UnicodeBlockRange
+uint8_t String::charWidth(uint32_t cp)
+{
+    if (cp < WIDTH_TBL_END)
+    {
+        uint8_t blk = widthTblIndex[cp >> WIDTH_TBL_BLOCK_SHIFT];
+        uint8_t cp_in_blk = cp & ((1u << WIDTH_TBL_BLOCK_SHIFT) - 1);
+        return (widthTblBlocks[blk][cp_in_blk >> 2] >> ((cp_in_blk & 3) * 2)) & 0x03;
+    }
+
+    // CJK Unified Ideographs Extension B..G, Compatibility Ideographs Supplement
+    if (cp <= 0x3FFFD)
+        return 2;
+    // tags, variation selectors supplement
+    if (cp >= 0xE0000 && cp <= 0xE0FFF)
+        return 0;
+    return 1;
+}
+
+// -----------------------------------------------------------------------------
+
+// 8-byte blocks processed as a whole (SWAR)
+static constexpr uint64_t SWAR_ONES  = 0x0101010101010101ull;
+static constexpr uint64_t SWAR_HIGHS = 0x8080808080808080ull;
+static constexpr uint64_t SWAR_ESCS  = SWAR_ONES * 0x1B;
+
+static inline uint64_t swarLoad(const char *str)
+{
+    uint64_t v;
+    memcpy(&v, str, sizeof(v));
+    return v;
+}
+
+/** @brief Non-zero if any byte of the block is 0x00 */
+static inline uint64_t swarZeroBytes(uint64_t v)
+{
+    return (v - SWAR_ONES) & ~v & SWAR_HIGHS;
+}
+
+/** @brief Non-zero if block contains NUL or ESC */
+static inline uint64_t swarNulOrEsc(uint64_t v)
 {
-    long first, last;
-};
+    return swarZeroBytes(v) | swarZeroBytes(v ^ SWAR_ESCS);
+}
+
+static inline bool isPlainAscii(char c)
+{
+    const uint8_t b = c; // char may be unsigned
+    return b && b < 0x80 && b != '\e';
+}
+
+/** @brief Length of leading span of plain ASCII characters (no ESC, no NUL, no UTF-8 sequences) */
+static unsigned plainAsciiSpan(const char *str, const char *strEnd)
+{
+    const char *p = str;
+
+#if defined(__SSE2__)
+    const __m128i v_esc = _mm_set1_epi8('\e');
+    const __m128i v_nul = _mm_setzero_si128();
+
+    while (strEnd - p >= 16)
+    {
+        __m128i v = _mm_loadu_si128((const __m128i*)p);
+        __m128i special = _mm_or_si128(_mm_cmpeq_epi8(v, v_esc), _mm_cmpeq_epi8(v, v_nul));
+        // high bit set for non-ASCII bytes as well
+        if (int mask = _mm_movemask_epi8(_mm_or_si128(v, special)))
+            return (p - str) + __builtin_ctz(mask);
+        p += 16;
+    }
+#endif
+
+    while (strEnd - p >= 8)
+    {
+        uint64_t v = swarLoad(p);
+        if ((v & SWAR_HIGHS) || swarNulOrEsc(v))
+            break;
+        p += 8;
+    }
+
+    while (p < strEnd && isPlainAscii(*p))
+        p++;
 
-// not accurate subset, but works in most cases
-const UnicodeBlockRange wideSymbolRanges[] =
+    return p - str;
+}
+
+/** @brief Counts UTF-8 characters in leading ESC-free blocks;
+ *         stops at block that is not ending on character boundary */
+static unsigned utf8BlocksLen(const char *&str, const char *strEnd)
 {
-    // https://www.compart.com/en/unicode/block/U+2600
-    { 0x02600, 0x026FF },
-    // https://www.compart.com/en/unicode/block/U+2700
-    { 0x02700, 0x027BF },
-    // https://www.compart.com/en/unicode/block/U+1F300
-    { 0x1F300, 0x1F5FF },
-    // https://www.compart.com/en/unicode/block/U+1F600
-    { 0x1F600, 0x1F64F },
-    // https://www.compart.com/en/unicode/block/U+1F680
-    { 0x1F680, 0x1F6FF },
-    // https://www.compart.com/en/unicode/block/U+1F900
-    { 0x1F900, 0x1F9FF },
-};
+    unsigned len = 0;
+
+    while (strEnd - str >= 8)
+    {
+        // next block must begin with new character
+        if (strEnd - str > 8 && (str[8] & 0xC0) == 0x80)
+            break;
+
+        uint64_t v = swarLoad(str);
+        if (swarNulOrEsc(v))
+            break;
+
+        // continuation bytes: 10xxxxxx
+        uint64_t cont = v & ~(v << 1) & SWAR_HIGHS;
+        len += 8 - __builtin_popcountll(cont);
+        str += 8;
+    }
 
-uint16_t String::u8len(const char *str, const char *strEnd, bool ignoreESC, bool realWidth)
+    return len;
+}
+
+String::SizeType String::u8len(const char *str, const char *strEnd, bool ignoreESC, bool realWidth)
 {
     if (!str || !*str)
         return 0;
@@ -466,12 +631,27 @@ uint16_t String::u8len(const char *str, const char *strEnd, bool ignoreESC, bool
     if (!strEnd)
         strEnd = str + strlen(str);
 
-    uint16_t len = 0;
+    SizeType len = 0;
 
     while (str < strEnd)
     {
         bool seq_found = false;
 
+        // fast path: ASCII-only (width) or ESC-free (length) blocks
+        if (realWidth)
+        {
+            unsigned n = plainAsciiSpan(str, strEnd);
+            len += n;
+            str += n;
+        }
+        else
+        {
+            len += utf8BlocksLen(str, strEnd);
+        }
+
+        if (str >= strEnd)
+            break;
+
         if (ignoreESC)
         {
             uint16_t esc_len = escLen(str, strEnd);
@@ -491,15 +671,8 @@ uint16_t String::u8len(const char *str, const char *strEnd, bool ignoreESC, bool
             if (int u8_len = utf8charlen(u8ch))
             {
                 seq_found = true;
-                len++;
+                len += realWidth ? charWidth(u8ch) : 1;
                 str += u8_len;
-
-                if (realWidth && u8ch >= 0x02600)
-                {
-                    for (const auto &r : wideSymbolRanges)
-                        if (u8ch >= r.first && u8ch <= r.last)
-                            len++;
-                }
             }
         }
 
@@ -38,7 +38,7 @@ const char* strechr(const char *str, const char *estr, char c)
     return nullptr;
 }
 
-Vector<CStrView> splitWords(const char *str, const char *delim, bool storeDelim)
+Words splitWords(const char *str, const char *delim, bool storeDelim)
 {
     if (!str || !*str)
         return {};
@@ -47,7 +47,7 @@ Vector<CStrView> splitWords(const char *str, const char *delim, bool storeDelim)
 
     unsigned n_words = 1;
 
-    Vector<CStrView> out;
+    Words out;
     unsigned span = 0;
 
     const char *pstr = str;
@@ -211,17 +211,18 @@ Vector<CStrView> splitLines(const char *str)
 twins::String centerText(const char *str, uint16_t areaWidth)
 {
     if (!str) str = "";
-    auto str_width = twins::String::width(str);
+    // signed, as String sizes may be unsigned 32-bit
+    const int spaces = (int)areaWidth - (int)twins::String::width(str);
     twins::String out;
 
-    if (areaWidth - str_width > 0)
+    if (spaces > 0)
     {
-        uint16_t leading_spaces = (areaWidth - str_width)/2;
+        const int leading_spaces = spaces/2;
         // note that for reservation a buffer length is needed, not visual text width
-        out.reserve(strlen(str) + (areaWidth - str_width));
+        out.reserve(strlen(str) + spaces);
         out.append(' ', leading_spaces)
            .append(str)
-           .append(' ', areaWidth - str_width - leading_spaces);
+           .append(' ', spaces - leading_spaces);
     }
     else
     {
@@ -268,9 +269,13 @@ bool numEditInputEvt(const twins::KeyCode &kc, twins::String &str, int16_t &curs
             int64_t n = atoll(str.cstr());
             int delta = kc.m_shift ? 100 : (kc.m_ctrl ? 10 : 1);
             if (kc.key == twins::Key::Down) delta *= -1;
-            n += delta;
-            if (n < limitMin) n = wrap ? limitMax : limitMin;
-            if (n > limitMax) n = wrap ? limitMin : limitMax;
+
+            for (int r = kc.repeatCount(); r > 0; r--)
+            {
+                n += delta;
+                if (n < limitMin) n = wrap ? limitMax : limitMin;
+                if (n > limitMax) n = wrap ? limitMin : limitMax;
+            }
 
             str.clear();
             str.appendFmt("%lld", n);
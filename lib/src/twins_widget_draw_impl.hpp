@@ -0,0 +1,918 @@
+/******************************************************************************
+ * @brief   TWins - widget drawing, instantiated for the window state type
+ * @author  Mariusz Midor
+ *          https://bitbucket.org/marmidr/twins
+ *          https://github.com/marmidr/twins
+ *****************************************************************************/
+
+#pragma once
+#include "twins_widget_impl.hpp"
+#include "twins_arena.hpp"
+
+#include <assert.h>
+#include <algorithm>
+
+/// @note Do not include this file directly!
+
+// -----------------------------------------------------------------------------
+
+namespace twins
+{
+
+// forward decl
+template <class S>
+void drawWidgetInternal(CallCtxT<S> &ctx, const Widget *pWgt);
+template <class S>
+void drawPage(CallCtxT<S> &ctx, const Widget *pWgt, bool eraseBg = false);
+
+// -----------------------------------------------------------------------------
+
+template <class S>
+void drawWindow(CallCtxT<S> &ctx, const Widget *pWgt)
+{
+    Coord wnd_coord = pWgt->coord;
+    ctx.parentCoord = {0, 0};
+    ctx.pState->getWindowCoord(pWgt, wnd_coord);
+
+    drawArea(wnd_coord, pWgt->size,
+        pWgt->window.bgColor, pWgt->window.fgColor, FrameStyle::Double, true, pWgt->window.isPopup);
+
+    // title
+    String wnd_title;
+    wnd_title.useFrameArena();
+    if (pWgt->window.title)
+        wnd_title << pWgt->window.title;
+    else
+        ctx.pState->getWindowTitle(pWgt, wnd_title);
+
+    if (wnd_title.size())
+    {
+        const int title_width = wnd_title.width();
+        moveTo(wnd_coord.col + (pWgt->size.width - title_width - 4)/2, wnd_coord.row);
+        pushAttr(FontAttrib::Bold);
+        writeStrFmt("╡ %s ╞", wnd_title.cstr());
+        popAttr();
+    }
+
+    flushBuffer();
+    ctx.parentCoord = wnd_coord;
+
+    for (int i = pWgt->link.childrenIdx; i < pWgt->link.childrenIdx + pWgt->link.childrenCnt; i++)
+        drawWidgetInternal(ctx, ctx.at(i));
+
+    // reset colors set by frame drawer
+    popClBg();
+    popClFg();
+    moveTo(0, wnd_coord.row + pWgt->size.height);
+}
+
+template <class S>
+void drawPanel(CallCtxT<S> &ctx, const Widget *pWgt)
+{
+    FontMemento _m;
+    const auto my_coord = ctx.parentCoord + pWgt->coord;
+
+    drawArea(my_coord, pWgt->size,
+        pWgt->panel.bgColor, pWgt->panel.fgColor,
+        pWgt->panel.noFrame ? FrameStyle::None : FrameStyle::Single);
+    flushBuffer();
+
+    // title
+    if (pWgt->panel.title)
+    {
+        const int title_width = String::width(pWgt->panel.title);
+        moveTo(my_coord.col + (pWgt->size.width - title_width - 2)/2, my_coord.row);
+        pushAttr(FontAttrib::Bold);
+        writeStrFmt(" %s ", pWgt->panel.title);
+        popAttr();
+    }
+
+    flushBuffer();
+    auto coord_bkp = ctx.parentCoord;
+    ctx.parentCoord = my_coord;
+
+    for (int i = pWgt->link.childrenIdx; i < pWgt->link.childrenIdx + pWgt->link.childrenCnt; i++)
+        drawWidgetInternal(ctx, ctx.at(i));
+
+    ctx.parentCoord = coord_bkp;
+}
+
+template <class S>
+void drawLabel(CallCtxT<S> &ctx, const Widget *pWgt)
+{
+    // label text
+    CStrView txt;
+
+    if (pWgt->label.text)
+    {
+        txt = { pWgt->label.text, (unsigned)strlen(pWgt->label.text) };
+    }
+    else
+    {
+        txt = ctx.pState->getLabelTextView(pWgt);
+
+        if (!txt.data)
+        {
+            g_ws.strbuff.clear();
+            ctx.pState->getLabelText(pWgt, g_ws.strbuff);
+            txt = { g_ws.strbuff.cstr(), g_ws.strbuff.size() };
+        }
+    }
+
+    FontMemento _m;
+
+    // setup colors
+    pushClFg(getWidgetFgColor(ctx, pWgt));
+    pushClBg(getWidgetBgColor(ctx, pWgt));
+
+    // print all lines
+    const char *p_line = txt.data;
+    const char *p_end = txt.data + txt.size;
+    String s_line;
+    s_line.useFrameArena();
+    moveTo(ctx.parentCoord.col + pWgt->coord.col, ctx.parentCoord.row + pWgt->coord.row);
+    const uint8_t max_lines = pWgt->size.height ? pWgt->size.height : 50;
+    const uint8_t line_width = pWgt->size.width;
+
+    for (uint16_t line = 0; line < max_lines; line++)
+    {
+        s_line.clear();
+        const char *p_eol = util::strnchr(p_line, p_end - p_line, '\n');
+
+        if (p_eol)
+        {
+            // one or 2+ lines
+            s_line.appendLen(p_line, p_eol - p_line);
+            p_line = p_eol + 1;
+        }
+        else
+        {
+            // only or last line of text
+            s_line.appendLen(p_line, p_end - p_line);
+            p_line = " ";
+            p_end = p_line + 1;
+        }
+
+        if (line_width)
+            s_line.setWidth(line_width, true);
+
+        writeStrLen(s_line.cstr(), s_line.size());
+        moveBy(-(int16_t)s_line.width(), 1);
+        flushBuffer();
+
+        if (!p_eol && !pWgt->size.height)
+            break;
+    }
+}
+
+template <class S>
+void drawTextEdit(CallCtxT<S> &ctx, const Widget *pWgt)
+{
+    g_ws.strbuff.clear();
+    int16_t display_pos = 0;
+    const int16_t max_w = pWgt->size.width-3;
+
+    if (isSameWidget(ctx, pWgt, g_ws.textEditState.pWgt))
+    {
+        // in edit mode; similar calculation in setCursorAt()
+        g_ws.strbuff = g_ws.textEditState.txt;
+        auto cursor_pos = g_ws.textEditState.cursorPos;
+        auto delta = (max_w/2);
+
+        while (cursor_pos >= max_w-1)
+        {
+            cursor_pos -= delta;
+            display_pos += delta;
+        }
+    }
+    else
+    {
+        CStrView txt = ctx.pState->getTextEditTextView(pWgt);
+
+        if (txt.data)
+            g_ws.strbuff.appendLen(txt.data, txt.size);
+        else
+            ctx.pState->getTextEditText(pWgt, g_ws.strbuff, false);
+    }
+
+    const int txt_width = g_ws.strbuff.width();
+
+    if (display_pos > 0)
+    {
+        auto *str_beg = String::u8skip(g_ws.strbuff.cstr(), display_pos + 1);
+        String s;
+        s.useFrameArena();
+        s << "◁";
+        s << str_beg;
+        g_ws.strbuff = std::move(s);
+    }
+
+    if (display_pos + max_w <= txt_width)
+    {
+        g_ws.strbuff.setWidth(pWgt->size.width-3-1);
+        g_ws.strbuff.append("▷");
+    }
+    else
+    {
+        g_ws.strbuff.setWidth(pWgt->size.width-3);
+    }
+    g_ws.strbuff.append("[^]");
+
+    bool focused = ctx.pState->isFocused(pWgt);
+    auto clbg = getWidgetBgColor(ctx, pWgt);
+    intensifyClIf(focused, clbg);
+
+    FontMemento _m;
+    moveTo(ctx.parentCoord.col + pWgt->coord.col, ctx.parentCoord.row + pWgt->coord.row);
+    pushClBg(clbg);
+    pushClFg(getWidgetFgColor(ctx, pWgt));
+    writeStrLen(g_ws.strbuff.cstr(), g_ws.strbuff.size());
+}
+
+template <class S>
+void drawLed(CallCtxT<S> &ctx, const Widget *pWgt)
+{
+    auto clbg = ctx.pState->getLedLit(pWgt) ? pWgt->led.bgColorOn : pWgt->led.bgColorOff;
+    CStrView txt;
+
+    if (pWgt->led.text)
+    {
+        txt = { pWgt->led.text, (unsigned)strlen(pWgt->led.text) };
+    }
+    else
+    {
+        txt = ctx.pState->getLedTextView(pWgt);
+
+        if (!txt.data)
+        {
+            g_ws.strbuff.clear();
+            ctx.pState->getLedText(pWgt, g_ws.strbuff);
+            txt = { g_ws.strbuff.cstr(), g_ws.strbuff.size() };
+        }
+    }
+
+    // led text
+    FontMemento _m;
+    moveTo(ctx.parentCoord.col + pWgt->coord.col, ctx.parentCoord.row + pWgt->coord.row);
+    pushClBg(clbg);
+    pushClFg(getWidgetFgColor(ctx, pWgt));
+    writeStrLen(txt.data, txt.size);
+}
+
+template <class S>
+void drawCheckbox(CallCtxT<S> &ctx, const Widget *pWgt)
+{
+    const char *s_chk_state = ctx.pState->getCheckboxChecked(pWgt) ? "[■] " : "[ ] ";
+    bool focused = ctx.pState->isFocused(pWgt);
+    auto clfg = getWidgetFgColor(ctx, pWgt);
+    intensifyClIf(focused, clfg);
+
+    FontMemento _m;
+    moveTo(ctx.parentCoord.col + pWgt->coord.col, ctx.parentCoord.row + pWgt->coord.row);
+    if (focused) pushAttr(FontAttrib::Bold);
+    pushClFg(clfg);
+    writeStr(s_chk_state);
+    writeStr(pWgt->checkbox.text);
+}
+
+template <class S>
+void drawRadio(CallCtxT<S> &ctx, const Widget *pWgt)
+{
+    const char *s_radio_state = pWgt->radio.radioId == ctx.pState->getRadioIndex(pWgt) ? "(●) " : "( ) ";
+    bool focused = ctx.pState->isFocused(pWgt);
+    auto clfg = getWidgetFgColor(ctx, pWgt);
+    intensifyClIf(focused, clfg);
+
+    FontMemento _m;
+    moveTo(ctx.parentCoord.col + pWgt->coord.col, ctx.parentCoord.row + pWgt->coord.row);
+    if (focused) pushAttr(FontAttrib::Bold);
+    pushClFg(clfg);
+    writeStr(s_radio_state);
+    writeStr(pWgt->radio.text);
+}
+
+template <class S>
+void drawButton(CallCtxT<S> &ctx, const Widget *pWgt)
+{
+    const bool focused = ctx.pState->isFocused(pWgt);
+    const bool pressed = isSameWidget(ctx, pWgt, g_ws.pMouseDownWgt);
+    auto clfg = getWidgetFgColor(ctx, pWgt);
+    intensifyClIf(focused, clfg);
+
+    String txt_buff;
+    txt_buff.useFrameArena();
+    CStrView txt;
+
+    if (pWgt->button.text)
+    {
+        txt = { pWgt->button.text, (unsigned)strlen(pWgt->button.text) };
+    }
+    else
+    {
+        txt = ctx.pState->getButtonTextView(pWgt);
+
+        if (!txt.data)
+        {
+            ctx.pState->getButtonText(pWgt, txt_buff);
+            txt = { txt_buff.cstr(), txt_buff.size() };
+        }
+    }
+
+    const int16_t txt_width = String::width(txt.data, txt.data + txt.size);
+
+    if (pWgt->button.style == ButtonStyle::Simple)
+    {
+        FontMemento _m;
+        g_ws.strbuff.clear()
+                .append("[ ")
+                .appendLen(txt.data, txt.size)
+                .append(" ]");
+
+        moveTo(ctx.parentCoord.col + pWgt->coord.col, ctx.parentCoord.row + pWgt->coord.row);
+        if (focused) pushAttr(FontAttrib::Bold);
+        if (pressed) pushAttr(FontAttrib::Inverse);
+        auto clbg = pressed ? getWidgetBgColor(ctx, pWgt) : getWidgetBgColor(ctx, ctx.parentOf(pWgt));
+        pushClBg(clbg);
+        pushClFg(clfg);
+        writeStrLen(g_ws.strbuff.cstr(), g_ws.strbuff.size());
+    }
+    else if (pWgt->button.style == ButtonStyle::Solid)
+    {
+        {
+            FontMemento _m;
+            g_ws.strbuff.clear();
+            g_ws.strbuff.append(' ').appendLen(txt.data, txt.size).append(' ');
+
+            auto clbg = getWidgetBgColor(ctx, pWgt);
+            moveTo(ctx.parentCoord.col + pWgt->coord.col, ctx.parentCoord.row + pWgt->coord.row);
+            if (focused) pushAttr(FontAttrib::Bold);
+            if (pressed) pushAttr(FontAttrib::Inverse);
+            pushClBg(clbg);
+            pushClFg(clfg);
+            writeStrLen(g_ws.strbuff.cstr(), g_ws.strbuff.size());
+        }
+
+        auto shadow_len = 2 + txt_width;
+
+        if (pressed)
+        {
+            // erase trailing shadow
+            pushClBg(getWidgetBgColor(ctx, ctx.parentOf(pWgt)));
+            writeChar(' ');
+            // erase shadow below
+            moveTo(ctx.parentCoord.col + pWgt->coord.col + 1, ctx.parentCoord.row + pWgt->coord.row + 1);
+            writeStr(" ", shadow_len);
+            popClBg();
+        }
+        else
+        {
+            FontMemento _m;
+            // trailing shadow
+            pushClBg(getWidgetBgColor(ctx, ctx.parentOf(pWgt)));
+            writeStr(ESC_FG_COLOR(233));
+            writeStr("▄");
+            // shadow below
+            moveTo(ctx.parentCoord.col + pWgt->coord.col + 1, ctx.parentCoord.row + pWgt->coord.row + 1);
+            writeStr("▀", shadow_len);
+        }
+    }
+    else if (pWgt->button.style == ButtonStyle::Solid1p5)
+    {
+        g_ws.strbuff.clear();
+        g_ws.strbuff.append(' ').appendLen(txt.data, txt.size).append(' ');
+        auto clbg = getWidgetBgColor(ctx, pWgt);
+        auto clparbg = getWidgetBgColor(ctx, ctx.parentOf(pWgt));
+        const int16_t bnt_len = 2 + txt_width;
+        const char* scl_shadow = ESC_BG_COLOR(233);
+        const char* scl_bg2fg = transcodeClBg2Fg(encodeCl(clbg));
+        FontMemento _m;
+
+        // upper half line
+        moveTo(ctx.parentCoord.col + pWgt->coord.col, ctx.parentCoord.row + pWgt->coord.row);
+        pushClBg(clparbg);
+        if (pressed)
+            pushClFg(clfg);
+        else
+            writeStr(scl_bg2fg);
+        writeStr("▄", bnt_len);
+
+        // middle line - text
+        moveBy(-bnt_len, 1);
+        pushClBg(clbg);
+        pushClFg(clfg);
+        if (pressed) pushAttr(FontAttrib::Inverse);
+        if (focused) pushAttr(FontAttrib::Bold);
+        writeStrLen(g_ws.strbuff.cstr(), g_ws.strbuff.size());
+        if (focused) popAttr();
+        if (pressed) popAttr();
+
+        // middle-shadow
+        if (pressed)
+            pushClBg(clparbg);
+        else
+            writeStr(scl_shadow);
+        writeChar(' ');
+
+        // lower half-line
+        moveBy(-bnt_len-1, 1);
+        if (pressed)
+        {
+            pushClFg(clfg);
+            pushClBg(clparbg);
+            writeStr("▀");
+            pushClBg(clparbg);
+        }
+        else
+        {
+            writeStr(scl_bg2fg);
+            pushClBg(clparbg);
+            writeStr("▀");
+            writeStr(scl_shadow);
+        }
+        writeStr("▀", bnt_len-1);
+
+        // trailing shadow
+        writeChar(' ');
+    }
+}
+
+template <class S>
+void drawPageControl(CallCtxT<S> &ctx, const Widget *pWgt)
+{
+    const auto my_coord = ctx.parentCoord + pWgt->coord;
+    FontMemento _m;
+    pushClBg(getWidgetBgColor(ctx, pWgt));
+    pushClFg(getWidgetFgColor(ctx, pWgt));
+    drawArea(my_coord + Coord{pWgt->pagectrl.tabWidth, 0}, pWgt->size - Size{pWgt->pagectrl.tabWidth, 0},
+        ColorBG::Inherit, ColorFG::Inherit, FrameStyle::PgControl);
+    flushBuffer();
+
+    auto coord_bkp = ctx.parentCoord;
+    ctx.parentCoord = my_coord;
+    // tabs title
+    g_ws.strbuff.clear();
+    g_ws.strbuff.append(' ', (pWgt->pagectrl.tabWidth-8) / 2);
+    g_ws.strbuff.append("≡ MENU ≡");
+    g_ws.strbuff.setWidth(pWgt->pagectrl.tabWidth);
+    moveTo(my_coord.col, my_coord.row + pWgt->pagectrl.vertOffs);
+    pushAttr(FontAttrib::Inverse);
+    writeStrLen(g_ws.strbuff.cstr(), g_ws.strbuff.size());
+    popAttr();
+
+    // draw tabs and pages
+    const int pg_idx = ctx.pState->getPageCtrlPageIndex(pWgt);
+    // const bool focused = ctx.pState->isFocused(pWgt);
+    // moveTo(ctx.parentCoord.col + pWgt->coord.col, ctx.parentCoord.row + pWgt->coord.row);
+    flushBuffer();
+
+    for (int i = 0; i < pWgt->link.childrenCnt; i++)
+    {
+        if (i == pWgt->size.height - 1 - pWgt->pagectrl.vertOffs)
+            break;
+
+        WidgetPtr p_page = ctx.at(pWgt->link.childrenIdx + i);
+
+        // draw page title
+        g_ws.strbuff.clear();
+        g_ws.strbuff.appendFmt("%s%s", i == pg_idx ? "►" : " ", p_page->page.title);
+        g_ws.strbuff.setWidth(pWgt->pagectrl.tabWidth, true);
+
+        moveTo(my_coord.col, my_coord.row + pWgt->pagectrl.vertOffs + i + 1);
+
+        // for Page we do not want inherit after it's title color
+        auto clfg = p_page->page.fgColor;
+        if (clfg == ColorFG::Inherit)
+            clfg = getWidgetFgColor(ctx, p_page);
+
+        pushClFg(clfg);
+        if (i == pg_idx) pushAttr(FontAttrib::Inverse);
+        writeStrLen(g_ws.strbuff.cstr(), g_ws.strbuff.size());
+        if (i == pg_idx) popAttr();
+        popClFg();
+
+        if (ctx.pState->isVisible(p_page))
+        {
+            flushBuffer();
+            ctx.parentCoord.col += pWgt->pagectrl.tabWidth;
+            drawPage(ctx, p_page);
+            ctx.parentCoord.col -= pWgt->pagectrl.tabWidth;
+        }
+    }
+
+    ctx.parentCoord = coord_bkp;
+}
+
+template <class S>
+void drawPage(CallCtxT<S> &ctx, const Widget *pWgt, bool eraseBg)
+{
+    if (eraseBg)
+    {
+        WidgetPtr p_pgctrl = ctx.parentOf(pWgt);
+        auto page_coord = getScreenCoord(ctx, p_pgctrl);
+        page_coord.col += p_pgctrl->pagectrl.tabWidth;
+        drawArea(page_coord, p_pgctrl->size - Size{p_pgctrl->pagectrl.tabWidth, 0},
+            ColorBG::Inherit, ColorFG::Inherit, FrameStyle::PgControl);
+    }
+
+    // draw childrens
+    for (int i = pWgt->link.childrenIdx; i < pWgt->link.childrenIdx + pWgt->link.childrenCnt; i++)
+        drawWidgetInternal(ctx, ctx.at(i));
+}
+
+template <class S>
+void drawProgressBar(CallCtxT<S> &ctx, const Widget *pWgt)
+{
+    const char* style_data[][2] =
+    {
+        {"#", "."},
+        {"█", "▒"},
+        {"■", "□"}
+    };
+
+    int32_t pos = 0, max = 1;
+    auto style = (short)pWgt->progressbar.style;
+    ctx.pState->getProgressBarState(pWgt, pos, max);
+
+    if (max <= 0) max = 1;
+    if (pos > max) pos = max;
+
+    moveTo(ctx.parentCoord.col + pWgt->coord.col, ctx.parentCoord.row + pWgt->coord.row);
+    g_ws.strbuff.clear();
+    int fill = pos * pWgt->size.width / max;
+    g_ws.strbuff.append(style_data[style][0], fill);
+    g_ws.strbuff.append(style_data[style][1], pWgt->size.width - fill);
+
+    pushClFg(getWidgetFgColor(ctx, pWgt));
+    writeStrLen(g_ws.strbuff.cstr(), g_ws.strbuff.size());
+    popClFg();
+
+    // ████░░░░░░░░░░░
+    // [####.........]
+    // [■■■■□□□□□□□□□]
+    //  ▁▂▃▄▅▆▇█ - for vertical ▂▄▆█
+}
+
+template <class S>
+struct DrawListParams
+{
+    Coord coord;
+    int16_t item_idx;
+    int16_t sel_idx;
+    int16_t items_cnt;
+    uint16_t items_visible;
+    uint16_t top_item;
+    bool focused;
+    uint8_t wgt_width;
+    uint8_t frame_size;
+    // plain function pointer - no heap allocated closure
+    void (*getItem)(CallCtxT<S> &ctx, const Widget *pWgt, int16_t idx, String &out);
+    CallCtxT<S> *pCtx;
+    const Widget *pWgt;
+};
+
+template <class S>
+void drawList(DrawListParams<S> &p)
+{
+    if (p.items_cnt > p.items_visible)
+    {
+        drawListScrollBarV(p.coord + Coord{uint8_t(p.wgt_width-1), p.frame_size},
+            p.items_visible, p.items_cnt-1, p.sel_idx);
+    }
+
+    flushBuffer();
+
+    for (int i = 0; i < p.items_visible; i++)
+    {
+        bool is_current_item = p.items_cnt ? (p.top_item + i == p.item_idx) : false;
+        bool is_sel_item = p.top_item + i == p.sel_idx;
+        moveTo(p.coord.col + p.frame_size, p.coord.row + i + p.frame_size);
+
+        g_ws.strbuff.clear();
+
+        if (p.top_item + i < p.items_cnt)
+        {
+            p.getItem(*p.pCtx, p.pWgt, p.top_item + i, g_ws.strbuff);
+            g_ws.strbuff.insert(0, is_current_item ? "►" : " ");
+            g_ws.strbuff.setWidth(p.wgt_width - 1 - p.frame_size, true);
+        }
+        else
+        {
+            // empty string - to erase old content
+            g_ws.strbuff.setWidth(p.wgt_width - 1 - p.frame_size);
+        }
+
+        if (p.focused && is_sel_item) pushAttr(FontAttrib::Inverse);
+        if (is_current_item) pushAttr(FontAttrib::Underline);
+        writeStrLen(g_ws.strbuff.cstr(), g_ws.strbuff.size());
+        if (is_current_item) popAttr();
+        if (p.focused && is_sel_item) popAttr();
+    }
+};
+
+template <class S>
+void drawListBox(CallCtxT<S> &ctx, const Widget *pWgt)
+{
+    FontMemento _m;
+    const auto my_coord = ctx.parentCoord + pWgt->coord;
+    drawArea(my_coord, pWgt->size,
+        pWgt->listbox.bgColor, pWgt->listbox.fgColor,
+        pWgt->listbox.noFrame ? FrameStyle::None : FrameStyle::ListBox, false);
+
+    if (pWgt->size.height < 3)
+        return;
+
+    DrawListParams<S> dlp = {};
+    dlp.coord = my_coord;
+    ctx.pState->getListBoxState(pWgt, dlp.item_idx, dlp.sel_idx, dlp.items_cnt);
+    dlp.frame_size = !pWgt->listbox.noFrame;
+    dlp.items_visible = pWgt->size.height - (dlp.frame_size * 2);
+    dlp.top_item = (dlp.sel_idx / dlp.items_visible) * dlp.items_visible;
+    dlp.focused = ctx.pState->isFocused(pWgt);
+    dlp.wgt_width = pWgt->size.width;
+    dlp.pCtx = &ctx;
+    dlp.pWgt = pWgt;
+    dlp.getItem = [](CallCtxT<S> &ctx, const Widget *pWgt, int16_t idx, String &out)
+    {
+        CStrView txt = ctx.pState->getListBoxItemView(pWgt, idx);
+        if (txt.data) out.appendLen(txt.data, txt.size);
+        else ctx.pState->getListBoxItem(pWgt, idx, out);
+    };
+    drawList(dlp);
+}
+
+template <class S>
+void drawComboBox(CallCtxT<S> &ctx, const Widget *pWgt)
+{
+    FontMemento _m;
+    const auto my_coord = ctx.parentCoord + pWgt->coord;
+    const bool focused = ctx.pState->isFocused(pWgt);
+
+    int16_t item_idx = 0; int16_t sel_idx = 0; int16_t items_count; bool drop_down = false;
+    ctx.pState->getComboBoxState(pWgt, item_idx, sel_idx, items_count, drop_down);
+
+    {
+        g_ws.strbuff.clear();
+        CStrView txt = ctx.pState->getComboBoxItemView(pWgt, item_idx);
+
+        if (txt.data)
+        {
+            g_ws.strbuff.append(' ').appendLen(txt.data, txt.size);
+        }
+        else
+        {
+            ctx.pState->getComboBoxItem(pWgt, item_idx, g_ws.strbuff);
+            g_ws.strbuff.insert(0, " ");
+        }
+        g_ws.strbuff.setWidth(pWgt->size.width - 4, true);
+        g_ws.strbuff << (drop_down ? " [▲]" : " [▼]");
+
+        moveTo(my_coord.col, my_coord.row);
+        pushClFg(getWidgetFgColor(ctx, pWgt));
+        pushClBg(getWidgetBgColor(ctx, pWgt));
+        if (focused && !drop_down) pushAttr(FontAttrib::Inverse);
+        if (drop_down) pushAttr(FontAttrib::Underline);
+        if (focused) pushAttr(FontAttrib::Bold);
+        writeStrLen(g_ws.strbuff.cstr(), g_ws.strbuff.size());
+        if (focused) popAttr();
+        if (drop_down) popAttr();
+    }
+
+    if (drop_down)
+    {
+        DrawListParams<S> dlp = {};
+        dlp.coord.col = my_coord.col;
+        dlp.coord.row = my_coord.row+1;
+        dlp.item_idx = item_idx;
+        dlp.sel_idx = sel_idx;
+        dlp.items_cnt = items_count;
+        dlp.frame_size = 0;
+        dlp.items_visible = pWgt->combobox.dropDownSize;
+        dlp.top_item = (dlp.sel_idx / dlp.items_visible) * dlp.items_visible;
+        dlp.focused = focused;
+        dlp.wgt_width = pWgt->size.width;
+        dlp.pCtx = &ctx;
+        dlp.pWgt = pWgt;
+        dlp.getItem = [](CallCtxT<S> &ctx, const Widget *pWgt, int16_t idx, String &out)
+        {
+            CStrView txt = ctx.pState->getComboBoxItemView(pWgt, idx);
+            if (txt.data) out.appendLen(txt.data, txt.size);
+            else ctx.pState->getComboBoxItem(pWgt, idx, out);
+        };
+        drawList(dlp);
+    }
+}
+
+template <class S>
+void drawCustomWgt(CallCtxT<S> &ctx, const Widget *pWgt)
+{
+    ctx.pState->onCustomWidgetDraw(pWgt);
+}
+
+template <class S>
+void drawTextBox(CallCtxT<S> &ctx, const Widget *pWgt)
+{
+    FontMemento _m;
+    const auto my_coord = ctx.parentCoord + pWgt->coord;
+
+    drawArea(my_coord, pWgt->size,
+        pWgt->textbox.bgColor, pWgt->textbox.fgColor,
+        FrameStyle::ListBox, false, false);
+
+    if (pWgt->size.height < 3)
+        return;
+
+    const uint8_t lines_visible = pWgt->size.height - 2;
+    const twins::Vector<twins::CStrView> *p_lines = nullptr;
+    int16_t top_line = 0;
+
+    ctx.pState->getTextBoxState(pWgt, &p_lines, top_line);
+
+    if (!p_lines || !p_lines->size())
+        return;
+
+    if (top_line > (int)p_lines->size())
+    {
+        top_line = p_lines->size() - lines_visible;
+        ctx.pState->onTextBoxScroll(pWgt, top_line);
+    }
+
+    if (top_line < 0)
+    {
+        ctx.pState->onTextBoxScroll(pWgt, top_line);
+        top_line = 0;
+    }
+
+    drawListScrollBarV(my_coord + Coord{uint8_t(pWgt->size.width-1), 1},
+        lines_visible, p_lines->size() - lines_visible, top_line);
+
+    flushBuffer();
+
+    // scan invisible lines for ESC sequences: colors, font attributes
+    g_ws.strbuff.clear();
+    for (int i = 0; i < top_line; i++)
+    {
+        auto sr = (*p_lines)[i];
+        while (const char *esc = twins::util::strnchr(sr.data, sr.size, '\e'))
+        {
+            auto esclen = String::escLen(esc, sr.data + sr.size);
+            g_ws.strbuff.appendLen(esc, esclen);
+
+            sr.size -= esc - sr.data + 1;
+            sr.data = esc + 1;
+        }
+    }
+    writeStrLen(g_ws.strbuff.cstr(), g_ws.strbuff.size());
+
+    // draw lines
+    for (int i = 0; i < lines_visible; i++)
+    {
+        g_ws.strbuff.clear();
+        if (top_line + i < (int)p_lines->size())
+        {
+            const auto &sr = (*p_lines)[top_line + i];
+            g_ws.strbuff.appendLen(sr.data, sr.size);
+        }
+        g_ws.strbuff.setWidth(pWgt->size.width - 2, true);
+        moveTo(my_coord.col + 1, my_coord.row + i + 1);
+        writeStrLen(g_ws.strbuff.cstr(), g_ws.strbuff.size());
+    }
+
+    flushBuffer();
+}
+
+template <class S>
+void drawLayer(CallCtxT<S> &ctx, const Widget *pWgt)
+{
+    // draw only childrens; to erase, redraw layer's parent
+    for (int i = pWgt->link.childrenIdx; i < pWgt->link.childrenIdx + pWgt->link.childrenCnt; i++)
+        drawWidgetInternal(ctx, ctx.at(i));
+}
+
+// -----------------------------------------------------------------------------
+
+template <class S>
+void drawWidgetInternal(CallCtxT<S> &ctx, const Widget *pWgt)
+{
+    if (!ctx.pState->isVisible(pWgt))
+        return;
+
+    bool en = isEnabled(ctx, pWgt);
+    if (!en) pushAttr(FontAttrib::Faint);
+
+    switch (pWgt->type)
+    {
+    case Widget::Window:        drawWindow(ctx, pWgt); break;
+    case Widget::Panel:         drawPanel(ctx, pWgt); break;
+    case Widget::Label:         drawLabel(ctx, pWgt); break;
+    case Widget::TextEdit:      drawTextEdit(ctx, pWgt); break;
+    case Widget::CheckBox:      drawCheckbox(ctx, pWgt); break;
+    case Widget::Radio:         drawRadio(ctx, pWgt);  break;
+    case Widget::Button:        drawButton(ctx, pWgt); break;
+    case Widget::Led:           drawLed(ctx, pWgt); break;
+    case Widget::PageCtrl:      drawPageControl(ctx, pWgt); break;
+    case Widget::Page:          drawPage(ctx, pWgt, true); break;
+    case Widget::ProgressBar:   drawProgressBar(ctx, pWgt); break;
+    case Widget::ListBox:       drawListBox(ctx, pWgt); break;;
+    case Widget::ComboBox:      drawComboBox(ctx, pWgt); break;
+    case Widget::CustomWgt:     drawCustomWgt(ctx, pWgt); break;
+    case Widget::TextBox:       drawTextBox(ctx, pWgt); break;
+    case Widget::Layer:         drawLayer(ctx, pWgt); break;
+    default:                    break;
+    }
+
+    if (!en)
+        popAttr();
+
+    flushBuffer();
+}
+
+// -----------------------------------------------------------------------------
+
+template <class S>
+void drawWidgetsImpl(CallCtxT<S> &ctx, const WID *pWidgetIds, uint16_t count)
+{
+    if (count == 0)
+        return;
+
+    // temporaries released at exit
+    FrameArenaScope _arena_scope;
+    assert(pWidgetIds);
+    g_ws.pFocusedWgt = getWidgetByWID(ctx, ctx.pState->getFocusedID());
+    cursorHide();
+    flushBuffer();
+
+    if (count == 1 && *pWidgetIds == WIDGET_ID_ALL)
+    {
+        drawWidgetInternal(ctx, ctx.pWindow);
+    }
+    else
+    {
+        // sorted IDs allows to collect the widgets in a single pass
+        FrameArray<WID> ids(count);
+        for (unsigned i = 0; i < count; i++)
+            ids.append(pWidgetIds[i]);
+        auto *p_ids_beg = ids.data();
+        auto *p_ids_end = ids.data() + ids.size();
+        std::sort(p_ids_beg, p_ids_end);
+
+        // widget indexes: parent always precedes it's children, siblings are next to each other
+        FrameArray<uint16_t> wgt_idxs(count);
+        if (const auto *p_cols = ctx.pColumns)
+        {
+            for (unsigned i = 0; i < p_cols->count; i++)
+                if (std::binary_search(p_ids_beg, p_ids_end, p_cols->pIds[i]))
+                    wgt_idxs.append(i);
+        }
+        else
+        {
+            for (unsigned i = 0; ctx.pWidgets[i].type != Widget::None; i++)
+                if (std::binary_search(p_ids_beg, p_ids_end, ctx.pWidgets[i].id))
+                    wgt_idxs.append(i);
+        }
+
+        int parent_idx = -1;
+        bool parent_visible = false;
+        Coord parent_coord;
+
+        for (auto wgt_idx : wgt_idxs)
+        {
+            WidgetPtr p_wgt = ctx.at(wgt_idx);
+
+            if (isAncestorListed(ctx, p_wgt, wgt_idxs))
+                continue;
+
+            // siblings share the parent context
+            if (p_wgt->link.parentIdx != parent_idx)
+            {
+                parent_idx = p_wgt->link.parentIdx;
+                parent_coord = {};
+                parent_visible = getParentContext(ctx, p_wgt, parent_coord);
+            }
+
+            if (parent_visible && ctx.pState->isVisible(p_wgt))
+            {
+                ctx.parentCoord = parent_coord;
+                // set parent's background color
+                pushClBg(getWidgetBgColor(ctx, p_wgt));
+                drawWidgetInternal(ctx, p_wgt);
+                popClBg();
+            }
+        }
+    }
+
+    resetAttr();
+    resetClBg();
+    resetClFg();
+    setCursorAt(ctx, g_ws.pFocusedWgt);
+    cursorShow();
+    flushBuffer();
+}
+
+// -----------------------------------------------------------------------------
+
+// instantiated once, in twins_widget_draw.cpp
+extern template void drawWidgetsImpl<IWindowState>(CallCtx &ctx, const WID *pWidgetIds, uint16_t count);
+
+// -----------------------------------------------------------------------------
+
+}
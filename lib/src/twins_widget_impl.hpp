@@ -0,0 +1,1685 @@
+/******************************************************************************
+ * @brief   TWins - widget input processing, instantiated for the window state type
+ * @author  Mariusz Midor
+ *          https://bitbucket.org/marmidr/twins
+ *          https://github.com/marmidr/twins
+ *****************************************************************************/
+
+#pragma once
+#include "twins_widget_prv.hpp"
+#include "twins_utils.hpp"
+
+#include <string.h>
+#include <assert.h>
+#include <utility> //std::swap
+#include <type_traits>
+
+/// @note Do not include this file directly!
+
+// -----------------------------------------------------------------------------
+
+namespace twins
+{
+
+template <class S>
+Coord getScreenCoord(CallCtxT<S> &ctx, const Widget *pWgt)
+{
+    if (const auto *p_cols = ctx.pColumns)
+    {
+        // rects are relative to the Window
+        Coord coord = p_cols->pRects[0].coord;
+        ctx.pState->getWindowCoord(ctx.pWindow, coord);
+        if (pWgt->link.ownIdx > 0)
+            coord += p_cols->pRects[pWgt->link.ownIdx].coord;
+        return coord;
+    }
+
+    Coord coord = pWgt->coord;
+    if (pWgt->type == Widget::Type::Window)
+        ctx.pState->getWindowCoord(pWgt, coord);
+
+    if (pWgt->link.ownIdx > 0)
+    {
+        // go up the widgets hierarchy
+        const auto *p_parent = getParent(pWgt);
+
+        for (;;)
+        {
+            if (p_parent->type == Widget::Type::Window)
+            {
+                Coord wnd_coord = p_parent->coord;
+                // getWindowCoord is optional
+                ctx.pState->getWindowCoord(p_parent, wnd_coord);
+                coord += wnd_coord;
+            }
+            else
+            {
+                coord += p_parent->coord;
+            }
+
+            if (p_parent->type == Widget::Type::PageCtrl)
+            {
+                coord.col += p_parent->pagectrl.tabWidth;
+            }
+
+            // top-level parent reached
+            if (p_parent->link.ownIdx == 0)
+                break;
+
+            p_parent = getParent(p_parent);
+        }
+    }
+
+    return coord;
+}
+
+template <class S>
+bool getWidgetWSS(CallCtxT<S> &ctx, WidgetSearchStruct &wss)
+{
+    if (wss.searchedID == WIDGET_ID_NONE)
+        return false;
+
+    WidgetPtr p_wgt = getWidgetByWID(ctx, wss.searchedID);
+
+    if (!p_wgt)
+        return false;
+
+    wss.pWidget = p_wgt;
+    wss.isVisible = ctx.pState->isVisible(p_wgt);
+    wss.isVisible &= getParentContext(ctx, p_wgt, wss.parentCoord);
+    return true;
+}
+
+template <class S>
+bool getParentContext(CallCtxT<S> &ctx, const Widget *pWgt, Coord &parentCoord)
+{
+    bool vis = true;
+
+    // go up the widgets hierarchy
+    int parent_idx = pWgt->link.parentIdx;
+
+    for (;;)
+    {
+        WidgetPtr p_parent = ctx.at(parent_idx);
+        vis &= ctx.pState->isVisible(p_parent);
+
+        Coord coord = p_parent->coord;
+        if (p_parent->type == Widget::Type::Window)
+            ctx.pState->getWindowCoord(p_parent, coord);
+        parentCoord += coord;
+
+        if (p_parent->type == Widget::Type::PageCtrl)
+            parentCoord.col += p_parent->pagectrl.tabWidth;
+
+        if (parent_idx == 0)
+            break;
+
+        parent_idx = p_parent->link.parentIdx;
+    }
+
+    return vis;
+}
+
+template <class S>
+WidgetPtr getWidgetByWID(CallCtxT<S> &ctx, const WID widgetId)
+{
+    if (const auto *p_cols = ctx.pColumns)
+    {
+        for (unsigned i = 0; i < p_cols->count; i++)
+            if (p_cols->pIds[i] == widgetId)
+                return ctx.at(i);
+
+        return nullptr;
+    }
+
+    // pWndArray is terminated by empty entry
+    for (unsigned i = 0; ctx.pWidgets[i].type != Widget::None; i++)
+        if (ctx.pWidgets[i].id == widgetId)
+            return &ctx.pWidgets[i];
+
+    return nullptr;
+}
+
+template <class S>
+WidgetPtr getWidgetAt(CallCtxT<S> &ctx, uint16_t col, uint16_t row, Rect &wgtRect)
+{
+    WidgetPtr p_wgt_at;
+    Rect best_rect;
+    best_rect.setMax();
+
+    // with columns, screen position is the Window position plus precalculated offset
+    const auto *p_cols = ctx.pColumns;
+    Coord wnd_coord = {};
+    if (p_cols)
+        wnd_coord = getScreenCoord(ctx, ctx.pWindow);
+
+    for (unsigned i = 0; p_cols ? i < p_cols->count : ctx.pWidgets[i].type != Widget::None; i++)
+    {
+        bool stop_searching = true;
+        Rect r;
+        WidgetPtr p_wgt = ctx.at(i);
+
+        if (p_cols)
+        {
+            r = p_cols->pRects[i];
+            r.coord = i ? r.coord + wnd_coord : wnd_coord;
+        }
+        else
+        {
+            r.coord = getScreenCoord(ctx, p_wgt);
+            r.size = p_wgt->size;
+        }
+
+        // correct the widget size
+        switch (p_cols ? p_cols->pTypes[i] : p_wgt->type)
+        {
+        case Widget::TextEdit:
+            break;
+        case Widget::CheckBox:
+            r.size.height = 1;
+            r.size.width = 4 + String::width(p_wgt->checkbox.text);
+            break;
+        case Widget::Radio:
+            r.size.height = 1;
+            r.size.width = 4 + String::width(p_wgt->radio.text);
+            break;
+        case Widget::Button:
+        {
+            uint16_t txt_w = 0;
+
+            if (p_wgt->button.text)
+                txt_w = String::width(p_wgt->button.text);
+            else if (p_wgt->size.width)
+                txt_w = p_wgt->size.width;
+            else
+            {
+                CStrView txt = ctx.pState->getButtonTextView(p_wgt);
+
+                if (txt.data)
+                {
+                    txt_w = String::width(txt.data, txt.data + txt.size);
+                }
+                else
+                {
+                    g_ws.strbuff.clear();
+                    ctx.pState->getButtonText(p_wgt, g_ws.strbuff);
+                    txt_w = g_ws.strbuff.width();
+                }
+            }
+
+            switch (p_wgt->button.style)
+            {
+            case ButtonStyle::Simple:
+                r.size.height = 1;
+                r.size.width = 4 + txt_w;
+                break;
+            case ButtonStyle::Solid:
+                r.size.height = 1;
+                r.size.width = 2 + txt_w;
+                break;
+            case ButtonStyle::Solid1p5:
+                r.size.height = 3;
+                r.size.width = 2 + txt_w;
+                break;
+            default:
+                break;
+            }
+            break;
+        }
+        case Widget::PageCtrl:
+            r.size.width = p_wgt->pagectrl.tabWidth;
+            break;
+        case Widget::ListBox:
+            break;
+        case Widget::ComboBox:
+            break;
+        default:
+            stop_searching = false;
+            break;
+        }
+
+        if (isPointWithin(col, row, r))
+        {
+            bool is_visible = isVisible(ctx, p_wgt); // controls on tabs? solved
+
+            if (is_visible && isRectWithin(r, best_rect))
+            {
+                p_wgt_at = p_wgt;
+                best_rect = r;
+                wgtRect = r;
+
+                // visible and clickable widget found?
+                if (stop_searching)
+                    break;
+            }
+        }
+    }
+
+    return p_wgt_at;
+}
+
+template <class S>
+void setCursorAt(CallCtxT<S> &ctx, const Widget *pWgt)
+{
+    if (!pWgt)
+        return;
+
+    Coord coord = getScreenCoord(ctx, pWgt);
+
+    switch (pWgt->type)
+    {
+    case Widget::TextEdit:
+        if (isSameWidget(ctx, pWgt, g_ws.textEditState.pWgt))
+        {
+            const int16_t max_w = pWgt->size.width-3;
+            coord.col += g_ws.textEditState.cursorPos;
+            auto cursor_pos = g_ws.textEditState.cursorPos;
+            auto delta = (max_w/2);
+            while (cursor_pos >= max_w-1)
+            {
+                coord.col -= delta;
+                cursor_pos -= delta;
+            }
+        }
+        else
+        {
+            coord.col += pWgt->size.width-2;
+        }
+        break;
+    case Widget::CheckBox:
+        coord.col += 1;
+        break;
+    case Widget::Radio:
+        coord.col += 1;
+        break;
+    case Widget::Button:
+        switch (pWgt->button.style)
+        {
+        case ButtonStyle::Simple:
+            coord.col += 2;
+            break;
+        case ButtonStyle::Solid:
+            coord.col += 1;
+            break;
+        case ButtonStyle::Solid1p5:
+            coord.col += 1;
+            coord.row += 1;
+            break;
+        default:
+            break;
+        }
+        break;
+    case Widget::PageCtrl:
+        coord.row += 1 + pWgt->pagectrl.vertOffs;
+        coord.row += ctx.pState->getPageCtrlPageIndex(pWgt);
+        break;
+    case Widget::ListBox:
+    {
+        int16_t idx = 0, selidx = 0, cnt = 0;
+        const uint8_t frame_size = !pWgt->listbox.noFrame;
+        ctx.pState->getListBoxState(pWgt, idx, selidx, cnt);
+
+        int page_size = pWgt->size.height - (frame_size * 2);
+        int row = selidx % page_size;
+
+        coord.col += frame_size;
+        coord.row += frame_size + row;
+        break;
+    }
+    case Widget::ComboBox:
+        break;
+    case Widget::TextBox:
+        break;
+    default:
+        break;
+    }
+
+    moveTo(coord.col, coord.row);
+}
+
+template <class S>
+bool isVisible(CallCtxT<S> &ctx, const Widget *pWgt)
+{
+    bool vis = ctx.pState->isVisible(pWgt);
+    int parent_idx = pWgt->link.parentIdx;
+
+    for (; vis;)
+    {
+        WidgetPtr p_parent = ctx.at(parent_idx);
+        vis &= ctx.pState->isVisible(p_parent);
+
+        if (parent_idx == 0)
+            break;
+
+        parent_idx = p_parent->link.parentIdx;
+    }
+
+    return vis;
+}
+
+template <class S>
+bool isEnabled(CallCtxT<S> &ctx, const Widget *pWgt)
+{
+    bool en = ctx.pState->isEnabled(pWgt);
+    int parent_idx = pWgt->link.parentIdx;
+
+    for (; en;)
+    {
+        WidgetPtr p_parent = ctx.at(parent_idx);
+        en &= ctx.pState->isEnabled(p_parent);
+
+        if (parent_idx == 0)
+            break;
+
+        parent_idx = p_parent->link.parentIdx;
+    }
+
+    return en;
+}
+
+// -----------------------------------------------------------------------------
+
+template <class S>
+void invalidateRadioGroup(CallCtxT<S> &ctx, const Widget *pRadio)
+{
+    WidgetPtr p_parent = ctx.parentOf(pRadio);
+    const auto group_id = pRadio->radio.groupId;
+
+    for (unsigned i = 0; i < p_parent->link.childrenCnt; i++)
+    {
+        WidgetPtr p_wgt = ctx.at(p_parent->link.childrenIdx + i);
+        if (p_wgt->type == Widget::Type::Radio && p_wgt->radio.groupId == group_id)
+            ctx.pState->invalidate(p_wgt->id);
+    }
+}
+
+template <class S>
+bool isFocusable(CallCtxT<S> &ctx, const Widget *pWgt)
+{
+    if (!pWgt)
+        return false;
+
+    switch (pWgt->type)
+    {
+    case Widget::TextEdit:
+    case Widget::CheckBox:
+    case Widget::Radio:
+    case Widget::Button:
+    //case Widget::PageCtrl:
+    case Widget::ListBox:
+    case Widget::ComboBox:
+    case Widget::TextBox:
+        return isEnabled(ctx, pWgt);
+    default:
+        return false;
+    }
+}
+
+template <class S>
+bool isFocusable(CallCtxT<S> &ctx, const WID widgetId)
+{
+    if (WidgetPtr p_wgt = getWidgetByWID(ctx, widgetId))
+        return isFocusable(ctx, p_wgt);
+    return false;
+}
+
+template <class S>
+WidgetPtr getNextFocusable(CallCtxT<S> &ctx, WidgetPtr pParent, WID focusedID, bool forward, int firstParentIdx = -1, bool *pBreak = nullptr)
+{
+    bool brk = false;
+
+    if (!pParent)
+        return nullptr;
+
+    if (pParent->link.ownIdx == firstParentIdx)
+    {
+        // TWINS_LOG_E("full loop detected (firstParentIdx=%d)", firstParentIdx);
+        if (pBreak) *pBreak = true;
+        return nullptr;
+    }
+
+    if (pParent->id == focusedID)
+        return nullptr;
+
+    int children_idx = -1;
+    uint16_t child_cnt = 0;
+
+    // get childrens and their number
+    switch (pParent->type)
+    {
+    case Widget::Window:
+    case Widget::Panel:
+    case Widget::Page:
+    case Widget::Layer:
+    {
+        children_idx = pParent->link.childrenIdx;
+        child_cnt = pParent->link.childrenCnt;
+        break;
+    }
+    case Widget::PageCtrl:
+    {
+        // get selected page childrens
+        int idx = ctx.pState->getPageCtrlPageIndex(pParent);
+        if (idx >= 0 && idx < pParent->link.childrenCnt)
+        {
+            pParent   = ctx.at(pParent->link.childrenIdx + idx);
+            children_idx = pParent->link.childrenIdx;
+            child_cnt = pParent->link.childrenCnt;
+        }
+        else
+        {
+            return nullptr;
+        }
+        break;
+    }
+    default:
+        TWINS_LOG_E("Not a parent type widget");
+        return nullptr;
+    }
+
+    if (child_cnt == 0)
+        return nullptr;
+
+    switch (pParent->type)
+    {
+    case Widget::Page:
+    case Widget::Panel:
+    case Widget::Layer:
+        if (firstParentIdx < 0)
+        {
+            // it must be Panel/Page/Layer because while traversing we never step below Page level
+            // TWINS_LOG_D("1st parent[%s id:%u]", toString(pParent->type), pParent->id);
+            firstParentIdx = pParent->link.ownIdx;
+        }
+        break;
+    default:
+        break;
+    }
+
+    assert(children_idx >= 0);
+    int wgt_idx = -1;
+    WidgetPtr p_wgt;
+
+    // TWINS_LOG_D("pParent[%s id:%u] focusedId=%d", toString(pParent->type), pParent->id, focusedID); twins::sleepMs(200);
+
+    if (focusedID == WIDGET_ID_NONE)
+    {
+        // get first/last of the children ID
+        wgt_idx = forward ? children_idx : children_idx + child_cnt - 1;
+        p_wgt = ctx.at(wgt_idx);
+        focusedID = p_wgt->id;
+
+        if (isFocusable(ctx, p_wgt) && isVisible(ctx, p_wgt))
+            return p_wgt;
+
+        if (isParent(p_wgt))
+        {
+            if (WidgetPtr p = getNextFocusable(ctx, p_wgt, WIDGET_ID_NONE, forward, firstParentIdx, pBreak))
+                return p;
+        }
+    }
+    else
+    {
+        // get index of focusedID
+        wgt_idx = children_idx;
+
+        while (wgt_idx < children_idx + child_cnt && ctx.at(wgt_idx)->id != focusedID)
+            wgt_idx++;
+
+        // expect that children have focusedID
+        //assert(wgt_idx < children_idx + child_cnt); // occures rarely
+        if (wgt_idx >= children_idx + child_cnt)
+        {
+            TWINS_LOG_W("Focused ID=%d not found on parent ID=%d", focusedID, pParent->id);
+            return nullptr;
+        }
+    }
+
+
+    // TWINS_LOG_D("search in [%s id:%d children:%d]", toString(pParent->type), pParent->id, child_cnt);
+    // iterate until focusable found or children border reached
+    assert(wgt_idx >= 0);
+
+    for (uint16_t i = 0; i < child_cnt; i++)
+    {
+        wgt_idx += forward ? 1 : -1;
+
+        if (wgt_idx == children_idx + child_cnt || wgt_idx == children_idx - 1)
+        {
+            // border reached: if we are on Panel or Layer, jump to next sibling
+            if (pParent->type == Widget::Panel || pParent->type == Widget::Layer)
+                return getNextFocusable(ctx, ctx.parentOf(pParent), pParent->id, forward, firstParentIdx);
+
+            if (wgt_idx > children_idx) wgt_idx = children_idx;
+            else                        wgt_idx = children_idx + child_cnt - 1;
+        }
+
+        p_wgt = ctx.at(wgt_idx);
+
+        if (isFocusable(ctx, p_wgt) && isVisible(ctx, p_wgt))
+            return p_wgt;
+
+        if (isParent(p_wgt))
+        {
+            if (!pBreak)
+                pBreak = &brk;
+            if (WidgetPtr p = getNextFocusable(ctx, p_wgt, WIDGET_ID_NONE, forward, firstParentIdx, pBreak))
+                return p;
+            if (*pBreak)
+                break;
+        }
+    }
+
+    return nullptr;
+}
+
+template <class S>
+bool isInFocusScope(CallCtxT<S> &ctx, const Widget *pWgt, uint16_t scopeIdx)
+{
+    // go up to the scope widget; only selected Page of every PageCtrl on the way is reachable
+    for (WidgetPtr p_wgt = pWgt; p_wgt->link.ownIdx != scopeIdx; p_wgt = ctx.parentOf(p_wgt))
+    {
+        if (p_wgt->link.ownIdx == 0)
+            return false;
+
+        if (p_wgt->type == Widget::Page)
+        {
+            WidgetPtr p_pgctrl = ctx.parentOf(p_wgt);
+            if (p_wgt->link.ownIdx - p_pgctrl->link.childrenIdx != ctx.pState->getPageCtrlPageIndex(p_pgctrl))
+                return false;
+        }
+    }
+
+    return true;
+}
+
+template <class S>
+bool getNextFocusableFromTable(CallCtxT<S> &ctx, const FocusEntry *pFocusOrder, const WID focusedID, bool forward, WID &nextID)
+{
+    int n_entries = 0;
+    int focused_pos = -1;
+
+    for (; pFocusOrder[n_entries].wgtIdx; n_entries++)
+        if (ctx.at(pFocusOrder[n_entries].wgtIdx)->id == focusedID)
+            focused_pos = n_entries;
+
+    // focused widget is not focusable (Window, Panel...) - let the tree walk handle it
+    if (focused_pos < 0)
+        return false;
+
+    const auto scope_idx = pFocusOrder[focused_pos].scopeIdx;
+    // neighbour entries usually share the parent - evaluate parent chain only once per parent
+    int parent_idx = -1;
+    bool parent_ok = false;
+    nextID = WIDGET_ID_NONE;
+
+    for (int i = 1; i <= n_entries; i++)
+    {
+        int pos = focused_pos + (forward ? i : -i);
+        if (pos >= n_entries) pos -= n_entries;
+        if (pos < 0)          pos += n_entries;
+
+        WidgetPtr p_wgt = ctx.at(pFocusOrder[pos].wgtIdx);
+
+        if (p_wgt->link.parentIdx != parent_idx)
+        {
+            parent_idx = p_wgt->link.parentIdx;
+            WidgetPtr p_parent = ctx.at(parent_idx);
+            parent_ok = isInFocusScope(ctx, p_parent, scope_idx) && isEnabled(ctx, p_parent) && isVisible(ctx, p_parent);
+        }
+
+        if (parent_ok && ctx.pState->isEnabled(p_wgt) && ctx.pState->isVisible(p_wgt))
+        {
+            nextID = p_wgt->id;
+            break;
+        }
+    }
+
+    return true;
+}
+
+template <class S>
+WID getNextToFocus(CallCtxT<S> &ctx, const WID focusedID, bool forward)
+{
+    if (const auto *p_focus_order = ctx.pState->getFocusOrder())
+    {
+        WID next_id;
+        if (getNextFocusableFromTable(ctx, p_focus_order, focusedID, forward, next_id))
+            return next_id;
+    }
+
+    WidgetSearchStruct wss { searchedID : focusedID };
+
+    if (!getWidgetWSS(ctx, wss))
+    {
+        // here, find may fail only if invalid focusedID was given
+        wss.pWidget = ctx.pWindow;
+    }
+
+    // use the parent to get next widget
+    if (WidgetPtr p_next = getNextFocusable(ctx, ctx.parentOf(wss.pWidget), focusedID, forward))
+    {
+        return p_next->id;
+    }
+
+    return WIDGET_ID_NONE;
+}
+
+template <class S>
+WID getParentToFocus(CallCtxT<S> &ctx, WID focusedID)
+{
+    if (focusedID == WIDGET_ID_NONE)
+        return ctx.pWindow->id;
+
+    WidgetSearchStruct wss { searchedID : focusedID };
+
+    if (getWidgetWSS(ctx, wss))
+    {
+        WidgetPtr p_wgt = ctx.parentOf(wss.pWidget);
+        // g_ds.parentCoord -= wss.pWidget->coord;
+        return p_wgt->id;
+    }
+
+    return ctx.pWindow->id;
+}
+
+template <class S>
+bool changeFocusTo(CallCtxT<S> &ctx, WID newID)
+{
+    auto &curr_id = ctx.pState->getFocusedID();
+    // TWINS_LOG_D("curr_id=%d, newID=%d", curr_id, newID);
+
+    if (newID != curr_id)
+    {
+        auto prev_id = curr_id;
+        curr_id = newID;
+        WidgetSearchStruct wss { searchedID : newID };
+
+        if (getWidgetWSS(ctx, wss))
+        {
+            if (wss.pWidget->type == Widget::ListBox)
+            {
+                int16_t idx = 0, selidx = 0, cnt = 0;
+                ctx.pState->getListBoxState(wss.pWidget, idx, selidx, cnt);
+
+                if (idx < 0 && cnt > 0)
+                {
+                    ctx.pState->onListBoxSelect(wss.pWidget, selidx);
+                }
+            }
+        }
+
+        if (isFocusable(ctx, prev_id))
+            ctx.pState->invalidate(prev_id);
+
+        if (isFocusable(ctx, newID))
+            ctx.pState->invalidate(newID);
+
+        setCursorAt(ctx, wss.pWidget);
+        g_ws.pFocusedWgt = wss.pWidget;
+        return true;
+    }
+
+    return false;
+}
+
+template <class S>
+WidgetPtr findMainPgControl(CallCtxT<S> &ctx)
+{
+    const Widget *p_wnd = ctx.pWindow;
+
+    for (unsigned i = 0; i < p_wnd->link.childrenCnt; i++)
+    {
+        WidgetPtr p_wgt = ctx.at(p_wnd->link.childrenIdx + i);
+
+        if (p_wgt->type == Widget::PageCtrl)
+            return p_wgt;
+    }
+
+    return nullptr;
+}
+
+template <class S>
+void pgControlChangePage(CallCtxT<S> &ctx, const Widget *pWgt, bool next, int steps = 1)
+{
+    if (!pWgt) return;
+    assert(pWgt->type == Widget::PageCtrl);
+
+    int idx = ctx.pState->getPageCtrlPageIndex(pWgt);
+
+    while (steps-- > 0)
+    {
+        idx += next ? 1 : -1;
+        if (idx < 0)                     idx = pWgt->link.childrenCnt -1;
+        if (idx >= pWgt->link.childrenCnt) idx = 0;
+    }
+
+    // changeFocusTo(ctx, pWgt->id); // DON'T or separate focus for each Tab will not work
+    ctx.pState->onPageControlPageChange(pWgt, idx);
+    ctx.pState->invalidate(pWgt->id);
+
+    // cancel EDIT mode
+    g_ws.textEditState.pWgt = nullptr;
+
+    if (WidgetPtr p_wgt = getWidgetByWID(ctx, ctx.pState->getFocusedID()))
+    {
+        // TWINS_LOG_D("focused id=%d (%s)", p_wgt->id, toString(p_wgt->type));
+        g_ws.pFocusedWgt = p_wgt;
+        setCursorAt(ctx, p_wgt);
+    }
+    else
+    {
+        g_ws.pFocusedWgt = nullptr;
+        moveToHome();
+    }
+}
+
+template <class S>
+void comboBoxHideList(CallCtxT<S> &ctx, const Widget *pWgt)
+{
+    assert(pWgt);
+    assert(pWgt->type == Widget::ComboBox);
+
+    ctx.pState->onComboBoxDrop(pWgt, false);
+    // redraw parent to hide list
+    WidgetPtr p_parent = ctx.parentOf(pWgt);
+    ctx.pState->invalidate(p_parent->id);
+    g_ws.pCbxDropDown = nullptr;
+}
+
+// -----------------------------------------------------------------------------
+
+template <class S>
+bool processKey_TextEdit(CallCtxT<S> &ctx, const Widget *pWgt, const KeyCode &kc)
+{
+    if (isSameWidget(ctx, pWgt, g_ws.textEditState.pWgt))
+    {
+        // if in edit state, allow user to handle key
+        if (ctx.pState->onTextEditInputEvt(pWgt, kc, g_ws.textEditState.txt, g_ws.textEditState.cursorPos))
+        {
+            ctx.pState->invalidate(pWgt->id);
+            return true;
+        }
+        // user let us continue checking the key
+    }
+
+    bool key_handled = false;
+
+    if (g_ws.textEditState.pWgt)
+    {
+        auto cursor_pos = g_ws.textEditState.cursorPos;
+
+        if (kc.m_spec)
+        {
+            switch (kc.key)
+            {
+            case Key::Esc:
+                // cancel editing
+                g_ws.textEditState.pWgt = nullptr;
+                ctx.pState->invalidate(pWgt->id);
+                key_handled = true;
+                break;
+            case Key::Tab:
+                // real TAB may have different widths and require extra processing
+                g_ws.textEditState.txt.insert(cursor_pos, "    ");
+                cursor_pos += 4;
+                ctx.pState->invalidate(pWgt->id);
+                key_handled = true;
+                break;
+            case Key::Enter:
+                // finish editing
+                ctx.pState->onTextEditChange(pWgt, std::move(g_ws.textEditState.txt));
+                g_ws.textEditState.pWgt = nullptr;
+                ctx.pState->invalidate(pWgt->id);
+                key_handled = true;
+                break;
+            case Key::Backspace:
+                if (cursor_pos > 0)
+                {
+                    if (kc.m_ctrl)
+                    {
+                        g_ws.textEditState.txt.erase(0, cursor_pos);
+                        cursor_pos = 0;
+                    }
+                    else
+                    {
+                        g_ws.textEditState.txt.erase(cursor_pos-1);
+                        cursor_pos--;
+                    }
+                    ctx.pState->invalidate(pWgt->id);
+                }
+                key_handled = true;
+                break;
+            case Key::Delete:
+                if (kc.m_ctrl)
+                    g_ws.textEditState.txt.trim(cursor_pos);
+                else
+                    g_ws.textEditState.txt.erase(cursor_pos);
+
+                key_handled = true;
+                ctx.pState->invalidate(pWgt->id);
+                break;
+            case Key::Up:
+            case Key::Down:
+                break;
+            case Key::Left:
+                if (cursor_pos > 0)
+                {
+                    cursor_pos --;
+                    ctx.pState->invalidate(pWgt->id);
+                }
+                key_handled = true;
+                break;
+            case Key::Right:
+                if (cursor_pos < (signed)g_ws.textEditState.txt.u8len())
+                {
+                    cursor_pos++;
+                    ctx.pState->invalidate(pWgt->id);
+                }
+                key_handled = true;
+                break;
+            case Key::Home:
+                cursor_pos = 0;
+                ctx.pState->invalidate(pWgt->id);
+                key_handled = true;
+                break;
+            case Key::End:
+                cursor_pos = g_ws.textEditState.txt.u8len();
+                ctx.pState->invalidate(pWgt->id);
+                key_handled = true;
+                break;
+            case Key::Paste:
+                if (kc.paste.size)
+                {
+                    // single line editor: line breaks and tabs become spaces, other control codes are dropped
+                    String txt;
+                    txt.reserve(kc.paste.size);
+
+                    for (unsigned i = 0; i < kc.paste.size; i++)
+                    {
+                        const char c = kc.paste.data[i];
+
+                        if (c == '\r' && i + 1 < kc.paste.size && kc.paste.data[i+1] == '\n')
+                            continue;
+
+                        if (c == '\r' || c == '\n' || c == '\t')
+                            txt.append(' ');
+                        else if ((uint8_t)c >= ' ' && c != 0x7F)
+                            txt.append(c);
+                    }
+
+                    g_ws.textEditState.txt.insert(cursor_pos, txt.cstr());
+                    cursor_pos += txt.u8len();
+                    ctx.pState->invalidate(pWgt->id);
+                }
+                key_handled = true;
+                break;
+            default:
+                break;
+            }
+        }
+        else
+        {
+            g_ws.textEditState.txt.insert(cursor_pos, kc.utf8);
+            cursor_pos++;
+            ctx.pState->invalidate(pWgt->id);
+            key_handled = true;
+        }
+
+        g_ws.textEditState.cursorPos = cursor_pos;
+    }
+    else if (kc.key == Key::Enter)
+    {
+        // enter edit mode
+        g_ws.textEditState.pWgt = ctx.keep(pWgt);
+        g_ws.textEditState.txt.clear();
+        ctx.pState->getTextEditText(pWgt, g_ws.textEditState.txt, true);
+        g_ws.textEditState.cursorPos = g_ws.textEditState.txt.u8len();
+        ctx.pState->invalidate(pWgt->id);
+        key_handled = true;
+    }
+
+    return key_handled;
+}
+
+template <class S>
+bool processKey_CheckBox(CallCtxT<S> &ctx, const Widget *pWgt, const KeyCode &kc)
+{
+    if (kc.mod_all == KEY_MOD_NONE && kc.utf8[0] == ' ')
+    {
+        ctx.pState->onCheckboxToggle(pWgt);
+        ctx.pState->invalidate(pWgt->id);
+        return true;
+    }
+
+    if (kc.key == Key::Enter)
+    {
+        ctx.pState->onCheckboxToggle(pWgt);
+        ctx.pState->invalidate(pWgt->id);
+        return true;
+    }
+
+    return false;
+}
+
+template <class S>
+bool processKey_Radio(CallCtxT<S> &ctx, const Widget *pWgt, const KeyCode &kc)
+{
+    if (kc.mod_all == KEY_MOD_NONE && kc.utf8[0] == ' ')
+    {
+        ctx.pState->onRadioSelect(pWgt);
+        invalidateRadioGroup(ctx, pWgt);
+        return true;
+    }
+
+    if (kc.key == Key::Enter)
+    {
+        ctx.pState->onRadioSelect(pWgt);
+        invalidateRadioGroup(ctx, pWgt);
+        return true;
+    }
+
+    return false;
+}
+
+template <class S>
+bool processKey_Button(CallCtxT<S> &ctx, const Widget *pWgt, const KeyCode &kc)
+{
+    auto *p_wstate = ctx.pState;
+
+    if (p_wstate->onButtonKey(pWgt, kc))
+    {
+        // user handled the keyboard event
+        return true;
+    }
+
+    if (kc.key == Key::Enter)
+    {
+        // pointer may change between onButtonUp and onButtonClick, so remember it
+        g_ws.pMouseDownWgt = ctx.keep(pWgt);
+        p_wstate->onButtonDown(pWgt, kc);
+        p_wstate->invalidate(pWgt->id, true);
+        sleepMs(50);
+        g_ws.pMouseDownWgt = nullptr;
+        p_wstate->onButtonUp(pWgt, kc);
+        p_wstate->onButtonClick(pWgt, kc);
+        p_wstate->invalidate(pWgt->id);
+        return true;
+    }
+
+    return false;
+}
+
+template <class S>
+bool processKey_PageCtrl(CallCtxT<S> &ctx, const Widget *pWgt, const KeyCode &kc)
+{
+    if (kc.key == Key::PgDown || kc.key == Key::PgUp ||
+        kc.key == Key::F11 || kc.key == Key::F12)
+    {
+        pgControlChangePage(ctx, pWgt, kc.key == Key::PgDown || kc.key == Key::F12, kc.repeatCount());
+        return true;
+    }
+
+    return false;
+}
+
+template <class S>
+bool processKey_ListBox(CallCtxT<S> &ctx, const Widget *pWgt, const KeyCode &kc)
+{
+    int delta = 0;
+    const uint16_t items_visible = pWgt->size.height-2;
+
+    switch (kc.key)
+    {
+    case Key::Enter:
+    {
+        int16_t idx = 0, selidx = 0, cnt = 0;
+        ctx.pState->getListBoxState(pWgt, idx, selidx, cnt);
+        if (cnt > 0)
+        {
+            if (selidx >= 0 && selidx != idx)
+                ctx.pState->onListBoxChange(pWgt, selidx);
+            ctx.pState->invalidate(pWgt->id);
+        }
+        return true;
+    }
+    case Key::Up:
+        delta = kc.mod_all == KEY_MOD_SPECIAL ? -1 : 0;
+        break;
+    case Key::Down:
+        delta = kc.mod_all == KEY_MOD_SPECIAL ? 1 : 0;
+        break;
+    case Key::PgUp:
+        delta = kc.mod_all == KEY_MOD_SPECIAL ? -items_visible : 0;
+        break;
+    case Key::PgDown:
+        delta = kc.mod_all == KEY_MOD_SPECIAL ? items_visible : 0;
+        break;
+    default:
+        break;
+    }
+
+    if (delta != 0)
+    {
+        int16_t idx = 0, selidx = 0, cnt = 0;
+        ctx.pState->getListBoxState(pWgt, idx, selidx, cnt);
+
+        if (cnt > 0)
+        {
+            selidx = moveSelection(selidx, delta, kc.repeatCount(), cnt);
+            ctx.pState->onListBoxSelect(pWgt, selidx);
+            ctx.pState->invalidate(pWgt->id);
+        }
+        return true;
+    }
+
+    return false;
+}
+
+template <class S>
+bool processKey_ComboBox(CallCtxT<S> &ctx, const Widget *pWgt, const KeyCode &kc)
+{
+    int16_t idx = 0, selidx = 0, cnt = 0; bool drop_down = false;
+    ctx.pState->getComboBoxState(pWgt, idx, selidx, cnt, drop_down);
+
+    if (kc.utf8[0] == ' ')
+    {
+        if (cnt > 0)
+        {
+            drop_down = !drop_down;
+
+            if (drop_down)
+            {
+                ctx.pState->onComboBoxDrop(pWgt, true);
+                g_ws.pCbxDropDown = ctx.keep(pWgt);
+            }
+            else
+            {
+                comboBoxHideList(ctx, pWgt);
+            }
+        }
+    }
+    else if (kc.key == Key::Esc)
+    {
+        comboBoxHideList(ctx, pWgt);
+    }
+    else if (drop_down)
+    {
+        if (kc.key == Key::Up)
+        {
+            selidx = moveSelection(selidx, -1, kc.repeatCount(), cnt);
+            ctx.pState->onComboBoxSelect(pWgt, selidx);
+        }
+        else if (kc.key == Key::Down)
+        {
+            selidx = moveSelection(selidx, 1, kc.repeatCount(), cnt);
+            ctx.pState->onComboBoxSelect(pWgt, selidx);
+        }
+        else if (kc.key == Key::PgUp && kc.mod_all == KEY_MOD_SPECIAL)
+        {
+            selidx = moveSelection(selidx, -pWgt->combobox.dropDownSize, kc.repeatCount(), cnt);
+            ctx.pState->onComboBoxSelect(pWgt, selidx);
+        }
+        else if (kc.key == Key::PgDown && kc.mod_all == KEY_MOD_SPECIAL)
+        {
+            selidx = moveSelection(selidx, pWgt->combobox.dropDownSize, kc.repeatCount(), cnt);
+            ctx.pState->onComboBoxSelect(pWgt, selidx);
+        }
+        else if (kc.key == Key::Enter)
+        {
+            ctx.pState->onComboBoxChange(pWgt, selidx);
+            comboBoxHideList(ctx, pWgt);
+        }
+        else
+        {
+            return false;
+        }
+    }
+    else
+    {
+        return false;
+    }
+
+    ctx.pState->invalidate(pWgt->id);
+    return true;
+}
+
+template <class S>
+bool processKey_TextBox(CallCtxT<S> &ctx, const Widget *pWgt, const KeyCode &kc)
+{
+    int delta = 0;
+    const uint16_t lines_visible = pWgt->size.height - 2;
+
+    switch (kc.key)
+    {
+    case Key::Up:
+        delta = kc.mod_all == KEY_MOD_SPECIAL ? -1 : 0;
+        break;
+    case Key::Down:
+        delta = kc.mod_all == KEY_MOD_SPECIAL ? 1 : 0;
+        break;
+    case Key::PgUp:
+        delta = kc.mod_all == KEY_MOD_SPECIAL ? -lines_visible : 0;
+        break;
+    case Key::PgDown:
+        delta = kc.mod_all == KEY_MOD_SPECIAL ? lines_visible : 0;
+        break;
+    default:
+        break;
+    }
+
+    if (delta != 0)
+    {
+        const twins::Vector<twins::CStrView> *p_lines = nullptr;
+        int16_t top_line = 0;
+
+        ctx.pState->getTextBoxState(pWgt, &p_lines, top_line);
+
+        if (p_lines)
+        {
+            // scrolling is clamped, so repeated steps sum up
+            top_line += delta * kc.repeatCount();
+
+            if (top_line > (int)p_lines->size() - lines_visible)
+                top_line = p_lines->size() - lines_visible;
+
+            if (top_line < 0)
+                top_line = 0;
+
+            ctx.pState->onTextBoxScroll(pWgt, top_line);
+            ctx.pState->invalidate(pWgt->id);
+        }
+        return true;
+    }
+
+    return false;
+}
+
+template <class S>
+bool processKey(CallCtxT<S> &ctx, const KeyCode &kc)
+{
+    auto focused_id = ctx.pState->getFocusedID();
+    WidgetPtr p_wgt = getWidgetByWID(ctx, focused_id);
+    bool key_handled = false;
+
+    if (!p_wgt)
+        return false;
+
+    if (!isEnabled(ctx, p_wgt))
+        return true;
+
+    switch (p_wgt->type)
+    {
+    case Widget::TextEdit:
+        key_handled = processKey_TextEdit(ctx, p_wgt, kc);
+        break;
+    case Widget::CheckBox:
+        key_handled = processKey_CheckBox(ctx, p_wgt, kc);
+        break;
+    case Widget::Radio:
+        key_handled = processKey_Radio(ctx, p_wgt, kc);
+        break;
+    case Widget::Button:
+        key_handled = processKey_Button(ctx, p_wgt, kc);
+        break;
+    case Widget::PageCtrl:
+        key_handled = processKey_PageCtrl(ctx, p_wgt, kc);
+        break;
+    case Widget::ListBox:
+        key_handled = processKey_ListBox(ctx, p_wgt, kc);
+        break;
+    case Widget::ComboBox:
+        key_handled = processKey_ComboBox(ctx, p_wgt, kc);
+        break;
+    case Widget::TextBox:
+        key_handled = processKey_TextBox(ctx, p_wgt, kc);
+        break;
+    default:
+        break;
+    }
+
+    return key_handled;
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+
+template <class S>
+void processMouse_TextEdit(CallCtxT<S> &ctx, const Widget *pWgt, const Rect &wgtRect, const KeyCode &kc)
+{
+    if (kc.mouse.btn == MouseBtn::ButtonLeft)
+    {
+        changeFocusTo(ctx, pWgt->id);
+    }
+}
+
+template <class S>
+void processMouse_CheckBox(CallCtxT<S> &ctx, const Widget *pWgt, const Rect &wgtRect, const KeyCode &kc)
+{
+    if (kc.mouse.btn == MouseBtn::ButtonLeft)
+    {
+        changeFocusTo(ctx, pWgt->id);
+        ctx.pState->onCheckboxToggle(pWgt);
+        ctx.pState->invalidate(pWgt->id);
+    }
+}
+
+template <class S>
+void processMouse_Radio(CallCtxT<S> &ctx, const Widget *pWgt, const Rect &wgtRect, const KeyCode &kc)
+{
+    if (kc.mouse.btn == MouseBtn::ButtonLeft)
+    {
+        changeFocusTo(ctx, pWgt->id);
+        ctx.pState->onRadioSelect(pWgt);
+        invalidateRadioGroup(ctx, pWgt);
+    }
+}
+
+template <class S>
+void processMouse_Button(CallCtxT<S> &ctx, const Widget *pWgt, const Rect &wgtRect, const KeyCode &kc)
+{
+    // pointer may change between onButtonUp and onButtonClick, so remember it
+    auto *p_wstate = ctx.pState;
+
+    if (kc.mouse.btn == MouseBtn::ButtonLeft)
+    {
+        changeFocusTo(ctx, pWgt->id);
+        p_wstate->onButtonDown(pWgt, kc);
+        p_wstate->invalidate(pWgt->id);
+    }
+    else if (kc.mouse.btn == MouseBtn::ButtonReleased && isSameWidget(ctx, pWgt, g_ws.pMouseDownWgt))
+    {
+        p_wstate->onButtonUp(pWgt, kc);
+        p_wstate->onButtonClick(pWgt, g_ws.mouseDownKeyCode);
+        g_ws.pMouseDownWgt = nullptr;
+        p_wstate->invalidate(pWgt->id);
+    }
+    else
+    {
+        g_ws.pMouseDownWgt = nullptr;
+    }
+}
+
+template <class S>
+void processMouse_Button_Release(CallCtxT<S> &ctx, const Widget *pWgt, const KeyCode &kc)
+{
+    auto *p_wstate = ctx.pState;
+
+    p_wstate->onButtonUp(pWgt, kc);
+    g_ws.pMouseDownWgt = nullptr;
+    p_wstate->invalidate(pWgt->id);
+}
+
+template <class S>
+void processMouse_PageCtrl(CallCtxT<S> &ctx, const Widget *pWgt, const Rect &wgtRect, const KeyCode &kc)
+{
+    if (kc.mouse.btn == MouseBtn::ButtonLeft)
+    {
+        changeFocusTo(ctx, pWgt->id);
+        int idx = ctx.pState->getPageCtrlPageIndex(pWgt);
+        int new_idx = kc.mouse.row - wgtRect.coord.row - 1 - pWgt->pagectrl.vertOffs;
+
+        if (new_idx != idx && new_idx >= 0 && new_idx < pWgt->link.childrenCnt)
+        {
+            ctx.pState->onPageControlPageChange(pWgt, new_idx);
+            ctx.pState->invalidate(pWgt->id);
+        }
+    }
+    else if (kc.mouse.btn == MouseBtn::WheelUp || kc.mouse.btn == MouseBtn::WheelDown)
+    {
+        pgControlChangePage(ctx, pWgt, kc.mouse.btn == MouseBtn::WheelDown, kc.repeatCount());
+    }
+}
+
+template <class S>
+void processMouse_ListBox(CallCtxT<S> &ctx, const Widget *pWgt, const Rect &wgtRect, const KeyCode &kc)
+{
+    const uint16_t items_visible = pWgt->size.height-2;
+
+    if (kc.mouse.btn == MouseBtn::ButtonLeft || kc.mouse.btn == MouseBtn::ButtonMid)
+    {
+        bool focus_changed = changeFocusTo(ctx, pWgt->id);
+
+        int16_t idx = 0, selidx = 0, cnt = 0;
+        ctx.pState->getListBoxState(pWgt, idx, selidx, cnt);
+
+        if (cnt <= 0)
+            return;
+
+        int page = selidx / items_visible;
+        unsigned new_selidx = page * items_visible;
+        new_selidx += (int)kc.mouse.row - wgtRect.coord.row - 1;
+
+        if (kc.mouse.btn == MouseBtn::ButtonLeft)
+        {
+            if (new_selidx < (unsigned)cnt && (((signed)new_selidx != selidx) || focus_changed))
+            {
+                selidx = new_selidx;
+                ctx.pState->onListBoxSelect(pWgt, selidx);
+            }
+        }
+        else
+        {
+            if (new_selidx < (unsigned)cnt && new_selidx != (unsigned)idx)
+            {
+                selidx = new_selidx;
+                ctx.pState->onListBoxSelect(pWgt, selidx);
+                ctx.pState->onListBoxChange(pWgt, selidx);
+            }
+        }
+
+        ctx.pState->invalidate(pWgt->id);
+    }
+    else if (kc.mouse.btn == MouseBtn::WheelUp || kc.mouse.btn == MouseBtn::WheelDown)
+    {
+        changeFocusTo(ctx, pWgt->id);
+
+        int16_t idx = 0, selidx = 0, cnt = 0;
+        ctx.pState->getListBoxState(pWgt, idx, selidx, cnt);
+
+        if (cnt <= 0)
+            return;
+
+        int delta = kc.mouse.btn == MouseBtn::WheelUp ? -1 : 1;
+        if (kc.m_ctrl) delta *= items_visible;
+        selidx = moveSelection(selidx, delta, kc.repeatCount(), cnt);
+        ctx.pState->onListBoxSelect(pWgt, selidx);
+        ctx.pState->invalidate(pWgt->id);
+    }
+}
+
+template <class S>
+void processMouse_ComboBox(CallCtxT<S> &ctx, const Widget *pWgt, const Rect &wgtRect, const KeyCode &kc)
+{
+    if (kc.mouse.btn == MouseBtn::ButtonLeft)
+    {
+        changeFocusTo(ctx, pWgt->id);
+
+        auto col = kc.mouse.col - wgtRect.coord.col;
+        auto row = kc.mouse.row - wgtRect.coord.row - 1;
+
+        if (row >= 0 && row < pWgt->combobox.dropDownSize)
+        {
+            int16_t idx = 0, selidx = 0, cnt = 0; bool drop_down = false;
+            ctx.pState->getComboBoxState(pWgt, idx, selidx, cnt, drop_down);
+            selidx = (selidx / pWgt->combobox.dropDownSize) * pWgt->combobox.dropDownSize; // top item
+            selidx += row;
+            if (selidx < cnt)
+            {
+                ctx.pState->onComboBoxSelect(pWgt, selidx);
+                ctx.pState->invalidate(pWgt->id);
+            }
+        }
+        else if (col >= wgtRect.size.width - 3 && col <= wgtRect.size.width - 1)
+        {
+            // drop down arrow clicked
+            int16_t _, cnt = 0; bool drop_down = false;
+            ctx.pState->getComboBoxState(pWgt, _, _, cnt, drop_down);
+
+            if (cnt <= 0)
+                return;
+
+            drop_down = !drop_down;
+
+            if (drop_down)
+            {
+                ctx.pState->onComboBoxDrop(pWgt, true);
+                ctx.pState->invalidate(pWgt->id);
+                g_ws.pCbxDropDown = ctx.keep(pWgt);
+            }
+            else
+            {
+                comboBoxHideList(ctx, pWgt);
+            }
+        }
+    }
+    else if (kc.mouse.btn == MouseBtn::WheelUp || kc.mouse.btn == MouseBtn::WheelDown)
+    {
+        changeFocusTo(ctx, pWgt->id);
+
+        int16_t idx = 0, selidx = 0, cnt = 0; bool drop_down = false;
+        ctx.pState->getComboBoxState(pWgt, idx, selidx, cnt, drop_down);
+
+        if (!drop_down || cnt <= 0)
+            return;
+
+        int delta = kc.mouse.btn == MouseBtn::WheelUp ? -1 : 1;
+        if (kc.m_ctrl) delta *= pWgt->combobox.dropDownSize;
+        selidx = moveSelection(selidx, delta, kc.repeatCount(), cnt);
+        ctx.pState->onComboBoxSelect(pWgt, selidx);
+        ctx.pState->invalidate(pWgt->id);
+    }
+    else if (kc.mouse.btn == MouseBtn::ButtonMid)
+    {
+        twins::KeyCode key_left = kc;
+        key_left.mouse.btn = MouseBtn::ButtonLeft;
+        processMouse_ComboBox(ctx, pWgt, wgtRect, key_left);
+
+        int16_t _, selidx = 0; bool drop_down = false;
+        ctx.pState->getComboBoxState(pWgt, _, selidx, _, drop_down);
+
+        if (!drop_down)
+            return;
+
+        ctx.pState->onComboBoxChange(pWgt, selidx);
+        comboBoxHideList(ctx, pWgt);
+    }
+}
+
+template <class S>
+void processMouse_CustomWgt(CallCtxT<S> &ctx, const Widget *pWgt, const Rect &wgtRect, const KeyCode &kc)
+{
+    ctx.pState->onCustomWidgetInputEvt(pWgt, kc);
+}
+
+template <class S>
+void processMouse_TextBox(CallCtxT<S> &ctx, const Widget *pWgt, const Rect &wgtRect, const KeyCode &kc)
+{
+    changeFocusTo(ctx, pWgt->id);
+
+    if (kc.mouse.btn == MouseBtn::WheelUp || kc.mouse.btn == MouseBtn::WheelDown)
+    {
+        const twins::Vector<twins::CStrView> *p_lines = nullptr;
+        int16_t top_line = 0;
+
+        ctx.pState->getTextBoxState(pWgt, &p_lines, top_line);
+
+        if (p_lines && p_lines->size())
+        {
+            int delta = (kc.mouse.btn == MouseBtn::WheelUp ? -1 : 1) * kc.repeatCount();
+            const uint16_t lines_visible = pWgt->size.height - 2;
+            if (kc.m_ctrl) delta *= lines_visible;
+
+            top_line += delta;
+
+            if (top_line > (int)p_lines->size() - lines_visible)
+                top_line = p_lines->size() - lines_visible;
+
+            if (top_line < 0)
+                top_line = 0;
+
+            changeFocusTo(ctx, pWgt->id);
+            ctx.pState->onTextBoxScroll(pWgt, top_line);
+            ctx.pState->invalidate(pWgt->id);
+        }
+    }
+}
+
+template <class S>
+bool processMouse(CallCtxT<S> &ctx, const KeyCode &kc)
+{
+    if (kc.mouse.btn == MouseBtn::ButtonGoBack || kc.mouse.btn == MouseBtn::ButtonGoForward)
+    {
+        if (WidgetPtr p_wgt = findMainPgControl(ctx))
+        {
+            if (isEnabled(ctx, p_wgt))
+                pgControlChangePage(ctx, p_wgt, kc.mouse.btn == MouseBtn::ButtonGoForward);
+            return true;
+        }
+    }
+
+    Rect rct;
+    WidgetPtr p_wgt = getWidgetAt(ctx, kc.mouse.col, kc.mouse.row, rct);
+
+    // plain motion (SGRMotion mode) - no widget reacts to it yet, but it must not reset the clicked widget
+    if (kc.mouse.btn == MouseBtn::Motion)
+        return p_wgt != nullptr;
+
+    if (g_ws.pMouseDownWgt)
+    {
+        // apply only for Button widget
+        if (g_ws.pMouseDownWgt->type == Widget::Button)
+        {
+            // mouse button released over another widget - generate Up event for previously clicked button
+            if (kc.mouse.btn == MouseBtn::ButtonReleased && !isSameWidget(g_ws.pMouseDownWgt, p_wgt))
+            {
+                processMouse_Button_Release(ctx, g_ws.pMouseDownWgt, kc);
+                return true;
+            }
+        }
+    }
+    else if (p_wgt)
+    {
+        // remember clicked widget
+        if (kc.mouse.btn >= MouseBtn::ButtonLeft && kc.mouse.btn < MouseBtn::ButtonReleased)
+        {
+            g_ws.pMouseDownWgt = p_wgt;
+            g_ws.mouseDownKeyCode = kc;
+        }
+    }
+
+    if (!p_wgt)
+        return false;
+
+    // TWINS_LOG_D("WidgetAt(%2d:%2d)=%s ID:%u", kc.mouse.col, kc.mouse.row, toString(p_wgt->type), p_wgt->id);
+
+    if (g_ws.pCbxDropDown)
+    {
+        // check if drop-down list clicked
+        Rect dropdownlist_rct;
+        dropdownlist_rct.coord = getScreenCoord(ctx, g_ws.pCbxDropDown);
+        dropdownlist_rct.size.width = g_ws.pCbxDropDown->size.width;
+        dropdownlist_rct.size.height = g_ws.pCbxDropDown->combobox.dropDownSize + 1;
+
+        if (isPointWithin(kc.mouse.col, kc.mouse.row, dropdownlist_rct))
+        {
+            // yes -> replace data for processing with g_ds.pDropDownCombo
+            p_wgt = g_ws.pCbxDropDown;
+            rct.coord = getScreenCoord(ctx, g_ws.pCbxDropDown);
+            rct.size = g_ws.pCbxDropDown->size;
+        }
+        else
+        {
+            if (kc.mouse.btn == MouseBtn::ButtonLeft)
+                comboBoxHideList(ctx, g_ws.pCbxDropDown);
+        }
+    }
+
+    if (isEnabled(ctx, p_wgt))
+    {
+        switch (p_wgt->type)
+        {
+        case Widget::TextEdit:
+            processMouse_TextEdit(ctx, p_wgt, rct, kc);
+            break;
+        case Widget::CheckBox:
+            processMouse_CheckBox(ctx, p_wgt, rct, kc);
+            break;
+        case Widget::Radio:
+            processMouse_Radio(ctx, p_wgt, rct, kc);
+            break;
+        case Widget::Button:
+            processMouse_Button(ctx, p_wgt, rct, kc);
+            break;
+        case Widget::PageCtrl:
+            processMouse_PageCtrl(ctx, p_wgt, rct, kc);
+            break;
+        case Widget::ListBox:
+            processMouse_ListBox(ctx, p_wgt, rct, kc);
+            break;
+        case Widget::ComboBox:
+            processMouse_ComboBox(ctx, p_wgt, rct, kc);
+            break;
+        case Widget::CustomWgt:
+            processMouse_CustomWgt(ctx, p_wgt, rct, kc);
+            break;
+        case Widget::TextBox:
+            processMouse_TextBox(ctx, p_wgt, rct, kc);
+            break;
+        default:
+            moveToHome();
+            g_ws.pMouseDownWgt = nullptr;
+            return false;
+        }
+    }
+
+    if (kc.mouse.btn == MouseBtn::ButtonReleased)
+        g_ws.pMouseDownWgt = nullptr;
+
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+
+template <class S>
+bool processInputImpl(CallCtxT<S> &ctx, const KeyCode &kc)
+{
+    bool key_processed = false;
+
+    if (kc.key == Key::None)
+        return true;
+
+    // TWINS_LOG_D("---");
+
+    if (kc.key == Key::MouseEvent)
+    {
+        key_processed = processMouse(ctx, kc);
+    }
+    else
+    {
+        key_processed = processKey(ctx, kc);
+
+        if (!key_processed && kc.m_spec)
+        {
+            if (g_ws.pCbxDropDown)
+            {
+                comboBoxHideList(ctx, g_ws.pCbxDropDown);
+            }
+
+            switch (kc.key)
+            {
+            case Key::Esc:
+            {
+                auto curr_id = ctx.pState->getFocusedID();
+                auto new_id = getParentToFocus(ctx, curr_id);
+                key_processed = changeFocusTo(ctx, new_id);
+                break;
+            }
+            case Key::Tab:
+            {
+                auto curr_id = ctx.pState->getFocusedID();
+                auto new_id = getNextToFocus(ctx, curr_id, !kc.m_shift);
+                key_processed = changeFocusTo(ctx, new_id);
+                break;
+            }
+            default:
+                break;
+            }
+        }
+
+        if (!key_processed)
+            key_processed = ctx.pState->onWindowUnhandledInputEvt(ctx.pWindow, kc);
+    }
+
+    return key_processed;
+}
+
+// -----------------------------------------------------------------------------
+
+// instantiated once, in twins_widget.cpp
+extern template bool processInputImpl<IWindowState>(CallCtx &ctx, const KeyCode &kc);
+
+// -----------------------------------------------------------------------------
+
+}
@@ -8,64 +8,194 @@
 #pragma once
 #include "twins.hpp"
 #include "twins_string.hpp"
+#include "twins_vector.hpp"
 #include "twins_utf8str.hpp"
+#include "twins_arena.hpp"
+
+#include <assert.h>
+#include <new>
+
+/// @note Do not include this file directly!
 
 // -----------------------------------------------------------------------------
 
 namespace twins
 {
 
+/** @brief Rebuild the widget \p idx from the columns, the same as in the Widget array */
+void loadWidget(const WidgetColumns &cols, uint16_t idx, Widget &wgt);
+
+/**
+ * @brief Widget returned by the lookups: points to the Widget array entry,
+ *        or, for the window given as columns only, holds the widget rebuilt from the columns;
+ *        pointer obtained from it is valid as long as this object
+ */
+class WidgetPtr
+{
+public:
+    WidgetPtr(const Widget *pWgt = nullptr) : mpWgt(pWgt), mpColumns(nullptr) {}
+    WidgetPtr(const WidgetColumns &cols, uint16_t idx) : mpWgt(&mWgt), mpColumns(&cols), mWgt() { loadWidget(cols, idx, mWgt); }
+    WidgetPtr(const WidgetPtr &other) { *this = other; }
+
+    WidgetPtr& operator=(const WidgetPtr &other)
+    {
+        if (other.mpWgt == &other.mWgt)
+        {
+            new (&mWgt) Widget(other.mWgt);
+            mpWgt = &mWgt;
+        }
+        else
+        {
+            mpWgt = other.mpWgt;
+        }
+        mpColumns = other.mpColumns;
+        return *this;
+    }
+
+    operator const Widget*() const { return mpWgt; }
+    const Widget* operator->() const { return mpWgt; }
+
+    /** @brief Columns the widget was rebuilt from, or \b nullptr if it points to the Widget array */
+    const WidgetColumns* columns() const { return mpColumns; }
+
+private:
+    const Widget *mpWgt;
+    const WidgetColumns *mpColumns;
+    // constructed only when loaded from the columns
+    union { Widget mWgt; };
+};
+
+/** @brief Widgets of the window: the Widget array, the columns, or both */
+struct WidgetTable
+{
+    const Widget *  pWidgets = {};
+    const WidgetColumns *pColumns = {};
+
+    /** @brief Widget at \p idx of the window */
+    WidgetPtr at(uint16_t idx) const
+    {
+        if (pWidgets)
+            return WidgetPtr(pWidgets + idx);
+        return WidgetPtr(*pColumns, idx);
+    }
+
+    WidgetPtr parentOf(const Widget *pWgt) const
+    {
+        assert(pWgt->link.parentIdx <= pWgt->link.ownIdx);
+        return at(pWgt->link.parentIdx);
+    }
+
+    /** @brief Handle to be kept after \p pWgt, possibly a temporary copy, is gone */
+    WidgetPtr keep(const Widget *pWgt) const
+    {
+        if (!pWgt)
+            return nullptr;
+        return at(pWgt->link.ownIdx);
+    }
+};
+
 struct WidgetSearchStruct
 {
     WID   searchedID = {};      // given
     Coord parentCoord = {};     // expected
     bool  isVisible = true;     // expected
-    const Widget *pWidget = {}; // expected
+    WidgetPtr pWidget = {};     // expected
 };
 
-/** Widget drawing state object */
+/** Widget drawing state object; widgets are stored by value, as the window may have no Widget array */
 struct WidgetState
 {
     String strbuff;                     // common string buff for widget drawers
-    const Widget *pFocusedWgt = {};     //
-    const Widget *pMouseDownWgt = {};   //
-    const Widget *pCbxDropDown = {};
+    WidgetPtr     pFocusedWgt = {};     //
+    WidgetPtr     pMouseDownWgt = {};   //
+    WidgetPtr     pCbxDropDown = {};
     KeyCode       mouseDownKeyCode = {};
     struct                              // state of Edit being modified
     {
-        const Widget *pWgt = nullptr;
+        WidgetPtr pWgt = {};
         int16_t cursorPos = 0;
         String  txt;
     } textEditState;
+    struct                              // processInputBatch() in progress
+    {
+        IWindowState *pState = {};
+        Vector<WID> invalidated;
+        bool    stop = false;
+    } batch;
 };
 
-struct CallCtx
+/**
+ * @brief Widgets identity; the same widget may be held by different WidgetPtr copies,
+ *        so the widgets rebuilt from the columns are compared by the columns and index
+ */
+inline bool isSameWidget(const WidgetPtr &pWgt1, const WidgetPtr &pWgt2)
+{
+    if (!pWgt1 || !pWgt2)
+        return !pWgt1 && !pWgt2;
+    if (pWgt1.columns() || pWgt2.columns())
+        return pWgt1.columns() == pWgt2.columns() && pWgt1->link.ownIdx == pWgt2->link.ownIdx;
+    return (const Widget*)pWgt1 == (const Widget*)pWgt2;
+}
+
+/** @brief Check if \p pWgt of the \p wgts window is the one held in \p pHeld */
+inline bool isSameWidget(const WidgetTable &wgts, const Widget *pWgt, const WidgetPtr &pHeld)
 {
-    CallCtx(const Widget* pWindowWidgets)
+    if (!pWgt || !pHeld)
+        return !pWgt && !pHeld;
+    // widgets taken from the Widget array are never copied
+    if (wgts.pWidgets)
+        return pWgt == (const Widget*)pHeld;
+    return pHeld.columns() == wgts.pColumns && pHeld->link.ownIdx == pWgt->link.ownIdx;
+}
+
+/**
+ * @brief Context of the widgets processing;
+ *        \p S is either the IWindowState (virtual calls),
+ *        or the final window state class, so its methods are called directly
+ */
+template <class S>
+struct CallCtxT : WidgetTable
+{
+    CallCtxT(const Widget* pWindowWidgets, S *pWindowState)
     {
-        assert(pWindowWidgets);
-        assert(pWindowWidgets->type == Widget::Window);
+        assert(pWindowState);
         pWidgets = pWindowWidgets;
-        pState = pWindowWidgets->window.getState();
+        pState = pWindowState;
+        pColumns = pState->getWidgetColumns();
+        assert(pWidgets || pColumns);
+        assert(pWidgets ? pWidgets->type == Widget::Window : pColumns->pTypes[0] == Widget::Window);
+        pWindow = at(0);
     }
-    const Widget *  pWidgets = {};
-    IWindowState *  pState = {};
+
+    /** @brief State taken from the Window widget; IWindowState only */
+    CallCtxT(const Widget* pWindowWidgets) :
+        CallCtxT(pWindowWidgets, pWindowWidgets->window.getState())
+    {
+    }
+
+    S *             pState = {};
+    WidgetPtr       pWindow;     // the Window widget
     Coord           parentCoord; // current widget's parent left-top position
 };
 
+using CallCtx = CallCtxT<IWindowState>;
+
 extern WidgetState& g_ws;
 
 // -----------------------------------------------------------------------------
 
-const Widget* getWidgetByWID(CallCtx &ctx, const WID widgetId);
-const Widget* getWidgetAt(CallCtx &ctx, uint8_t col, uint8_t row, Rect &wgtRect);
-bool isVisible(CallCtx &ctx, const Widget *pWgt);
-bool isEnabled(CallCtx &ctx, const Widget *pWgt);
-
+/** @brief Parent in the Widget array; engine uses WidgetTable::parentOf() */
 const Widget* getParent(const Widget *pWgt);
+bool isParent(const Widget *pWgt);
+/** @brief Move \p selIdx by \p delta, \p repeat times; wraps around \p cnt items the same way separate key presses do */
+int16_t moveSelection(int selIdx, int delta, int repeat, int cnt);
 
-bool getWidgetWSS(CallCtx &ctx, WidgetSearchStruct &wss);
-void setCursorAt(CallCtx &ctx, const Widget *pWgt);
+ColorBG getWidgetBgColor(const WidgetTable &wgts, const Widget *pWgt);
+ColorFG getWidgetFgColor(const WidgetTable &wgts, const Widget *pWgt);
+void drawArea(const Coord coord, const Size size, ColorBG clBg, ColorFG clFg, const FrameStyle style, bool filled = true, bool shadow = false);
+void drawListScrollBarV(const Coord coord, int height, int max, int pos);
+/** @brief Returns \b true if any of the widget parents is on the sorted \p wgtIdxs list, thus will be drawn anyway */
+bool isAncestorListed(const WidgetTable &wgts, const Widget *pWgt, const FrameArray<uint16_t> &wgtIdxs);
 
 // -----------------------------------------------------------------------------
 
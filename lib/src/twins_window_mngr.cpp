@@ -17,6 +17,7 @@ namespace twins
 void WndManager::show(twins::IWindowState *pWnd, bool bringToTop)
 {
     int idx = -1;
+    twins::flushDeferredRedraw();
 
     if (mWindows.find(pWnd, &idx))
     {
@@ -33,20 +34,21 @@ void WndManager::show(twins::IWindowState *pWnd, bool bringToTop)
         }
         else
         {
-            twins::drawWidget(pWnd->getWidgets());
+            twins::drawWidget(*pWnd);
         }
     }
     else if (pWnd)
     {
         mWindows.append(pWnd);
         twins::resetInternalState();
-        twins::drawWidget(pWnd->getWidgets());
+        twins::drawWidget(*pWnd);
     }
 }
 
 void WndManager::hide(twins::IWindowState *pWnd)
 {
     int idx = -1;
+    twins::flushDeferredRedraw();
 
     if (mWindows.find(pWnd, &idx))
     {
@@ -78,7 +80,7 @@ void WndManager::redrawAll()
 {
     for (auto p_wnd : mWindows)
     {
-        twins::drawWidget(p_wnd->getWidgets());
+        twins::drawWidget(*p_wnd);
         // signal that invalidate list must be cleared
         p_wnd->invalidate(WIDGET_ID_NONE);
     }
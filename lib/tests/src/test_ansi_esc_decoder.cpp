@@ -8,6 +8,7 @@
 #include "gmock/gmock.h"
 
 #include "twins.hpp"
+#include "twins_pal_defimpl.hpp"
 
 // -----------------------------------------------------------------------------
 
@@ -17,6 +18,20 @@ void decodeInputSeqReset();
 }
 
 static char rbBuffer[15];
+static char rbBufferLong[64];
+
+/** @brief PAL with the time set by the test */
+struct ClockPAL : twins::DefaultPAL
+{
+    ClockPAL()  { pPrevPAL = twins::pPAL; twins::pPAL = this; }
+    ~ClockPAL() { twins::pPAL = pPrevPAL; }
+
+    uint32_t getTimeStamp() override { return now; }
+    uint32_t getTimeDiff(uint32_t timestamp) override { return now - timestamp; }
+
+    twins::IPal *pPrevPAL;
+    uint32_t now = 0;
+};
 
 
 // -----------------------------------------------------------------------------
@@ -81,17 +96,88 @@ TEST(ANSI_INPUTDECODER, EscFollowedByEsc)
 
 TEST(ANSI_INPUTDECODER, EscFollowedByNothing)
 {
+    twins::decodeInputSeqReset();
+    twins::decodeInputSeqEscTimeout(20);
+    ClockPAL pal;
+    pal.now = 1000;
     twins::RingBuff<char> input(rbBuffer);
     twins::KeyCode kc;
 
     // write and decode single ESC - first attempt shall be ignored, waiting for sequence data
+    EXPECT_EQ(0, twins::decodeInputSeqEscPending());
     input.write((char)twins::Ansi::ESC);
     decodeInputSeq(input, kc);
     EXPECT_EQ(twins::Key::None, kc.key);
+    EXPECT_EQ(20, twins::decodeInputSeqEscPending());
+
+    // second attempt before timeout - still waiting
+    pal.now += 10;
+    decodeInputSeq(input, kc);
+    EXPECT_EQ(twins::Key::None, kc.key);
+    decodeInputSeq(input, kc);
+    EXPECT_EQ(twins::Key::None, kc.key);
+    EXPECT_EQ(10, twins::decodeInputSeqEscPending());
 
-    // second attempt to decode the same buffer - shall output ESC code
+    // attempt to decode the same buffer after timeout - shall output ESC code
+    pal.now += 10;
+    EXPECT_EQ(1, twins::decodeInputSeqEscPending());
     decodeInputSeq(input, kc);
     EXPECT_EQ(twins::Key::Esc, kc.key);
+    EXPECT_EQ(0, input.size());
+    EXPECT_EQ(0, twins::decodeInputSeqEscPending());
+    twins::decodeInputSeqEscTimeout(25);
+}
+
+TEST(ANSI_INPUTDECODER, EscFollowedByNothing_noClock)
+{
+    // PAL time stamp not implemented - decoded on the second attempt
+    twins::decodeInputSeqReset();
+    ClockPAL pal;
+    twins::RingBuff<char> input(rbBuffer);
+    twins::KeyCode kc;
+
+    input.write((char)twins::Ansi::ESC);
+    decodeInputSeq(input, kc);
+    EXPECT_EQ(twins::Key::None, kc.key);
+    EXPECT_EQ(25, twins::decodeInputSeqEscPending());
+
+    decodeInputSeq(input, kc);
+    EXPECT_EQ(twins::Key::Esc, kc.key);
+    EXPECT_EQ(0, input.size());
+}
+
+TEST(ANSI_INPUTDECODER, IncompleteUtf8_notPending)
+{
+    twins::decodeInputSeqReset();
+    twins::RingBuff<char> input(rbBuffer);
+    twins::KeyCode kc;
+
+    // first two bytes of "€" - waits for more data, not for the timeout
+    input.write("\xE2\x82");
+    EXPECT_EQ(0, decodeInputSeq(input, kc));
+    EXPECT_EQ(2, input.size());
+    EXPECT_EQ(0, twins::decodeInputSeqEscPending());
+
+    input.write("\xAC");
+    EXPECT_EQ(3, decodeInputSeq(input, kc));
+    EXPECT_STREQ("€", kc.utf8);
+    input.clear();
+}
+
+TEST(ANSI_INPUTDECODER, EscTimeout_SeqCompleted)
+{
+    twins::decodeInputSeqReset();
+    twins::RingBuff<char> input(rbBuffer);
+    twins::KeyCode kc;
+
+    input.write((char)twins::Ansi::ESC);
+    decodeInputSeq(input, kc);
+    EXPECT_EQ(twins::Key::None, kc.key);
+
+    // rest of the sequence within timeout
+    input.write("[A");
+    decodeInputSeq(input, kc);
+    EXPECT_EQ(twins::Key::Up, kc.key);
 }
 
 TEST(ANSI_INPUTDECODER, Ctrl_S)
@@ -174,9 +260,11 @@ TEST(ANSI_INPUTDECODER, NUL_InInput)
     EXPECT_EQ(twins::Key::None, kc.key);
 }
 
-TEST(ANSI_INPUTDECODER, DISABLED_Ctrl_F1__incomplete)
+TEST(ANSI_INPUTDECODER, Ctrl_F1__incomplete)
 {
     twins::decodeInputSeqReset();
+    // trailing ESC decoded without waiting
+    twins::decodeInputSeqEscTimeout(0);
     twins::RingBuff<char> input(rbBuffer);
     twins::KeyCode kc;
 
@@ -201,6 +289,7 @@ TEST(ANSI_INPUTDECODER, DISABLED_Ctrl_F1__incomplete)
     EXPECT_EQ(0, input.size());
     EXPECT_EQ(KEY_MOD_SPECIAL, kc.mod_all);
     EXPECT_EQ(twins::Key::Esc, kc.key);
+    twins::decodeInputSeqEscTimeout(25);
 }
 
 TEST(ANSI_INPUTDECODER, L__S_C_UP__O)
@@ -322,3 +411,277 @@ TEST(ANSI_INPUTDECODER, Mouse_wheel_down)
     EXPECT_EQ(2, kc.mouse.row);
     EXPECT_EQ(0, kc.mod_all);
 }
+
+TEST(ANSI_INPUTDECODER, Mouse_SGR_click_release)
+{
+    twins::decodeInputSeqReset();
+    twins::RingBuff<char> input(rbBufferLong);
+    twins::KeyCode kc;
+
+    input.write("\e[<0;300;45M");
+    EXPECT_EQ(12, decodeInputSeq(input, kc));
+    EXPECT_EQ(twins::Key::MouseEvent, kc.key);
+    EXPECT_EQ(twins::MouseBtn::ButtonLeft, kc.mouse.btn);
+    // beyond the X10 mode limit
+    EXPECT_EQ(300, kc.mouse.col);
+    EXPECT_EQ(45, kc.mouse.row);
+    EXPECT_EQ(0, kc.mod_all);
+    EXPECT_EQ(1, kc.repeat);
+
+    input.write("\e[<16;3;4m");
+    EXPECT_EQ(10, decodeInputSeq(input, kc));
+    EXPECT_EQ(twins::MouseBtn::ButtonReleased, kc.mouse.btn);
+    EXPECT_EQ(3, kc.mouse.col);
+    EXPECT_EQ(4, kc.mouse.row);
+    EXPECT_EQ(KEY_MOD_CTRL, kc.mod_all);
+    EXPECT_EQ(0, input.size());
+}
+
+TEST(ANSI_INPUTDECODER, Mouse_SGR_wide_terminal)
+{
+    twins::decodeInputSeqReset();
+    twins::RingBuff<char> input(rbBufferLong);
+    twins::KeyCode kc;
+
+    input.write("\e[<0;1000;260M");
+    EXPECT_EQ(14, decodeInputSeq(input, kc));
+    EXPECT_EQ(twins::Key::MouseEvent, kc.key);
+    EXPECT_EQ(1000, kc.mouse.col);
+    EXPECT_EQ(260, kc.mouse.row);
+
+    // saturated instead of wrapped around
+    input.write("\e[<0;99999;5M");
+    EXPECT_EQ(13, decodeInputSeq(input, kc));
+    EXPECT_EQ(UINT16_MAX, kc.mouse.col);
+    EXPECT_EQ(5, kc.mouse.row);
+}
+
+TEST(ANSI_INPUTDECODER, Mouse_SGR_wheel_motion)
+{
+    twins::decodeInputSeqReset();
+    twins::RingBuff<char> input(rbBufferLong);
+    twins::KeyCode kc;
+
+    input.write("\e[<65;12;7M");
+    decodeInputSeq(input, kc);
+    EXPECT_EQ(twins::Key::MouseEvent, kc.key);
+    EXPECT_EQ(twins::MouseBtn::WheelDown, kc.mouse.btn);
+    EXPECT_EQ(12, kc.mouse.col);
+    EXPECT_EQ(7, kc.mouse.row);
+
+    input.write("\e[<35;1;2M");
+    decodeInputSeq(input, kc);
+    EXPECT_EQ(twins::MouseBtn::Motion, kc.mouse.btn);
+    EXPECT_EQ(1, kc.mouse.col);
+    EXPECT_EQ(2, kc.mouse.row);
+}
+
+TEST(ANSI_INPUTDECODER, Mouse_SGR_split)
+{
+    twins::decodeInputSeqReset();
+    twins::RingBuff<char> input(rbBufferLong);
+    twins::KeyCode kc;
+
+    input.write("\e[<0;12");
+    EXPECT_EQ(0, decodeInputSeq(input, kc));
+    EXPECT_EQ(twins::Key::None, kc.key);
+
+    input.write("3;9M");
+    EXPECT_EQ(11, decodeInputSeq(input, kc));
+    EXPECT_EQ(twins::Key::MouseEvent, kc.key);
+    EXPECT_EQ(123, kc.mouse.col);
+    EXPECT_EQ(9, kc.mouse.row);
+}
+
+TEST(ANSI_INPUTDECODER, Mouse_Batch_coalesce)
+{
+    twins::decodeInputSeqReset();
+    twins::RingBuff<char> input(rbBufferLong);
+    twins::KeyCode keys[4];
+
+    // 3 wheel steps at the same position, then 2 motion reports
+    input.write("\e[<64;5;5M" "\e[<64;5;5M" "\e[<64;5;5M");
+    input.write("\e[<35;6;5M" "\e[<35;7;6M");
+    EXPECT_EQ(2, twins::decodeInputSeqBatch(input, keys, 4));
+    EXPECT_EQ(twins::MouseBtn::WheelUp, keys[0].mouse.btn);
+    EXPECT_EQ(3, keys[0].repeat);
+    EXPECT_EQ(twins::MouseBtn::Motion, keys[1].mouse.btn);
+    EXPECT_EQ(2, keys[1].repeat);
+    EXPECT_EQ(7, keys[1].mouse.col);
+    EXPECT_EQ(6, keys[1].mouse.row);
+
+    // clicks and wheel at different positions are kept
+    input.write("\e[<0;5;5M" "\e[<0;5;5M" "\e[<65;1;1M" "\e[<65;2;1M");
+    EXPECT_EQ(4, twins::decodeInputSeqBatch(input, keys, 4));
+    EXPECT_EQ(1, keys[0].repeat);
+    EXPECT_EQ(1, keys[3].repeat);
+}
+
+TEST(ANSI_INPUTDECODER, Keys_Batch_coalesce)
+{
+    twins::decodeInputSeqReset();
+    twins::RingBuff<char> input(rbBufferLong);
+    twins::KeyCode keys[4];
+
+    // keys are not merged by default
+    input.write("\e[B\e[B");
+    EXPECT_EQ(2, twins::decodeInputSeqBatch(input, keys, 4));
+    EXPECT_EQ(twins::Key::Down, keys[0].key);
+    EXPECT_EQ(1, keys[0].repeatCount());
+    EXPECT_EQ(twins::Key::Down, keys[1].key);
+    EXPECT_EQ(1, keys[1].repeatCount());
+
+    input.write("\e[B\e[B\e[B" "\e[1;5B" "\e[A" "aa");
+    EXPECT_EQ(4, twins::decodeInputSeqBatch(input, keys, 4, true));
+    EXPECT_EQ(twins::Key::Down, keys[0].key);
+    EXPECT_EQ(3, keys[0].repeatCount());
+    EXPECT_EQ(twins::Key::Down, keys[1].key);
+    EXPECT_TRUE(keys[1].m_ctrl);
+    EXPECT_EQ(1, keys[1].repeatCount());
+    EXPECT_EQ(twins::Key::Up, keys[2].key);
+    EXPECT_EQ(1, keys[2].repeatCount());
+    // text is never merged
+    EXPECT_STREQ("a", keys[3].utf8);
+    EXPECT_EQ(1, keys[3].repeatCount());
+    EXPECT_EQ(1, input.size());
+
+    input.clear();
+    input.write("\e[6~\e[6~" "\e[C\e[C");
+    EXPECT_EQ(3, twins::decodeInputSeqBatch(input, keys, 4, true));
+    EXPECT_EQ(twins::Key::PgDown, keys[0].key);
+    EXPECT_EQ(2, keys[0].repeatCount());
+    EXPECT_EQ(twins::Key::Right, keys[1].key);
+    EXPECT_EQ(twins::Key::Right, keys[2].key);
+}
+
+TEST(ANSI_INPUTDECODER, Paste)
+{
+    twins::decodeInputSeqReset();
+    twins::RingBuff<char> input(rbBufferLong);
+    twins::KeyCode kc;
+
+    input.write("x" "\e[200~" "ab\r\nc");
+    EXPECT_EQ(1, decodeInputSeq(input, kc));
+    EXPECT_STREQ("x", kc.utf8);
+
+    // pasted text consumed, but incomplete
+    EXPECT_EQ(0, decodeInputSeq(input, kc));
+    EXPECT_EQ(twins::Key::None, kc.key);
+    EXPECT_EQ(0, input.size());
+
+    // ESC inside the text is dropped; end marker split
+    input.write("\e[1m" "\e[201");
+    EXPECT_EQ(0, decodeInputSeq(input, kc));
+    EXPECT_EQ(5, input.size());
+
+    input.write("~" "y");
+    EXPECT_EQ(6, decodeInputSeq(input, kc));
+    EXPECT_EQ(twins::Key::Paste, kc.key);
+    EXPECT_EQ(KEY_MOD_SPECIAL, kc.mod_all);
+    EXPECT_EQ(8, kc.paste.size);
+    EXPECT_STREQ("ab\r\nc[1m", kc.paste.data);
+
+    EXPECT_EQ(1, decodeInputSeq(input, kc));
+    EXPECT_STREQ("y", kc.utf8);
+    EXPECT_EQ(0, kc.paste.size);
+}
+
+TEST(ANSI_INPUTDECODER, Paste_Batch)
+{
+    twins::decodeInputSeqReset();
+    twins::RingBuff<char> input(rbBufferLong);
+    twins::KeyCode keys[4];
+
+    // empty paste and begin marker split
+    input.write("\e[200~\e[201~" "\e[20");
+    EXPECT_EQ(1, twins::decodeInputSeqBatch(input, keys, 4));
+    EXPECT_EQ(twins::Key::Paste, keys[0].key);
+    EXPECT_EQ(0, keys[0].paste.size);
+
+    // batch stops after the paste
+    input.write("0~" "qq" "\e[201~" "z");
+    EXPECT_EQ(1, twins::decodeInputSeqBatch(input, keys, 4));
+    EXPECT_EQ(twins::Key::Paste, keys[0].key);
+    EXPECT_STREQ("qq", keys[0].paste.data);
+
+    EXPECT_EQ(1, twins::decodeInputSeqBatch(input, keys, 4));
+    EXPECT_STREQ("z", keys[0].utf8);
+
+    // F9 shares the marker prefix
+    input.write("\e[20~");
+    EXPECT_EQ(1, twins::decodeInputSeqBatch(input, keys, 4));
+    EXPECT_EQ(twins::Key::F9, keys[0].key);
+}
+
+TEST(ANSI_INPUTDECODER, SplitSeq__resumed)
+{
+    twins::decodeInputSeqReset();
+    twins::RingBuff<char> input(rbBuffer);
+    twins::KeyCode kc;
+
+    // sequence arriving in three parts
+    input.write("\e[1");
+    EXPECT_EQ(0, decodeInputSeq(input, kc));
+    EXPECT_EQ(twins::Key::None, kc.key);
+    EXPECT_EQ(3, input.size());
+
+    input.write("5;");
+    EXPECT_EQ(0, decodeInputSeq(input, kc));
+    EXPECT_EQ(5, input.size());
+
+    input.write("2~x");
+    EXPECT_EQ(7, decodeInputSeq(input, kc));
+    EXPECT_EQ(twins::Key::F5, kc.key);
+    EXPECT_EQ(KEY_MOD_SPECIAL | KEY_MOD_SHIFT, kc.mod_all);
+    EXPECT_EQ(1, input.size());
+
+    EXPECT_EQ(1, decodeInputSeq(input, kc));
+    EXPECT_STREQ("x", kc.utf8);
+}
+
+TEST(ANSI_INPUTDECODER, AllSingleByteKeys)
+{
+    twins::decodeInputSeqReset();
+    twins::RingBuff<char> input(rbBuffer);
+    twins::KeyCode kc;
+
+    input.write((char)0x7F);
+    EXPECT_EQ(1, decodeInputSeq(input, kc));
+    EXPECT_EQ(twins::Key::Backspace, kc.key);
+
+    // Tab wins over Ctrl+I
+    input.write((char)0x09);
+    EXPECT_EQ(1, decodeInputSeq(input, kc));
+    EXPECT_EQ(twins::Key::Tab, kc.key);
+    EXPECT_EQ(KEY_MOD_SPECIAL, kc.mod_all);
+
+    input.write((char)0x01);
+    EXPECT_EQ(1, decodeInputSeq(input, kc));
+    EXPECT_STREQ("A", kc.utf8);
+    EXPECT_EQ(KEY_MOD_CTRL, kc.mod_all);
+}
+
+TEST(ANSI_INPUTDECODER, Batch)
+{
+    twins::decodeInputSeqReset();
+    twins::RingBuff<char> input(rbBuffer);
+    twins::KeyCode keys[4];
+
+    EXPECT_EQ(0, twins::decodeInputSeqBatch(input, keys, 4));
+
+    input.write("ab\e[Ac\e[1;");
+    EXPECT_EQ(4, twins::decodeInputSeqBatch(input, keys, 4));
+    EXPECT_STREQ("a", keys[0].utf8);
+    EXPECT_STREQ("b", keys[1].utf8);
+    EXPECT_EQ(twins::Key::Up, keys[2].key);
+    EXPECT_STREQ("c", keys[3].utf8);
+    // incomplete sequence left in the buffer
+    EXPECT_EQ(4, input.size());
+
+    input.write("5B" "xyz");
+    EXPECT_EQ(2, twins::decodeInputSeqBatch(input, keys, 2));
+    EXPECT_EQ(twins::Key::Down, keys[0].key);
+    EXPECT_TRUE(keys[0].m_ctrl);
+    EXPECT_STREQ("x", keys[1].utf8);
+    EXPECT_EQ(2, input.size());
+}
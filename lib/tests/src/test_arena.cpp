@@ -0,0 +1,80 @@
+/******************************************************************************
+ * @brief   TWins - unit tests
+ * @author  Mariusz Midor
+ *          https://bitbucket.org/marmidr/twins
+ *****************************************************************************/
+
+#include "gtest/gtest.h"
+#include "gmock/gmock.h"
+
+#include "twins_arena.hpp"
+#include "twins_string.hpp"
+
+// -----------------------------------------------------------------------------
+
+TEST(ARENA, alloc_rewind)
+{
+    alignas(void*) uint8_t buff[64];
+    twins::Arena arena(buff, sizeof(buff));
+
+    EXPECT_EQ(nullptr, arena.alloc(0));
+    EXPECT_EQ(nullptr, arena.alloc(65));
+
+    void *p1 = arena.alloc(3);
+    ASSERT_NE(nullptr, p1);
+    EXPECT_TRUE(arena.owns(p1));
+    auto mark = arena.mark();
+
+    void *p2 = arena.alloc(8);
+    ASSERT_NE(nullptr, p2);
+    // aligned
+    EXPECT_EQ(0u, (uintptr_t)p2 % sizeof(void*));
+    EXPECT_GT(arena.used(), 8u);
+
+    arena.rewind(mark);
+    EXPECT_EQ(p2, arena.alloc(8));
+    EXPECT_EQ(nullptr, arena.alloc(64));
+
+    arena.reset();
+    EXPECT_EQ(0u, arena.used());
+    EXPECT_GE(arena.usedMax(), 16u);
+    EXPECT_FALSE(arena.owns(&mark));
+}
+
+TEST(ARENA, frame_string)
+{
+    auto &arena = twins::frameArena();
+    const auto used = arena.used();
+
+    {
+        twins::FrameArenaScope _scope;
+        twins::String s;
+        s.useFrameArena();
+        s.append('x', 100);
+        EXPECT_TRUE(arena.owns(s.cstr()));
+        EXPECT_GT(arena.used(), used);
+
+        // arena buffer is copied, not taken over
+        twins::String s2(std::move(s));
+        EXPECT_FALSE(arena.owns(s2.cstr()));
+        EXPECT_EQ(100, s2.size());
+    }
+
+    EXPECT_EQ(used, arena.used());
+}
+
+TEST(ARENA, frame_array)
+{
+    twins::FrameArenaScope _scope;
+    twins::FrameArray<uint16_t> arr(4);
+
+    arr.append(3);
+    arr.append(1);
+    EXPECT_EQ(2, arr.size());
+    EXPECT_EQ(1, arr[1]);
+    EXPECT_TRUE(twins::frameArena().owns(arr.data()));
+
+    // too big for the arena - taken from the heap
+    twins::FrameArray<uint8_t> big(TWINS_FRAME_ARENA_SIZE + 1);
+    EXPECT_FALSE(twins::frameArena().owns(big.data()));
+}
@@ -304,6 +304,51 @@ TEST_F(CLI, many_cmds_in_buffer)
     EXPECT_FALSE(twins::cli::checkAndExec(commands));
 }
 
+static std::string paste_args;
+
+TEST_F(CLI, paste)
+{
+    const twins::cli::Cmd commands[] =
+    {
+        {
+            "cfg", "",
+            TWINS_CLI_HANDLER
+            {
+                for (auto a : argv) { paste_args += a; paste_args += ","; }
+            }
+        },
+        { /* terminator */ }
+    };
+
+    // every line executed, the last one left for editing
+    paste_args.clear();
+    twins::cli::processInput("\e[200~" "cfg a\r\n" "cfg\tb\n" "cfg c" "\e[201~");
+    EXPECT_TRUE(twins::cli::checkAndExec(commands));
+    EXPECT_TRUE(twins::cli::checkAndExec(commands));
+    EXPECT_FALSE(twins::cli::checkAndExec(commands));
+    EXPECT_STREQ("cfg,a,cfg,b,", paste_args.c_str());
+    twins::cli::processInput("d\r");
+    EXPECT_TRUE(twins::cli::checkAndExec(commands));
+    EXPECT_STREQ("cfg,a,cfg,b,cfg,cd,", paste_args.c_str());
+
+    // single line
+    paste_args.clear();
+    twins::cli::pasteNewline = twins::cli::PasteNewline::Space;
+    twins::cli::processInput("\e[200~" "cfg x\ny" "\e[201~" "\r");
+    EXPECT_TRUE(twins::cli::checkAndExec(commands));
+    EXPECT_STREQ("cfg,x,y,", paste_args.c_str());
+
+    // first line only
+    paste_args.clear();
+    twins::cli::pasteNewline = twins::cli::PasteNewline::Ignore;
+    twins::cli::processInput("\e[200~" "cfg 1\ncfg 2" "\e[201~" "\r");
+    EXPECT_TRUE(twins::cli::checkAndExec(commands));
+    EXPECT_FALSE(twins::cli::checkAndExec(commands));
+    EXPECT_STREQ("cfg,1,", paste_args.c_str());
+
+    twins::cli::pasteNewline = twins::cli::PasteNewline::Execute;
+}
+
 TEST_F(CLI, override_handler)
 {
     static bool push_called;
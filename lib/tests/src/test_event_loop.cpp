@@ -0,0 +1,210 @@
+/******************************************************************************
+ * @brief   TWins - unit tests
+ * @author  Mariusz Midor
+ *          https://bitbucket.org/marmidr/twins
+ *****************************************************************************/
+
+#include "gtest/gtest.h"
+#include "gmock/gmock.h"
+
+#include "twins_event_loop.hpp"
+
+#include <unistd.h>
+#include <fcntl.h>
+#include <thread>
+#include <chrono>
+
+// -----------------------------------------------------------------------------
+
+class EVLOOP : public testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        ASSERT_EQ(0, pipe(pipeFd));
+        fcntl(pipeFd[0], F_SETFL, fcntl(pipeFd[0], F_GETFL) | O_NONBLOCK);
+        rb.initStatic(rbBuff);
+    }
+
+    void TearDown() override
+    {
+        close(pipeFd[0]);
+        if (pipeFd[1] >= 0) close(pipeFd[1]);
+    }
+
+protected:
+    int pipeFd[2] = {-1, -1};
+    char rbBuff[16];
+    twins::RingBuff<char> rb;
+};
+
+// -----------------------------------------------------------------------------
+
+TEST_F(EVLOOP, timer_oneshot)
+{
+    twins::EventLoop loop;
+    int fired = 0;
+
+    int id = loop.addTimer(5, [&]() { fired++; }, false);
+    EXPECT_GT(id, 0);
+    EXPECT_TRUE(loop.isTimerActive(id));
+
+    // timeout is shortened to the timer deadline
+    auto t0 = std::chrono::steady_clock::now();
+    EXPECT_TRUE(loop.runOnce(1000));
+    auto elapsed = std::chrono::steady_clock::now() - t0;
+    EXPECT_EQ(1, fired);
+    EXPECT_LT(elapsed, std::chrono::milliseconds(500));
+    EXPECT_FALSE(loop.isTimerActive(id));
+
+    // nothing more to fire
+    EXPECT_TRUE(loop.runOnce(10));
+    EXPECT_EQ(1, fired);
+}
+
+TEST_F(EVLOOP, timer_periodic)
+{
+    twins::EventLoop loop;
+    int fired = 0;
+    int id = 0;
+
+    id = loop.addTimer(2, [&]() { if (++fired == 3) loop.removeTimer(id); });
+
+    for (int i = 0; i < 10; i++)
+        loop.runOnce(50);
+
+    EXPECT_EQ(3, fired);
+    EXPECT_FALSE(loop.isTimerActive(id));
+}
+
+TEST_F(EVLOOP, input_to_ringbuffer)
+{
+    twins::EventLoop loop;
+    int calls = 0;
+    bool got_eof = false;
+    char data[20] = {};
+
+    EXPECT_TRUE(loop.addInput(pipeFd[0], rb, [&](twins::RingBuff<char> &rb, bool eof) {
+        calls++;
+        got_eof |= eof;
+        rb.read(data, sizeof(data));
+    }));
+    EXPECT_FALSE(loop.addInput(pipeFd[0], rb, nullptr));
+
+    // burst is taken in single read
+    ASSERT_EQ(10, write(pipeFd[1], "0123456789", 10));
+    EXPECT_TRUE(loop.runOnce(100));
+    EXPECT_EQ(1, calls);
+    EXPECT_STREQ("0123456789", data);
+    EXPECT_FALSE(got_eof);
+
+    // wraps around the ring buffer end
+    memset(data, 0, sizeof(data));
+    ASSERT_EQ(12, write(pipeFd[1], "abcdefghijkl", 12));
+    EXPECT_TRUE(loop.runOnce(100));
+    EXPECT_EQ(2, calls);
+    EXPECT_STREQ("abcdefghijkl", data);
+
+    // writer closed - source removed
+    close(pipeFd[1]);
+    pipeFd[1] = -1;
+    EXPECT_TRUE(loop.runOnce(100));
+    EXPECT_EQ(3, calls);
+    EXPECT_TRUE(got_eof);
+
+    EXPECT_TRUE(loop.runOnce(10));
+    EXPECT_EQ(3, calls);
+}
+
+TEST_F(EVLOOP, input_paused_while_full)
+{
+    twins::EventLoop loop;
+    int calls = 0;
+
+    EXPECT_TRUE(loop.addInput(pipeFd[0], rb, [&](twins::RingBuff<char> &, bool) { calls++; }));
+
+    // data are left in the buffer by the handler
+    ASSERT_EQ(20, write(pipeFd[1], "0123456789abcdefghij", 20));
+    EXPECT_TRUE(loop.runOnce(100));
+    EXPECT_EQ(1, calls);
+    EXPECT_TRUE(rb.isFull());
+
+    // pipe still readable, but fd is not watched - no busy loop
+    EXPECT_TRUE(loop.runOnce(10));
+    EXPECT_TRUE(loop.runOnce(10));
+    EXPECT_EQ(1, calls);
+
+    // space available - resumed
+    char data[20] = {};
+    EXPECT_EQ(16, rb.read(data, sizeof(data)));
+    EXPECT_TRUE(loop.runOnce(100));
+    EXPECT_EQ(2, calls);
+    EXPECT_EQ(4, rb.size());
+}
+
+TEST_F(EVLOOP, fd_handler_remove)
+{
+    twins::EventLoop loop;
+    int calls = 0;
+
+    EXPECT_TRUE(loop.addFd(pipeFd[0], [&](int fd) {
+        char c;
+        while (read(fd, &c, 1) == 1) {}
+        calls++;
+        loop.removeFd(fd);
+    }));
+
+    ASSERT_EQ(1, write(pipeFd[1], "x", 1));
+    EXPECT_TRUE(loop.runOnce(100));
+    EXPECT_EQ(1, calls);
+
+    // no longer watched
+    ASSERT_EQ(1, write(pipeFd[1], "y", 1));
+    EXPECT_TRUE(loop.runOnce(10));
+    EXPECT_EQ(1, calls);
+}
+
+TEST_F(EVLOOP, wakeup_from_thread)
+{
+    twins::EventLoop loop;
+    int wakeups = 0;
+
+    loop.setWakeupHandler([&]() { wakeups++; loop.quit(); });
+
+    std::thread th([&]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        loop.wakeup();
+    });
+
+    // returns only after quit()
+    loop.run();
+    th.join();
+    EXPECT_EQ(1, wakeups);
+
+    // loop can be run again; wakeups sent before the poll are merged into one
+    loop.setWakeupHandler([&]() { wakeups++; });
+    loop.wakeup();
+    loop.wakeup();
+
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(1);
+    while (wakeups < 2 && std::chrono::steady_clock::now() < deadline)
+        EXPECT_TRUE(loop.runOnce(10));
+    EXPECT_EQ(2, wakeups);
+
+    // nothing pending
+    EXPECT_TRUE(loop.runOnce(0));
+    EXPECT_EQ(2, wakeups);
+}
+
+TEST_F(EVLOOP, quit)
+{
+    twins::EventLoop loop;
+    int fired = 0;
+
+    loop.addTimer(1, [&]() { if (++fired == 5) loop.quit(); });
+    loop.run();
+    EXPECT_EQ(5, fired);
+
+    loop.quit();
+    EXPECT_FALSE(loop.runOnce(0));
+}
@@ -25,6 +25,9 @@ ColorBG intensifyClTheme(ColorBG cl) { return cl; }
 
 // -----------------------------------------------------------------------------
 
+/** @brief When set, written output is collected here instead of being dropped */
+std::string *pTestOutput = nullptr;
+
 // must be global due to static twins objects destroyed after main() quit
 struct TestPAL : twins::DefaultPAL
 {
@@ -50,6 +53,9 @@ struct TestPAL : twins::DefaultPAL
             if (lineBuff.size() > lineBuffMaxSize)
                 lineBuffMaxSize = lineBuff.size();
 
+            if (pTestOutput)
+                pTestOutput->append(lineBuff.cstr(), lineBuff.size());
+
             lineBuff.clear();
         }
     }
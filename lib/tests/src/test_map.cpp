@@ -30,19 +30,13 @@ TEST(MAP, add_many)
         m[i] = i;
 
     EXPECT_EQ(nodes/step, m.size());
-    EXPECT_EQ(32, m.bucketsCount());
+    EXPECT_EQ(256, m.bucketsCount());
 
     for (int i = 1; i < nodes; i += step)
         EXPECT_EQ(i, m[i]);
 
     fprintf(stderr, "distro: %d\n", m.distribution());
     EXPECT_GE(m.distribution(), 85);
-
-    // for (unsigned i = 0; i < m.bucketsCount(); i++)
-    // {
-    //     const auto *p = m.bucket(i);
-    //     printf("bucket[%u] = %u\n", i, p->size());
-    // }
 }
 
 TEST(MAP, add_many_strings)
@@ -55,7 +49,7 @@ TEST(MAP, add_many_strings)
         m[i] = itostr(i);
 
     EXPECT_EQ(nodes, m.size());
-    EXPECT_EQ(32, m.bucketsCount());
+    EXPECT_EQ(256, m.bucketsCount());
     EXPECT_STREQ("42", m[42].c_str());
 }
 
@@ -82,6 +76,81 @@ TEST(MAP, remove_clear)
     EXPECT_EQ(0, m.size());
 }
 
+TEST(MAP, remove_many)
+{
+    twins::Map<int, int> m;
+
+    for (int i = 0; i < 500; i++)
+        m[i] = i * 2;
+
+    // remove every 3rd - the others must be still reachable
+    for (int i = 0; i < 500; i += 3)
+        m.remove(i);
+
+    EXPECT_EQ(500 - 167, m.size());
+
+    for (int i = 0; i < 500; i++)
+    {
+        if (i % 3 == 0)
+            EXPECT_FALSE(m.contains(i));
+        else
+            EXPECT_EQ(i * 2, m[i]);
+    }
+
+    EXPECT_EQ(500 - 167, m.size());
+
+    int n = 0;
+    for (auto &it : m)
+        (void)it, n++;
+    EXPECT_EQ(m.size(), n);
+}
+
+TEST(MAP, add_above_64k_slots)
+{
+    // capacity grows past 32768 slots - must not wrap to 0
+    twins::Map<int, int> m;
+    const int nodes = 30000;
+
+    for (int i = 0; i < nodes; i++)
+        m[i] = i + 1;
+
+    EXPECT_EQ(nodes, (int)m.size());
+    EXPECT_EQ(65536, (int)m.bucketsCount());
+
+    for (int i = 0; i < nodes; i++)
+        EXPECT_EQ(i + 1, m[i]);
+
+    EXPECT_FALSE(m.contains(nodes));
+    EXPECT_GE(m.distribution(), 85);
+
+    for (int i = 0; i < nodes; i += 2)
+        m.remove(i);
+
+    EXPECT_EQ(nodes / 2, (int)m.size());
+    EXPECT_EQ(15002, m[15001]);
+
+    int n = 0;
+    for (auto &it : m)
+        (void)it, n++;
+    EXPECT_EQ(nodes / 2, n);
+}
+
+TEST(MAP, copy_move)
+{
+    twins::Map<int, std::string> m;
+    m[1] = "one";
+    m[2] = "two";
+
+    auto m2 = m;
+    EXPECT_EQ(2, m2.size());
+    EXPECT_STREQ("two", m2[2].c_str());
+
+    auto m3 = std::move(m);
+    EXPECT_EQ(0, m.size());
+    EXPECT_FALSE(m.contains(1));
+    EXPECT_STREQ("one", m3[1].c_str());
+}
+
 TEST(MAP, key_arithmetic)
 {
     {
@@ -150,6 +219,26 @@ TEST(MAP, key_string)
         EXPECT_TRUE(m[key]);
     }
 
+    // long keys with common prefix
+    {
+        twins::Map<const char*, int> m;
+        std::string keys[50];
+
+        for (int i = 0; i < 50; i++)
+        {
+            keys[i] = "twins.widget.properties.item_";
+            keys[i] += itostr(i);
+            m[keys[i].c_str()] = i;
+        }
+
+        EXPECT_EQ(50, m.size());
+        EXPECT_EQ(42, m["twins.widget.properties.item_42"]);
+        EXPECT_GE(m.distribution(), 50);
+
+        // different hashes, despite the first 15 characters are identical
+        EXPECT_NE(twins::HashDefault::hash(keys[0].c_str()), twins::HashDefault::hash(keys[1].c_str()));
+    }
+
     // example of own hashing object for not embedded key type
     {
         struct HashStdStr { static uint16_t hash(const std::string& str) { return twins::HashDefault::bernsteinHashImpl(str.data(), str.size()); } };
@@ -178,11 +267,11 @@ TEST(MAP, iterators_small)
     {
         m[0] = 0;
         EXPECT_EQ(1, m.size());
-        EXPECT_EQ(4, m.bucketsCount());
+        EXPECT_EQ(8, m.bucketsCount());
 
         for (auto it : m)
         {
-            printf("m[%d | %04x] : %d\n", it.key, it.hash, it.val);
+            printf("m[%d | %08x] : %d\n", it.key, it.hash, it.val);
             it.val++;
         }
     }
@@ -211,7 +300,7 @@ TEST(MAP, iterators_big)
         int n = 0;
         for (auto &it : m)
         {
-            printf("m[%d | %04x] : %d\n", it.key, it.hash, it.val);
+            printf("m[%d | %08x] : %d\n", it.key, it.hash, it.val);
             n++;
         }
 
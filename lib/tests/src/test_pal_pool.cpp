@@ -0,0 +1,149 @@
+/******************************************************************************
+ * @brief   TWins - unit tests
+ * @author  Mariusz Midor
+ *          https://bitbucket.org/marmidr/twins
+ *****************************************************************************/
+
+#include "gtest/gtest.h"
+#include "gmock/gmock.h"
+
+#include "twins_pal_pool.hpp"
+
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// -----------------------------------------------------------------------------
+
+using SmallPoolPAL = twins::PoolPAL<2, 1, 1, 0, 1>;
+
+TEST(PAL_POOL, size_classes)
+{
+    SmallPoolPAL pal;
+    const auto &st = pal.stats;
+    ASSERT_EQ(5, st.poolsCount);
+    EXPECT_EQ(32, st.pPools[0].blockSize);
+    EXPECT_EQ(1024, st.pPools[4].blockSize);
+
+    void *p1 = pal.memAlloc(10);
+    void *p2 = pal.memAlloc(32);
+    EXPECT_TRUE(pal.isPoolBlock(p1));
+    EXPECT_TRUE(pal.isPoolBlock(p2));
+    EXPECT_EQ(2, st.pPools[0].blocksUsed);
+
+    // 32-class exhausted - served by 64-class
+    void *p3 = pal.memAlloc(20);
+    EXPECT_TRUE(pal.isPoolBlock(p3));
+    EXPECT_EQ(1, st.pPools[0].failures);
+    EXPECT_EQ(1, st.pPools[1].blocksUsed);
+
+    // 256-class is empty: 1K block
+    void *p4 = pal.memAlloc(200);
+    EXPECT_TRUE(pal.isPoolBlock(p4));
+    EXPECT_EQ(1, st.pPools[4].blocksUsed);
+
+    // too big - general heap
+    void *p5 = pal.memAlloc(2000);
+    ASSERT_NE(nullptr, p5);
+    EXPECT_FALSE(pal.isPoolBlock(p5));
+    EXPECT_EQ(1u, st.poolFallbacks);
+    EXPECT_EQ(5, st.memChunks);
+
+    pal.memFree(p1);
+    pal.memFree(p2);
+    pal.memFree(p3);
+    pal.memFree(p4);
+    pal.memFree(p5);
+    EXPECT_EQ(0, st.memChunks);
+    EXPECT_EQ(0, st.memAllocated);
+    EXPECT_EQ(0, st.pPools[0].blocksUsed);
+    EXPECT_EQ(2, st.pPools[0].blocksUsedMax);
+
+    // freed blocks are reused
+    void *p6 = pal.memAlloc(30);
+    EXPECT_TRUE(p6 == p1 || p6 == p2);
+    pal.memFree(p6);
+}
+
+TEST(PAL_POOL, exhausted)
+{
+    SmallPoolPAL pal;
+    void *ptrs[5];
+
+    for (auto &p : ptrs)
+        p = pal.memAlloc(100);
+
+    // 128 and 1K blocks, then the heap
+    EXPECT_TRUE(pal.isPoolBlock(ptrs[0]));
+    EXPECT_TRUE(pal.isPoolBlock(ptrs[1]));
+    EXPECT_FALSE(pal.isPoolBlock(ptrs[2]));
+    EXPECT_EQ(3u, pal.stats.poolFallbacks);
+    EXPECT_EQ(4, pal.stats.pPools[2].failures);
+
+    for (auto p : ptrs)
+        pal.memFree(p);
+
+    EXPECT_EQ(0, pal.stats.memChunks);
+}
+
+TEST(PAL_POOL, threads)
+{
+    struct LockingPAL : SmallPoolPAL
+    {
+        bool lock(bool wait) override
+        {
+            if (wait)
+            {
+                mtx.lock();
+                return true;
+            }
+            return mtx.try_lock();
+        }
+
+        void unlock() override
+        {
+            mtx.unlock();
+        }
+
+        std::recursive_mutex mtx;
+    };
+
+    LockingPAL pal;
+    std::vector<std::thread> threads;
+
+    for (int t = 0; t < 4; t++)
+    {
+        threads.emplace_back([&pal]() {
+            // pool blocks only, to keep the threads on the free lists
+            for (int i = 0; i < 20000; i++)
+            {
+                void *p = pal.memAlloc(20);
+                if (pal.isPoolBlock(p))
+                    *(volatile int*)p = i;
+                pal.memFree(p);
+            }
+        });
+    }
+
+    for (auto &th : threads)
+        th.join();
+
+    // free lists and statistics intact
+    const auto &st = pal.stats;
+    EXPECT_EQ(0, st.memChunks);
+    EXPECT_EQ(0, st.memAllocated);
+    EXPECT_EQ(80000u, st.memAllocCount);
+
+    for (unsigned p = 0; p < st.poolsCount; p++)
+        EXPECT_EQ(0, st.pPools[p].blocksUsed);
+
+    // all blocks are back on the free lists
+    std::vector<void*> ptrs;
+    for (int i = 0; i < 2; i++)
+        ptrs.push_back(pal.memAlloc(32));
+    EXPECT_TRUE(pal.isPoolBlock(ptrs[0]));
+    EXPECT_TRUE(pal.isPoolBlock(ptrs[1]));
+    EXPECT_NE(ptrs[0], ptrs[1]);
+    for (auto p : ptrs)
+        pal.memFree(p);
+}
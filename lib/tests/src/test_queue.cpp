@@ -73,3 +73,34 @@ TEST(QUEUE, write_read_string)
     EXPECT_EQ(2, qstr.size());
     EXPECT_TRUE(s.empty());
 }
+
+// -----------------------------------------------------------------------------
+
+TEST(STATIC_QUEUE, write_read_overflow)
+{
+    twins::StaticQueue<std::string, 3> q;
+    EXPECT_EQ(0, q.size());
+    EXPECT_EQ(3, q.capacity());
+    EXPECT_EQ(nullptr, q.front());
+
+    EXPECT_TRUE(q.write("a"));
+    EXPECT_TRUE(q.write("b"));
+    EXPECT_TRUE(q.write("c"));
+    EXPECT_FALSE(q.write("d"));
+    EXPECT_EQ(1, q.overflows());
+    EXPECT_EQ(3, q.size());
+
+    EXPECT_EQ("a", q.read());
+    // wrap around
+    EXPECT_TRUE(q.write("e"));
+    EXPECT_EQ("b", *q.front());
+    EXPECT_EQ("b", q.read());
+    EXPECT_EQ("c", q.read());
+    EXPECT_EQ("e", q.read());
+    EXPECT_EQ("", q.read());
+
+    q.write("x");
+    q.clear();
+    EXPECT_EQ(0, q.size());
+    EXPECT_EQ(nullptr, q.front());
+}
@@ -0,0 +1,196 @@
+/******************************************************************************
+ * @brief   TWins - unit tests
+ * @author  Mariusz Midor
+ *          https://bitbucket.org/marmidr/twins
+ *****************************************************************************/
+
+#include "gtest/gtest.h"
+#include "gmock/gmock.h"
+
+#include "twins.hpp"
+
+#include <thread>
+
+// -----------------------------------------------------------------------------
+
+TEST(SPSC_RINGBUFF, write_read)
+{
+    char buff[8];
+    twins::SpscRingBuff<char> rb(buff);
+
+    EXPECT_EQ(8, rb.capacity());
+    EXPECT_EQ(0, rb.size());
+
+    char c = 0;
+    EXPECT_FALSE(rb.read(c));
+    EXPECT_TRUE(rb.write("abcde"));
+    EXPECT_EQ(5, rb.size());
+    EXPECT_FALSE(rb.write("1234"));
+    EXPECT_TRUE(rb.write("123"));
+    EXPECT_TRUE(rb.isFull());
+    EXPECT_FALSE(rb.write('x'));
+
+    EXPECT_TRUE(rb.read(c));
+    EXPECT_EQ('a', c);
+
+    char out[10] = {};
+    EXPECT_EQ(4, rb.copy(out, 4));
+    EXPECT_STREQ("bcde", out);
+    EXPECT_EQ(7, rb.size());
+
+    // wrap around
+    EXPECT_TRUE(rb.write('X'));
+    memset(out, 0, sizeof(out));
+    EXPECT_EQ(8, rb.read(out, sizeof(out)));
+    EXPECT_STREQ("bcde123X", out);
+    EXPECT_EQ(0, rb.size());
+
+    rb.write("zz");
+    rb.clear();
+    EXPECT_EQ(0, rb.size());
+}
+
+TEST(SPSC_RINGBUFF, index_overflow)
+{
+    twins::SpscRingBuff<uint16_t> rb;
+    rb.init(4);
+    EXPECT_EQ(4, rb.capacity());
+
+    // free-running indexes wrap at 65536
+    for (unsigned i = 0; i < 70000; i++)
+    {
+        ASSERT_TRUE(rb.write(uint16_t(i)));
+        uint16_t v = 0;
+        ASSERT_TRUE(rb.read(v));
+        ASSERT_EQ(uint16_t(i), v);
+    }
+
+    EXPECT_EQ(0, rb.size());
+}
+
+TEST(SPSC_RINGBUFF, producer_thread)
+{
+    static uint32_t buff[64];
+    twins::SpscRingBuff<uint32_t> rb(buff);
+    const uint32_t n = 200000;
+
+    std::thread producer([&rb, n]()
+    {
+        for (uint32_t i = 1; i <= n; )
+            if (rb.write(i)) i++;
+    });
+
+    uint32_t expected = 1;
+    uint32_t items[16];
+
+    while (expected <= n)
+    {
+        uint16_t cnt = rb.read(items, 16);
+        for (uint16_t i = 0; i < cnt; i++)
+            ASSERT_EQ(expected++, items[i]);
+    }
+
+    producer.join();
+    EXPECT_EQ(0, rb.size());
+}
+
+TEST(SPSC_RINGBUFF, decode_input)
+{
+    char buff[16];
+    twins::SpscRingBuff<char> input(buff);
+    twins::KeyCode kc;
+
+    input.write("\e[Aa");
+    EXPECT_EQ(3, twins::decodeInputSeq(input, kc));
+    EXPECT_EQ(twins::Key::Up, kc.key);
+    EXPECT_EQ(1, twins::decodeInputSeq(input, kc));
+    EXPECT_STREQ("a", kc.utf8);
+    EXPECT_EQ(0, input.size());
+}
+
+// -----------------------------------------------------------------------------
+
+TEST(RINGBUFF, write_read_wrap)
+{
+    char buff[8];
+    twins::RingBuff<char> rb(buff);
+    char out[10] = {};
+
+    EXPECT_TRUE(rb.write("abcdef"));
+    EXPECT_EQ(4, rb.read(out, 4));
+    EXPECT_STREQ("abcd", out);
+
+    // write across the buffer end
+    EXPECT_TRUE(rb.write("123456"));
+    EXPECT_FALSE(rb.write("xyz"));
+    EXPECT_TRUE(rb.isFull());
+
+    memset(out, 0, sizeof(out));
+    EXPECT_EQ(8, rb.copy(out, sizeof(out)));
+    EXPECT_STREQ("ef123456", out);
+    EXPECT_EQ(8, rb.size());
+
+    rb.skip(3);
+    memset(out, 0, sizeof(out));
+    EXPECT_EQ(5, rb.read(out, sizeof(out)));
+    EXPECT_STREQ("23456", out);
+    EXPECT_EQ(0, rb.size());
+}
+
+TEST(RINGBUFF, spans)
+{
+    char buff[8];
+    twins::RingBuff<char> rb(buff);
+    twins::Span<const char> r1, r2;
+    twins::Span<char> w1, w2;
+
+    EXPECT_EQ(0, rb.readSpans(r1, r2));
+    EXPECT_EQ(0u, r1.size);
+    EXPECT_EQ(0u, r2.size);
+
+    rb.write("abcdef");
+    rb.skip(5);
+
+    // free space wraps around
+    EXPECT_EQ(7, rb.writeSpans(w1, w2));
+    EXPECT_EQ(2u, w1.size);
+    EXPECT_EQ(5u, w2.size);
+    EXPECT_EQ(buff + 6, w1.data);
+    EXPECT_EQ(buff, w2.data);
+    memcpy(w1.data, "gh", 2);
+    memcpy(w2.data, "ij", 2);
+    rb.commitWrite(4);
+    EXPECT_EQ(5, rb.size());
+
+    // data wraps around
+    EXPECT_EQ(5, rb.readSpans(r1, r2));
+    EXPECT_EQ(3u, r1.size);
+    EXPECT_EQ(0, strncmp("fgh", r1.data, r1.size));
+    EXPECT_EQ(2u, r2.size);
+    EXPECT_EQ(0, strncmp("ij", r2.data, r2.size));
+
+    rb.skip(3);
+    EXPECT_EQ(2, rb.readSpans(r1, r2));
+    EXPECT_EQ(2u, r1.size);
+    EXPECT_EQ(0u, r2.size);
+}
+
+TEST(RINGBUFF, decode_wrapped_seq)
+{
+    char buff[8];
+    twins::RingBuff<char> input(buff);
+    twins::KeyCode kc;
+
+    // put the ESC sequence across the buffer end
+    input.write("xxxxxx");
+    input.skip(6);
+    input.write("\e[1;5A");
+    twins::Span<const char> r1, r2;
+    input.readSpans(r1, r2);
+    EXPECT_EQ(2u, r1.size);
+
+    EXPECT_EQ(6, twins::decodeInputSeq(input, kc));
+    EXPECT_EQ(twins::Key::Up, kc.key);
+    EXPECT_TRUE(kc.m_ctrl);
+    EXPECT_EQ(0, input.size());
+}
@@ -72,3 +72,55 @@ TEST(STACK, destroy_string)
 
     stck.clear(true);
 }
+
+// -----------------------------------------------------------------------------
+
+TEST(STATIC_STACK, push_pop_overflow)
+{
+    twins::StaticStack<int, 3> s;
+    EXPECT_EQ(0, s.size());
+    EXPECT_EQ(3, s.capacity());
+    EXPECT_EQ(nullptr, s.top());
+    EXPECT_EQ(nullptr, s.pop());
+
+    s.push(1);
+    s.push(2);
+    s.push(3);
+    EXPECT_EQ(3, s.size());
+    EXPECT_EQ(0, s.overflows());
+
+    s.push(4);
+    s.push(5);
+    EXPECT_EQ(3, s.size());
+    EXPECT_EQ(5, s.depth());
+    EXPECT_EQ(2, s.overflows());
+    EXPECT_EQ(3, *s.top());
+
+    // pops matching the dropped pushes do not touch the stored items
+    EXPECT_EQ(nullptr, s.pop());
+    EXPECT_EQ(nullptr, s.pop());
+    EXPECT_EQ(3, s.size());
+    EXPECT_EQ(3, s.depth());
+
+    EXPECT_EQ(3, *s.pop());
+    EXPECT_EQ(2, *s.pop());
+    EXPECT_EQ(1, s.size());
+    EXPECT_EQ(1, s.depth());
+    EXPECT_EQ(3, s.sizeMax());
+
+    // push after the overflow is stored again
+    s.push(6);
+    EXPECT_EQ(6, *s.pop());
+    EXPECT_EQ(1, *s.pop());
+    EXPECT_EQ(nullptr, s.pop());
+    EXPECT_EQ(0, s.depth());
+
+    s.push(7);
+    s.push(8);
+    s.push(9);
+    s.push(10);
+    s.clear();
+    EXPECT_EQ(0, s.size());
+    EXPECT_EQ(0, s.depth());
+    EXPECT_EQ(3, s.overflows());
+}
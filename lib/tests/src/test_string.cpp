@@ -73,15 +73,16 @@ TEST_F(STRING_Test, append_no_resize)
         EXPECT_STREQ("Cześć", s.cstr());
         EXPECT_EQ(7, s.size());
         EXPECT_EQ(5, s.u8len());
-        EXPECT_EQ(1, pal.stats.memChunks);
+        // short string is stored inline
+        EXPECT_EQ(0, pal.stats.memChunks);
 
         s.clear();
-        EXPECT_EQ(1, pal.stats.memChunks);
+        EXPECT_EQ(0, pal.stats.memChunks);
         EXPECT_EQ(0, s.size());
         EXPECT_EQ(0, s.u8len());
     }
 
-    EXPECT_EQ(1, pal.stats.memChunksMax);
+    EXPECT_EQ(0, pal.stats.memChunksMax);
 }
 
 TEST_F(STRING_Test, append_resize_buffer)
@@ -103,7 +104,8 @@ TEST_F(STRING_Test, append_resize_buffer)
         EXPECT_EQ(1, s.u8len());
     }
 
-    EXPECT_EQ(2, pal.stats.memChunksMax);
+    // inline buffer -> heap, no reallocation
+    EXPECT_EQ(1, pal.stats.memChunksMax);
 }
 
 TEST_F(STRING_Test, append_very_long)
@@ -119,6 +121,25 @@ TEST_F(STRING_Test, append_very_long)
     EXPECT_EQ(1, s.size());
 }
 
+TEST_F(STRING_Test, append_repeat)
+{
+    twins::String s;
+    s.append("ab", 7);
+    EXPECT_STREQ("ababababababab", s.cstr());
+    EXPECT_EQ(14, s.size());
+
+    s.append("", 5);
+    EXPECT_EQ(14, s.size());
+
+    s.append('-', 3);
+    EXPECT_STREQ("ababababababab---", s.cstr());
+
+    s.clear();
+    s.append("xyz", 1);
+    s.append("12", 0);
+    EXPECT_STREQ("xyz", s.cstr());
+}
+
 TEST_F(STRING_Test, append_esc)
 {
     twins::String s;
@@ -156,10 +177,10 @@ TEST_F(STRING_Test, append_fmt__fits_in_buffer)
         s.appendFmt("%s:%4u", "Fun()", 2048);
         EXPECT_EQ(15, s.size());
         EXPECT_TRUE(strstr(s.cstr(), ":2048"));
-        EXPECT_EQ(1, pal.stats.memChunks);
+        EXPECT_EQ(0, pal.stats.memChunks);
     }
 
-    EXPECT_EQ(1, pal.stats.memChunksMax);
+    EXPECT_EQ(0, pal.stats.memChunksMax);
 }
 
 TEST_F(STRING_Test, append_fmt__buffer_to_small)
@@ -169,13 +190,17 @@ TEST_F(STRING_Test, append_fmt__buffer_to_small)
         s.append("12345", 6);
         EXPECT_EQ(30, s.size());
 
-        s.appendFmt("%s:%4u", "Fun()", 2048); // buffer must be expanded
+        s.appendFmt("%s:%4u", "Fun()", 2048); // buffer must be expanded, unless grown geometrically
         EXPECT_TRUE(strstr(s.cstr(), ":2048"));
         EXPECT_EQ(40, s.size());
         EXPECT_EQ(1, pal.stats.memChunks);
     }
 
+#if TWINS_LARGE_STRING
+    EXPECT_EQ(1, pal.stats.memChunksMax);
+#else
     EXPECT_EQ(2, pal.stats.memChunksMax);
+#endif
 }
 
 TEST_F(STRING_Test, stream_append)
@@ -317,6 +342,43 @@ TEST_F(STRING_Test, move_assign)
     EXPECT_EQ(4, s3.size());
 }
 
+TEST_F(STRING_Test, inline_buffer)
+{
+    {
+        twins::String s("1234567890123456789012");
+        twins::String s2(s);
+        EXPECT_EQ(0, pal.stats.memAllocCount);
+
+        // beyond the inline buffer
+        s.append("ABCDEFGHIJKL");
+        EXPECT_EQ(1, pal.stats.memAllocCount);
+        EXPECT_STREQ("1234567890123456789012ABCDEFGHIJKL", s.cstr());
+
+        // heap buffer is taken over, inline one is copied
+        twins::String s3(std::move(s));
+        twins::String s4(std::move(s2));
+        EXPECT_EQ(1, pal.stats.memAllocCount);
+        EXPECT_STREQ("", s.cstr());
+        EXPECT_STREQ("", s2.cstr());
+        EXPECT_STREQ("1234567890123456789012ABCDEFGHIJKL", s3.cstr());
+        EXPECT_STREQ("1234567890123456789012", s4.cstr());
+
+        s4 = std::move(s3);
+        EXPECT_STREQ("1234567890123456789012ABCDEFGHIJKL", s4.cstr());
+        EXPECT_EQ(0, s3.size());
+        s3.append("xyz");
+        EXPECT_STREQ("xyz", s3.cstr());
+        EXPECT_EQ(1, pal.stats.memChunks);
+
+        // big buffer released - back to inline one
+        s4.clear(0);
+        EXPECT_EQ(0, pal.stats.memChunks);
+        s4.append("Cześć");
+        EXPECT_STREQ("Cześć", s4.cstr());
+        EXPECT_EQ(1, pal.stats.memAllocCount);
+    }
+}
+
 TEST_F(STRING_Test, erase)
 {
     {
@@ -433,6 +495,27 @@ TEST_F(STRING_Test, u8len_IgnoreEsc)
     EXPECT_EQ(4, twins::String::u8len("Ą\e[ABĆ\e[48;2;255;255;255mĘ", nullptr, true));
 }
 
+TEST_F(STRING_Test, u8len_LongBlocks)
+{
+    // longer texts go through block-wise fast path
+    const char *ascii = "The quick brown fox jumps over the lazy dog";
+    EXPECT_EQ(43, twins::String::u8len(ascii, nullptr, true));
+    EXPECT_EQ(43, twins::String::width(ascii));
+    EXPECT_EQ(10, twins::String::width(ascii, ascii + 10));
+
+    const char *pl = "Zażółć gęślą jaźń, zażółć gęślą jaźń";
+    EXPECT_EQ(36, twins::String::u8len(pl, nullptr, true));
+    EXPECT_EQ(36, twins::String::width(pl));
+
+    const char *mixed = "Status:" ESC_BOLD " ready and waiting " ESC_NORMAL "\e[48;2;255;255;255m-- ĄĘ --" ESC_BG_DEFAULT "!";
+    EXPECT_EQ(35, twins::String::u8len(mixed, nullptr, true));
+    EXPECT_EQ(35, twins::String::width(mixed));
+
+    // wide glyphs after long ASCII prefix
+    EXPECT_EQ(20, twins::String::width("0123456789ABCDEF🔶🔷"));
+    EXPECT_EQ(18, twins::String::u8len("0123456789ABCDEF🔶🔷", nullptr, true));
+}
+
 TEST_F(STRING_Test, u8skipEsc)
 {
     EXPECT_STREQ("", twins::String::u8skip(nullptr, 0));
@@ -460,6 +543,84 @@ TEST_F(STRING_Test, emoticons)
     EXPECT_EQ( 5, s.width());
 }
 
+TEST_F(STRING_Test, cached_width)
+{
+    twins::String s("中文");
+    EXPECT_EQ(4, s.width());
+    EXPECT_EQ(2, s.u8len());
+    EXPECT_EQ(4, s.width());
+
+    s.append(ESC_BOLD "ab");
+    EXPECT_EQ(6, s.width());
+    s.insert(0, "x");
+    EXPECT_EQ(7, s.width());
+    s.erase(0, 2);
+    EXPECT_EQ(4, s.width());
+    s.setWidth(8);
+    EXPECT_EQ(8, s.width());
+    EXPECT_EQ(8, twins::String::width(s.cstr()));
+    s.trim(3, false, true);
+    EXPECT_EQ(twins::String::width(s.cstr()), s.width());
+    s = "abc";
+    EXPECT_EQ(3, s.width());
+
+    twins::String s2(std::move(s));
+    EXPECT_EQ(0, s.width());
+    EXPECT_EQ(3, s2.width());
+
+    twins::StringBuff sb("abc");
+    EXPECT_EQ(3, sb.width());
+    memcpy(sb.data(), "\e[A", 3);
+    EXPECT_EQ(0, sb.width());
+}
+
+TEST_F(STRING_Test, cached_len_and_width)
+{
+    twins::String s("中文");
+    EXPECT_EQ(4, s.width());
+    EXPECT_EQ(2, s.u8len());
+
+    // bypass the String API: both results come from the cache, not from the buffer
+    memcpy(const_cast<char*>(s.cstr()), "abcdef", 6);
+    EXPECT_EQ(4, s.width());
+    EXPECT_EQ(2, s.u8len());
+    EXPECT_EQ(4, s.width());
+    // not cached modes
+    EXPECT_EQ(6, s.u8len(true));
+    EXPECT_EQ(6, s.u8len(false, true));
+
+    s.append("g");
+    EXPECT_EQ(7, s.width());
+    EXPECT_EQ(7, s.u8len());
+}
+
+TEST_F(STRING_Test, charWidth)
+{
+    EXPECT_EQ(1, twins::String::charWidth('A'));
+    EXPECT_EQ(1, twins::String::charWidth(0x0104));     // Ą
+    EXPECT_EQ(0, twins::String::charWidth(0x0301));     // combining acute accent
+    EXPECT_EQ(0, twins::String::charWidth(0x200D));     // zero width joiner
+    EXPECT_EQ(0, twins::String::charWidth(0xFE0F));     // variation selector-16
+    EXPECT_EQ(2, twins::String::charWidth(0x4E2D));     // 中
+    EXPECT_EQ(2, twins::String::charWidth(0xAC00));     // 가
+    EXPECT_EQ(2, twins::String::charWidth(0xFF21));     // fullwidth A
+    EXPECT_EQ(2, twins::String::charWidth(0x1F609));    // 😉
+    EXPECT_EQ(2, twins::String::charWidth(0x20000));    // CJK ext. B
+    EXPECT_EQ(0, twins::String::charWidth(0xE0100));    // variation selector-17
+    EXPECT_EQ(1, twins::String::charWidth(0x10FFFF));
+}
+
+TEST_F(STRING_Test, width_cjk_combining)
+{
+    EXPECT_EQ(4, twins::String::width("中文"));
+    EXPECT_EQ(9, twins::String::width("日本語 ok"));
+    // e + combining acute
+    EXPECT_EQ(1, twins::String::width("e\u0301"));
+    // family emoji: man ZWJ woman
+    EXPECT_EQ(4, twins::String::width("👨\u200D👩"));
+    EXPECT_EQ(3, twins::String::u8len("👨\u200D👩", nullptr, true));
+}
+
 TEST_F(STRING_Test, startsWith)
 {
     {
@@ -44,6 +44,7 @@ TEST(UTILS, splitWords)
     {
         auto words = twins::util::splitWords(" abc def ");
         ASSERT_EQ(2, words.size());
+        EXPECT_TRUE(words.isInline());
 
         EXPECT_STREQ("abc", MKSTDSTR(words[0]));
         EXPECT_STREQ("def", MKSTDSTR(words[1]));
@@ -420,4 +421,13 @@ TEST(UTILS, numEditLimited)
         EXPECT_TRUE(succ);
         EXPECT_STREQ("1", str.cstr());
     }
+
+    // coalesced key repeats - the same as separate steps
+    {
+        str = "1";
+        kc.repeat = 4;
+        succ = twins::util::numEditInputEvt(kc, str, cursorPos, -1, 1, true);
+        EXPECT_TRUE(succ);
+        EXPECT_STREQ("0", str.cstr());
+    }
 }
@@ -8,6 +8,9 @@
 #include "gmock/gmock.h"
 
 #include "twins_vector.hpp"
+#include "twins_small_vector.hpp"
+#include "twins_arena.hpp"
+#include "twins_pal_defimpl.hpp"
 
 // -----------------------------------------------------------------------------
 
@@ -201,3 +204,116 @@ TEST(VECTOR, std_string)
     v.append(s);
     v.insert(0, "X");
 }
+
+// -----------------------------------------------------------------------------
+
+TEST(SMALL_VECTOR, inline_storage)
+{
+    auto &pal = (twins::DefaultPAL&)*twins::pPAL;
+    pal.stats = {};
+
+    {
+        twins::SmallVector<int, 4> v;
+        EXPECT_EQ(0, v.size());
+        EXPECT_EQ(4, v.capacity());
+        EXPECT_TRUE(v.isInline());
+
+        v.append({1, 2, 3, 4});
+        EXPECT_EQ(4, v.size());
+        EXPECT_TRUE(v.isInline());
+        EXPECT_EQ(0, pal.stats.memAllocCount);
+        EXPECT_EQ(3, v[2]);
+
+        // spill to the heap
+        v.append(5);
+        EXPECT_FALSE(v.isInline());
+        EXPECT_EQ(8, v.capacity());
+        EXPECT_EQ(1, pal.stats.memChunks);
+
+        int sum = 0;
+        for (int i : v) sum += i;
+        EXPECT_EQ(15, sum);
+
+        v.clear();
+        EXPECT_TRUE(v.isInline());
+        EXPECT_EQ(0, pal.stats.memChunks);
+    }
+
+    EXPECT_EQ(0, pal.stats.memChunks);
+}
+
+TEST(SMALL_VECTOR, copy_move)
+{
+    twins::SmallVector<std::string, 2> v1;
+    v1.append("abc");
+    v1.append(std::string(100, 'x'));
+
+    // inline content moved item by item
+    twins::SmallVector<std::string, 2> v2(std::move(v1));
+    EXPECT_EQ(0, v1.size());
+    EXPECT_EQ(2, v2.size());
+    EXPECT_EQ("abc", v2[0]);
+
+    // heap buffer taken over
+    v2.append("def");
+    EXPECT_FALSE(v2.isInline());
+    const auto *p_items = v2.data();
+    twins::SmallVector<std::string, 2> v3;
+    v3 = std::move(v2);
+    EXPECT_EQ(p_items, v3.data());
+    EXPECT_TRUE(v2.isInline());
+    EXPECT_EQ(0, v2.size());
+
+    twins::SmallVector<std::string, 2> v4(v3);
+    EXPECT_EQ(3, v4.size());
+    EXPECT_EQ("def", *v4.back());
+    EXPECT_TRUE(v4.contains("abc"));
+
+    EXPECT_TRUE(v4.remove(0, true));
+    EXPECT_EQ(2, v4.size());
+    EXPECT_EQ("def", v4[1]);
+    EXPECT_FALSE(v4.remove(5));
+}
+
+TEST(SMALL_VECTOR, size_type)
+{
+    twins::SmallVector<uint8_t, 16, uint32_t> v;
+    v.reserve(70000);
+    EXPECT_EQ(70000u, v.capacity());
+
+    for (unsigned i = 0; i < 70000; i++)
+        v.append(uint8_t(i));
+
+    EXPECT_EQ(70000u, v.size());
+    EXPECT_EQ(uint8_t(69999), *v.back());
+}
+
+TEST(SMALL_VECTOR, allocators)
+{
+    {
+        twins::SmallVector<int, 2, uint16_t, twins::NoAllocator> v;
+        EXPECT_TRUE(v.reserve(2));
+        EXPECT_FALSE(v.reserve(3));
+        EXPECT_TRUE(v.append(1));
+        EXPECT_TRUE(v.append(2));
+        EXPECT_EQ(2, v.capacity());
+        // full: append fails instead of aborting, content intact
+        EXPECT_FALSE(v.append(3));
+        EXPECT_FALSE(v.append({4, 5}));
+        EXPECT_EQ(2, v.size());
+        EXPECT_EQ(2, v.capacity());
+        EXPECT_TRUE(v.isInline());
+        EXPECT_EQ(1, v[0]);
+        EXPECT_EQ(2, v[1]);
+    }
+
+    {
+        twins::FrameArenaScope arena_scope;
+        auto used = twins::frameArena().used();
+        twins::SmallVector<int, 2, uint16_t, twins::FrameAllocator> v;
+        v.append({1, 2, 3});
+        EXPECT_FALSE(v.isInline());
+        EXPECT_TRUE(twins::frameArena().owns(v.data()));
+        EXPECT_GT(twins::frameArena().used(), used);
+    }
+}
@@ -11,10 +11,18 @@
 #include "twins.hpp"
 #include "twins_utils.hpp"
 #include "twins_window_mngr.hpp"
-#include "../../lib/src/twins_widget_prv.hpp"
+#include "twins_window_state_base.hpp"
+#include "twins_window_state_crtp_inst.hpp"
+#include "../../src/twins_widget_draw_impl.hpp"
+
+#include <string>
+#include <vector>
 
 // -----------------------------------------------------------------------------
 
+// defined in test_main.cpp
+extern std::string *pTestOutput;
+
 enum WndTestIDs
 {
     ID_INVALID,
@@ -54,6 +62,25 @@ public:
     void getLabelText(const twins::Widget*, twins::String &out) override
     {
         out = "Label 1" "\n" "..but Line 2";
+        labelTextCalls++;
+    }
+
+    twins::CStrView getLabelTextView(const twins::Widget*) override
+    {
+        if (!pLabelView)
+            return {};
+
+        labelViewCalls++;
+        // deliberately not NUL-terminated at the view end
+        return { pLabelView, (unsigned)strlen(pLabelView) - 3 };
+    }
+
+    twins::CStrView getListBoxItemView(const twins::Widget*, int itemIdx) override
+    {
+        static const char *items[] = { "Alpha", "Beta", "Gamma" };
+        if (!useItemViews || itemIdx < 0 || itemIdx > 2)
+            return {};
+        return { items[itemIdx], (unsigned)strlen(items[itemIdx]) };
     }
 
     void getListBoxState(const twins::Widget*, int16_t &itemIdx, int16_t &selIdx, int16_t &itemsCount) override
@@ -120,18 +147,48 @@ public:
         chbxChecked = !chbxChecked;
     }
 
+    void onTextEditChange(const twins::Widget* pWgt, twins::String &&str) override
+    {
+        editText = std::move(str);
+    }
+
+    void onListBoxSelect(const twins::Widget* pWgt, int16_t selIdx) override
+    {
+        listSelIdx = selIdx;
+        listSelCalls++;
+    }
+
     bool getCheckboxChecked(const twins::Widget* pWgt) override
     {
         return chbxChecked;
     }
 
+    const twins::FocusEntry* getFocusOrder() const override
+    {
+        return pFocusOrder;
+    }
+
+    const twins::WidgetColumns* getWidgetColumns() const override
+    {
+        return pColumns;
+    }
+
 public:
     const twins::Widget *mpWgts = nullptr;
+    const twins::FocusEntry *pFocusOrder = nullptr;
+    const twins::WidgetColumns *pColumns = nullptr;
     twins::WID wgtId = {};
     twins::WID clickedId = {};
     twins::util::WrappedString wrapString;
     uint8_t pgIndex = 0;
     bool chbxChecked = {};
+    twins::String editText;
+    int listSelIdx = -1;
+    int listSelCalls = 0;
+    int labelTextCalls = 0;
+    int labelViewCalls = 0;
+    const char *pLabelView = nullptr;
+    bool useItemViews = false;
 };
 
 
@@ -367,6 +424,9 @@ static constexpr twins::Widget wndTestDef =
 
 constexpr auto wndTestWidgets = twins::transforWindowDefinition<&wndTestDef>();
 const twins::Widget * pWndTestWidgets = wndTestWidgets.begin();
+constexpr auto wndTestFocusOrder = twins::transformWindowFocusOrder<&wndTestDef>();
+constexpr auto wndTestColumnsArr = twins::transformWindowColumns<&wndTestDef>();
+const twins::WidgetColumns wndTestColumns = wndTestColumnsArr.getColumns();
 
 twins::IWindowState * getWndTest()
 {
@@ -415,6 +475,11 @@ TEST_F(WIDGET, isPointIn)
     // rect is empty
     r.size = {0, 0};
     EXPECT_FALSE(twins::isPointWithin(2, 1, r));
+
+    // column beyond 255 is not truncated
+    r = { {40, 1}, {10, 5} };
+    EXPECT_TRUE(twins::isPointWithin(42, 1, r));
+    EXPECT_FALSE(twins::isPointWithin(42 + 256, 1, r));
 }
 
 TEST_F(WIDGET, isRectIn)
@@ -464,6 +529,63 @@ TEST_F(WIDGET, drawWidgets)
     twins::drawWidgets(pWndTestWidgets, wids);
 }
 
+TEST_F(WIDGET, drawWidgets_ancestorCovered)
+{
+    const auto *p_wnd = getWndTest()->getWidgets();
+    wndTest.pgIndex = 0;
+
+    wndTest.labelTextCalls = 0;
+    twins::drawWidgets(p_wnd, {ID_PAGE1});
+    const int page_label_calls = wndTest.labelTextCalls;
+    EXPECT_GT(page_label_calls, 0);
+
+    // labels are drawn by the page anyway, duplicates are ignored
+    wndTest.labelTextCalls = 0;
+    twins::drawWidgets(p_wnd, {ID_LBL1, ID_PAGE1, ID_LBL2, ID_LBL1});
+    EXPECT_EQ(page_label_calls, wndTest.labelTextCalls);
+
+    wndTest.labelTextCalls = 0;
+    twins::drawWidgets(p_wnd, {ID_LBL1, ID_LBL2});
+    EXPECT_EQ(page_label_calls, wndTest.labelTextCalls);
+}
+
+TEST_F(WIDGET, drawWidgets_textViews)
+{
+    const auto *p_wnd = getWndTest()->getWidgets();
+    wndTest.pgIndex = 0;
+
+    // view bytes continue past its size - only the first size bytes are drawn
+    std::string out, out_ref;
+    twins::flushBuffer();
+    wndTest.pLabelView = "View label" "\n" "line 2~~~";
+    wndTest.useItemViews = true;
+    wndTest.labelTextCalls = 0;
+    wndTest.labelViewCalls = 0;
+    pTestOutput = &out;
+    twins::drawWidgets(p_wnd, {ID_LBL1, ID_LISTBOX});
+    twins::flushBuffer();
+    EXPECT_EQ(0, wndTest.labelTextCalls);
+    EXPECT_GT(wndTest.labelViewCalls, 0);
+
+    wndTest.pLabelView = "View label" "\n" "line 2!!!";
+    pTestOutput = &out_ref;
+    twins::drawWidgets(p_wnd, {ID_LBL1, ID_LISTBOX});
+    twins::flushBuffer();
+    pTestOutput = nullptr;
+
+    EXPECT_EQ(out_ref, out);
+    EXPECT_NE(std::string::npos, out.find("View label"));
+    EXPECT_NE(std::string::npos, out.find("line 2"));
+    EXPECT_EQ(std::string::npos, out.find("~"));
+    EXPECT_NE(std::string::npos, out.find("Beta"));
+
+    // no view - fallback to String getter
+    wndTest.pLabelView = nullptr;
+    wndTest.useItemViews = false;
+    twins::drawWidgets(p_wnd, {ID_LBL1});
+    EXPECT_GT(wndTest.labelTextCalls, 0);
+}
+
 TEST_F(WIDGET, wndManager)
 {
     twins::WndManager wmngr;
@@ -615,6 +737,114 @@ TEST_F(WIDGET, processInput_Key)
     }
 }
 
+TEST_F(WIDGET, processInputBatch)
+{
+    const auto *p_wnd = wndTest.getWidgets();
+    ASSERT_NE(nullptr, p_wnd);
+
+    twins::KeyCode keys[3] = {};
+    keys[0].key = twins::Key::Tab;
+    keys[0].m_spec = true;
+    keys[1].key = twins::Key::Tab;
+    keys[1].m_spec = true;
+    keys[2].key = twins::Key::Esc;
+    keys[2].m_spec = true;
+
+    EXPECT_EQ(0, twins::processInputBatch(p_wnd, keys, 0));
+
+    // reference: keys processed one by one
+    twins::resetInternalState();
+    wndTest.wgtId = twins::WIDGET_ID_NONE;
+    uint16_t handled = 0;
+    twins::WID focused[2] = {};
+
+    for (int i = 0; i < 3; i++)
+    {
+        if (twins::processInput(p_wnd, keys[i]))
+            handled++;
+        if (i < 2)
+            focused[i] = wndTest.wgtId;
+    }
+
+    const twins::WID focused_last = wndTest.wgtId;
+    // each Tab moves the focus
+    EXPECT_NE(twins::WIDGET_ID_NONE, focused[0]);
+    EXPECT_NE(twins::WIDGET_ID_NONE, focused[1]);
+    EXPECT_NE(focused[0], focused[1]);
+
+    // batch gives the same result
+    twins::resetInternalState();
+    wndTest.wgtId = twins::WIDGET_ID_NONE;
+    EXPECT_EQ(handled, twins::processInputBatch(p_wnd, keys, 3));
+    EXPECT_EQ(focused_last, wndTest.wgtId);
+
+    twins::resetInternalState();
+    wndTest.wgtId = twins::WIDGET_ID_NONE;
+    EXPECT_EQ(2, twins::processInputBatch(p_wnd, keys, 2));
+    EXPECT_EQ(focused[1], wndTest.wgtId);
+}
+
+TEST_F(WIDGET, processInputBatch_singleRedraw)
+{
+    struct TestState : twins::WindowStateBase
+    {
+        void invalidateImpl(const twins::WID *pId, uint16_t count, bool instantly) override
+        {
+            // output is collected on flush
+            outputSizes.push_back(pTestOutput->size());
+            WindowStateBase::invalidateImpl(pId, count, instantly);
+        }
+
+        void onCheckboxToggle(const twins::Widget* pWgt) override
+        {
+            // as if another window was shown
+            twins::flushDeferredRedraw();
+        }
+
+        std::vector<size_t> outputSizes;
+    };
+
+    TestState state;
+    state.init(getWndTest()->getWidgets());
+
+    twins::KeyCode keys[2] = {};
+    keys[0].key = twins::Key::Tab;
+    keys[0].m_spec = true;
+    keys[1] = keys[0];
+
+    std::string out;
+    twins::resetInternalState();
+    twins::flushBuffer();
+    pTestOutput = &out;
+
+    // nothing drawn until the whole batch is processed
+    uint16_t processed = 0;
+    EXPECT_EQ(2, twins::processInputBatch(state, keys, 2, &processed));
+    EXPECT_EQ(2, processed);
+    EXPECT_GE(state.outputSizes.size(), 2u);
+    for (auto sz : state.outputSizes)
+        EXPECT_EQ(0u, sz);
+    EXPECT_FALSE(out.empty());
+
+    // one by one - drawn immediately
+    out.clear();
+    state.outputSizes.clear();
+    EXPECT_TRUE(twins::processInput(state, keys[0]));
+    EXPECT_TRUE(twins::processInput(state, keys[1]));
+    ASSERT_GE(state.outputSizes.size(), 2u);
+    EXPECT_GT(state.outputSizes.back(), 0u);
+
+    // batch stops on the window change
+    state.getFocusedID() = ID_CHECK;
+    keys[0].key = twins::Key::Enter;
+    EXPECT_EQ(1, twins::processInputBatch(state, keys, 2, &processed));
+    EXPECT_EQ(1, processed);
+    EXPECT_EQ(ID_CHECK, state.getFocusedID());
+
+    pTestOutput = nullptr;
+    twins::resetInternalState();
+}
+
 TEST_F(WIDGET, processInput_OnWidget)
 {
     const auto *p_wnd = wndTest.getWidgets();
@@ -680,6 +910,60 @@ TEST_F(WIDGET, processInput_OnWidget)
     }
 }
 
+TEST_F(WIDGET, processInput_TextEdit_Paste)
+{
+    const auto *p_wnd = getWndTest()->getWidgets();
+    ASSERT_NE(nullptr, p_wnd);
+
+    wndTest.wgtId = ID_EDIT;
+    wndTest.editText.clear();
+    twins::KeyCode kc = {};
+    kc.m_spec = true;
+
+    // not in edit mode - ignored
+    const char text[] = "ab\r\ncd\tłe\x01" "f";
+    kc.key = twins::Key::Paste;
+    kc.paste = { text, sizeof(text)-1 };
+    twins::processInput(p_wnd, kc);
+
+    kc.key = twins::Key::Enter;
+    twins::processInput(p_wnd, kc);
+
+    kc.key = twins::Key::Paste;
+    twins::processInput(p_wnd, kc);
+
+    kc.key = twins::Key::Enter;
+    twins::processInput(p_wnd, kc);
+    EXPECT_STREQ("ab cd łef", wndTest.editText.cstr());
+    wndTest.wgtId = {};
+}
+
+TEST_F(WIDGET, processInput_ListBox_Repeat)
+{
+    const auto *p_wnd = getWndTest()->getWidgets();
+    ASSERT_NE(nullptr, p_wnd);
+
+    wndTest.wgtId = ID_LISTBOX;
+    wndTest.listSelCalls = 0;
+    twins::KeyCode kc = {};
+    kc.m_spec = true;
+
+    // 3 items, selected 0: 1, 2, 0, 1 - in single step
+    kc.key = twins::Key::Down;
+    kc.repeat = 4;
+    twins::processInput(p_wnd, kc);
+    EXPECT_EQ(1, wndTest.listSelIdx);
+    EXPECT_EQ(1, wndTest.listSelCalls);
+
+    // 0 -> 2 -> 1
+    kc.key = twins::Key::Up;
+    kc.repeat = 2;
+    twins::processInput(p_wnd, kc);
+    EXPECT_EQ(1, wndTest.listSelIdx);
+    EXPECT_EQ(2, wndTest.listSelCalls);
+    wndTest.wgtId = {};
+}
+
 TEST_F(WIDGET, processInput_Mouse_BtnClick)
 {
     const auto *p_wnd = wndTest.getWidgets();
@@ -711,3 +995,482 @@ TEST_F(WIDGET, processInput_Mouse_BtnClick)
         EXPECT_EQ(ID_BTN1, wndTest.clickedId);
     }
 }
+
+TEST_F(WIDGET, focusOrder)
+{
+    const auto *p_wnd = getWndTest()->getWidgets();
+    ASSERT_NE(nullptr, p_wnd);
+
+    {
+        const twins::WID expected_ids[] = {
+            ID_BTN1, ID_BTN2, ID_BTN3, ID_EDIT, ID_RADIO, ID_CHECK,
+            ID_LISTBOX, ID_TEXTBOX, ID_TEXTBOX_EMPTY, ID_COMBOBOX
+        };
+        const auto *p_page1 = twins::getWidget(p_wnd, ID_PAGE1);
+
+        ASSERT_EQ(twins::arrSize(expected_ids) + 1, wndTestFocusOrder.size());
+        EXPECT_EQ(0, wndTestFocusOrder[wndTestFocusOrder.size()-1].wgtIdx);
+
+        for (unsigned i = 0; i < twins::arrSize(expected_ids); i++)
+        {
+            const auto &fe = wndTestFocusOrder[i];
+            EXPECT_EQ(expected_ids[i], p_wnd[fe.wgtIdx].id);
+            EXPECT_EQ(i < 3 ? p_page1->link.ownIdx : 0, fe.scopeIdx);
+        }
+    }
+
+    {
+        // Tab/Shift+Tab must give the same results with and without the table
+        const twins::WID focusable_ids[] = {
+            ID_BTN1, ID_BTN3, ID_EDIT, ID_CHECK, ID_TEXTBOX_EMPTY, ID_COMBOBOX
+        };
+
+        twins::KeyCode kc = {};
+        kc.key = twins::Key::Tab;
+        kc.m_spec = true;
+
+        for (uint8_t pg_idx = 0; pg_idx < 2; pg_idx++)
+        {
+            wndTest.pgIndex = pg_idx;
+
+            for (auto id : focusable_ids)
+            {
+                for (bool shift : {false, true})
+                {
+                    kc.m_shift = shift;
+
+                    wndTest.pFocusOrder = nullptr;
+                    wndTest.wgtId = id;
+                    twins::processInput(p_wnd, kc);
+                    auto expected_id = wndTest.wgtId;
+
+                    wndTest.pFocusOrder = wndTestFocusOrder.begin();
+                    wndTest.wgtId = id;
+                    twins::processInput(p_wnd, kc);
+                    EXPECT_EQ(expected_id, wndTest.wgtId) << "from ID " << id << (shift ? " backward" : " forward");
+                }
+            }
+        }
+
+        wndTest.pFocusOrder = nullptr;
+        wndTest.pgIndex = 0;
+        wndTest.wgtId = {};
+    }
+}
+
+TEST_F(WIDGET, widgetColumns)
+{
+    const auto *p_wnd = getWndTest()->getWidgets();
+    ASSERT_EQ(wndTestWidgets.size() - 1, wndTestColumns.count);
+
+    for (unsigned i = 0; i < wndTestColumns.count; i++)
+    {
+        const auto *p_wgt = p_wnd + i;
+        EXPECT_EQ(p_wgt->id, wndTestColumns.pIds[i]);
+        EXPECT_EQ(p_wgt->type, wndTestColumns.pTypes[i]);
+        EXPECT_EQ(p_wgt->link.parentIdx, wndTestColumns.pParentIdxs[i]);
+        EXPECT_EQ(p_wgt->size.width, wndTestColumns.pRects[i].size.width);
+        EXPECT_EQ(p_wgt->size.height, wndTestColumns.pRects[i].size.height);
+
+        // the same results with and without columns
+        wndTest.pColumns = nullptr;
+        auto coord = twins::getScreenCoord(p_wgt);
+        EXPECT_EQ(p_wgt, twins::getWidget(p_wnd, p_wgt->id));
+
+        wndTest.pColumns = &wndTestColumns;
+        auto coord_c = twins::getScreenCoord(p_wgt);
+        EXPECT_EQ(coord.col, coord_c.col) << "ID " << p_wgt->id;
+        EXPECT_EQ(coord.row, coord_c.row) << "ID " << p_wgt->id;
+        EXPECT_EQ(p_wgt, twins::getWidget(p_wnd, p_wgt->id));
+    }
+
+    {
+        wndTest.pColumns = &wndTestColumns;
+        EXPECT_EQ(nullptr, twins::getWidget(p_wnd, 1234));
+    }
+
+    for (uint8_t row = 0; row < 60; row += 3)
+    {
+        for (uint8_t col = 0; col < 110; col += 3)
+        {
+            twins::Rect rct = {}, rct_c = {};
+
+            wndTest.pColumns = nullptr;
+            twins::CallCtx ctx(p_wnd);
+            const twins::Widget *p_wgt = twins::getWidgetAt(ctx, col, row, rct);
+
+            wndTest.pColumns = &wndTestColumns;
+            twins::CallCtx ctx_c(p_wnd);
+            EXPECT_EQ(p_wgt, (const twins::Widget*)twins::getWidgetAt(ctx_c, col, row, rct_c));
+        }
+    }
+
+    {
+        // SGR mouse column beyond 255 is not taken for the widget at (col - 256)
+        wndTest.pColumns = nullptr;
+        twins::CallCtx ctx(p_wnd);
+        twins::Rect rct = {};
+        auto btn_coord = twins::getScreenCoord(twins::getWidget(p_wnd, ID_BTN1));
+        const twins::Widget *p_wgt = twins::getWidgetAt(ctx, btn_coord.col, btn_coord.row, rct);
+        ASSERT_TRUE(p_wgt);
+        EXPECT_EQ(ID_BTN1, p_wgt->id);
+        p_wgt = twins::getWidgetAt(ctx, btn_coord.col + 256, btn_coord.row, rct);
+        EXPECT_FALSE(p_wgt && p_wgt->id == ID_BTN1);
+    }
+
+    wndTest.pColumns = nullptr;
+}
+
+TEST_F(WIDGET, widgetColumns_noWidgetArray)
+{
+    const auto *p_wnd = getWndTest()->getWidgets();
+    // compact form takes less space than the Widget array it replaces
+    EXPECT_LT(sizeof(wndTestColumnsArr), sizeof(wndTestWidgets));
+
+    twins::CallCtx ctx(p_wnd, &wndTest);
+    wndTest.mpWgts = nullptr;
+    wndTest.pColumns = &wndTestColumns;
+    twins::CallCtx ctx_c(nullptr, &wndTest);
+
+    // widgets rebuilt from the columns are the same as in the array
+    for (unsigned i = 0; i < wndTestColumns.count; i++)
+    {
+        const auto *p_wgt = p_wnd + i;
+        twins::WidgetPtr p_wgt_c = ctx_c.at(i);
+
+        EXPECT_EQ(p_wgt->type, p_wgt_c->type);
+        EXPECT_EQ(p_wgt->id, p_wgt_c->id);
+        EXPECT_EQ(p_wgt->coord.col, p_wgt_c->coord.col) << "ID " << p_wgt->id;
+        EXPECT_EQ(p_wgt->coord.row, p_wgt_c->coord.row) << "ID " << p_wgt->id;
+        EXPECT_EQ(p_wgt->size.width, p_wgt_c->size.width);
+        EXPECT_EQ(p_wgt->size.height, p_wgt_c->size.height);
+        EXPECT_EQ(p_wgt->link.ownIdx, p_wgt_c->link.ownIdx);
+        EXPECT_EQ(p_wgt->link.parentIdx, p_wgt_c->link.parentIdx);
+        EXPECT_EQ(p_wgt->link.childrenIdx, p_wgt_c->link.childrenIdx);
+        EXPECT_EQ(p_wgt->link.childrenCnt, p_wgt_c->link.childrenCnt);
+        EXPECT_EQ(twins::getWidgetBgColor(ctx, p_wgt), twins::getWidgetBgColor(ctx_c, p_wgt_c));
+        EXPECT_EQ(twins::getWidgetFgColor(ctx, p_wgt), twins::getWidgetFgColor(ctx_c, p_wgt_c));
+
+        auto coord = twins::getScreenCoord(ctx, p_wgt);
+        auto coord_c = twins::getScreenCoord(ctx_c, p_wgt_c);
+        EXPECT_EQ(coord.col, coord_c.col) << "ID " << p_wgt->id;
+        EXPECT_EQ(coord.row, coord_c.row) << "ID " << p_wgt->id;
+    }
+
+    EXPECT_EQ(p_wnd->window.title, ctx_c.pWindow->window.title);
+    EXPECT_EQ(p_wnd[1].pagectrl.tabWidth, ctx_c.at(1)->pagectrl.tabWidth);
+
+    for (uint8_t row = 0; row < 60; row += 3)
+    {
+        for (uint8_t col = 0; col < 110; col += 3)
+        {
+            twins::Rect rct = {}, rct_c = {};
+            twins::WidgetPtr p_wgt = twins::getWidgetAt(ctx, col, row, rct);
+            twins::WidgetPtr p_wgt_c = twins::getWidgetAt(ctx_c, col, row, rct_c);
+
+            ASSERT_EQ(!p_wgt, !p_wgt_c);
+            if (!p_wgt) continue;
+            EXPECT_EQ(p_wgt->id, p_wgt_c->id);
+            EXPECT_EQ(rct.coord.col, rct_c.coord.col);
+            EXPECT_EQ(rct.size.width, rct_c.size.width);
+        }
+    }
+
+    // the same screen output
+    std::string out, out_c;
+    pTestOutput = &out;
+    twins::drawWidget(getWndTest()->getWidgets());
+    wndTest.mpWgts = nullptr;
+    pTestOutput = &out_c;
+    twins::drawWidget(wndTest);
+    pTestOutput = nullptr;
+    EXPECT_FALSE(out.empty());
+    EXPECT_EQ(out, out_c);
+
+    // the same focus navigation
+    twins::KeyCode kc = {};
+    kc.m_spec = true;
+    kc.key = twins::Key::Tab;
+    std::vector<twins::WID> focused, focused_c;
+
+    wndTest.pColumns = nullptr;
+    wndTest.wgtId = {};
+    for (int i = 0; i < 12; i++)
+    {
+        twins::processInput(getWndTest()->getWidgets(), kc);
+        focused.push_back(wndTest.wgtId);
+    }
+
+    wndTest.mpWgts = nullptr;
+    wndTest.pColumns = &wndTestColumns;
+    wndTest.wgtId = {};
+    for (int i = 0; i < 12; i++)
+    {
+        twins::processInput(wndTest, kc);
+        focused_c.push_back(wndTest.wgtId);
+    }
+
+    EXPECT_EQ(focused, focused_c);
+
+    // button clicked; pressed widget is kept by value
+    auto btn_coord = twins::getScreenCoord(ctx_c, twins::getWidgetByWID(ctx_c, ID_BTN1));
+    kc = {};
+    kc.key = twins::Key::MouseEvent;
+    kc.mouse.btn = twins::MouseBtn::ButtonLeft;
+    kc.mouse.col = btn_coord.col;
+    kc.mouse.row = btn_coord.row;
+    wndTest.clickedId = {};
+    EXPECT_TRUE(twins::processInput(wndTest, kc));
+    ASSERT_TRUE(twins::g_ws.pMouseDownWgt);
+    EXPECT_EQ(ID_BTN1, twins::g_ws.pMouseDownWgt->id);
+    kc.mouse.btn = twins::MouseBtn::ButtonReleased;
+    EXPECT_TRUE(twins::processInput(wndTest, kc));
+    EXPECT_EQ(ID_BTN1, wndTest.clickedId);
+
+    wndTest.pColumns = nullptr;
+    wndTest.wgtId = {};
+    getWndTest();
+}
+
+TEST_F(WIDGET, widgetIdentity_twoWindows)
+{
+    // the same IDs and indexes: the Widget array window and the columns-only window
+    const auto *p_wnd = getWndTest()->getWidgets();
+    WindowTestState wnd_cols;
+    wnd_cols.pColumns = &wndTestColumns;
+
+    const auto *p_btn = twins::getWidget(p_wnd, ID_BTN1);
+    auto btn_coord = twins::getScreenCoord(p_btn);
+    twins::resetInternalState();
+
+    std::string out_released, out_pressed;
+    twins::flushBuffer();
+    pTestOutput = &out_released;
+    twins::drawWidget(p_wnd, ID_BTN1);
+    pTestOutput = nullptr;
+
+    // pressed in the columns window
+    twins::KeyCode kc = {};
+    kc.key = twins::Key::MouseEvent;
+    kc.mouse.btn = twins::MouseBtn::ButtonLeft;
+    kc.mouse.col = btn_coord.col;
+    kc.mouse.row = btn_coord.row;
+    EXPECT_TRUE(twins::processInput(wnd_cols, kc));
+    ASSERT_TRUE(twins::g_ws.pMouseDownWgt);
+    EXPECT_EQ(ID_BTN1, twins::g_ws.pMouseDownWgt->id);
+
+    // not pressed in the other window
+    twins::flushBuffer();
+    pTestOutput = &out_pressed;
+    twins::drawWidget(p_wnd, ID_BTN1);
+    pTestOutput = nullptr;
+    EXPECT_FALSE(out_released.empty());
+    EXPECT_EQ(out_released, out_pressed);
+
+    // released over the other window - not clicked there
+    wndTest.clickedId = {};
+    kc.mouse.btn = twins::MouseBtn::ButtonReleased;
+    twins::processInput(p_wnd, kc);
+    EXPECT_EQ(twins::WIDGET_ID_NONE, wndTest.clickedId);
+    EXPECT_FALSE(twins::g_ws.pMouseDownWgt);
+
+    // but clicked in the window it was pressed in
+    kc.mouse.btn = twins::MouseBtn::ButtonLeft;
+    EXPECT_TRUE(twins::processInput(wnd_cols, kc));
+    kc.mouse.btn = twins::MouseBtn::ButtonReleased;
+    EXPECT_TRUE(twins::processInput(wnd_cols, kc));
+    EXPECT_EQ(ID_BTN1, wnd_cols.clickedId);
+    EXPECT_EQ(twins::WIDGET_ID_NONE, wndTest.clickedId);
+
+    twins::resetInternalState();
+    wndTest.wgtId = {};
+}
+
+TEST_F(WIDGET, windowStateBase_propStore)
+{
+    struct TestState : twins::WindowStateBase
+    {
+        void invalidateImpl(const twins::WID *pId, uint16_t count, bool instantly) override
+        {
+            invalidated += count;
+        }
+
+        int invalidated = 0;
+    };
+
+    TestState state;
+    const auto *p_wnd = getWndTest()->getWidgets();
+    const auto *p_chbx = twins::getWidget(p_wnd, ID_CHECK);
+    const auto *p_lbx = twins::getWidget(p_wnd, ID_LISTBOX);
+    state.init(p_wnd);
+
+    // store not allocated yet
+    EXPECT_EQ(nullptr, state.getProp(p_chbx));
+    EXPECT_FALSE(state.setCheckboxChecked(ID_CHECK, true));
+    EXPECT_TRUE(state.isEnabled(p_chbx));
+    EXPECT_EQ(0, state.invalidated);
+
+    state.initPropStore();
+    ASSERT_NE(nullptr, state.getProp(p_chbx));
+    EXPECT_TRUE(state.isEnabled(p_chbx));
+    EXPECT_FALSE(state.getCheckboxChecked(p_chbx));
+
+    // invalidated only on real change
+    EXPECT_TRUE(state.setCheckboxChecked(ID_CHECK, true));
+    EXPECT_EQ(1, state.invalidated);
+    EXPECT_FALSE(state.setCheckboxChecked(ID_CHECK, true));
+    EXPECT_EQ(1, state.invalidated);
+    EXPECT_TRUE(state.getCheckboxChecked(p_chbx));
+
+    state.onCheckboxToggle(p_chbx);
+    EXPECT_FALSE(state.getCheckboxChecked(p_chbx));
+    EXPECT_EQ(2, state.invalidated);
+
+    EXPECT_TRUE(state.setEnabled(ID_CHECK, false));
+    EXPECT_FALSE(state.isEnabled(p_chbx));
+    EXPECT_FALSE(state.setEnabled(1234, false));
+
+    {
+        EXPECT_TRUE(state.setListBoxState(ID_LISTBOX, 2, 3, 10));
+        EXPECT_FALSE(state.setListBoxState(ID_LISTBOX, 2, 3, 10));
+        int16_t item_idx = 0, sel_idx = 0, items_cnt = 0;
+        state.getListBoxState(p_lbx, item_idx, sel_idx, items_cnt);
+        EXPECT_EQ(2, item_idx);
+        EXPECT_EQ(3, sel_idx);
+        EXPECT_EQ(10, items_cnt);
+    }
+}
+
+TEST_F(WIDGET, windowStateBase_propStore_columns)
+{
+    struct TestState : twins::WindowStateBase
+    {
+        void invalidateImpl(const twins::WID *pId, uint16_t count, bool instantly) override
+        {
+            invalidated += count;
+        }
+
+        int invalidated = 0;
+    };
+
+    // window given as columns only
+    TestState state;
+    state.init(nullptr);
+    state.setWidgetColumns(&wndTestColumns);
+    state.initPropStore();
+
+    const auto *p_wnd = getWndTest()->getWidgets();
+    const auto *p_chbx = twins::getWidget(p_wnd, ID_CHECK);
+    ASSERT_NE(nullptr, state.getProp(p_chbx));
+
+    EXPECT_TRUE(state.setCheckboxChecked(ID_CHECK, true));
+    EXPECT_FALSE(state.setCheckboxChecked(ID_CHECK, true));
+    EXPECT_TRUE(state.getCheckboxChecked(p_chbx));
+    EXPECT_EQ(1, state.invalidated);
+    EXPECT_FALSE(state.setEnabled(1234, false));
+
+    // default handlers
+    state.onCheckboxToggle(p_chbx);
+    EXPECT_FALSE(state.getCheckboxChecked(p_chbx));
+    EXPECT_EQ(2, state.invalidated);
+
+    // through the engine
+    state.getFocusedID() = ID_CHECK;
+    twins::KeyCode kc = {};
+    kc.key = twins::Key::Enter;
+    kc.m_spec = true;
+    EXPECT_TRUE(twins::processInput(state, kc));
+    EXPECT_TRUE(state.getCheckboxChecked(p_chbx));
+    EXPECT_GT(state.invalidated, 2);
+}
+
+TEST_F(WIDGET, windowStateT_adapter)
+{
+    struct TestState : twins::WindowStateT<TestState>
+    {
+        bool isEnabled(const twins::Widget* pWgt) { return pWgt->id != ID_CHECK; }
+        int  getPageCtrlPageIndex(const twins::Widget* pWgt) { return 1; }
+        void onCheckboxToggle(const twins::Widget* pWgt) { toggled++; invalidate(pWgt->id); }
+
+        void invalidateImpl(const twins::WID *pId, uint16_t count, bool instantly)
+        {
+            invalidated += count;
+        }
+
+        int toggled = 0;
+        int invalidated = 0;
+    };
+
+    TestState state;
+    twins::IWindowState *p_istate = state.getInterface();
+    const auto *p_wnd = getWndTest()->getWidgets();
+    const auto *p_chbx = twins::getWidget(p_wnd, ID_CHECK);
+    const auto *p_btn = twins::getWidget(p_wnd, ID_BTN1);
+
+    p_istate->init(p_wnd);
+    EXPECT_EQ(p_wnd, state.getWidgets());
+    EXPECT_EQ(p_wnd, p_istate->getWidgets());
+
+    // overridden
+    EXPECT_FALSE(p_istate->isEnabled(p_chbx));
+    EXPECT_TRUE(p_istate->isEnabled(p_btn));
+    EXPECT_EQ(1, p_istate->getPageCtrlPageIndex(p_wnd));
+    p_istate->onCheckboxToggle(p_chbx);
+    EXPECT_EQ(1, state.toggled);
+    EXPECT_EQ(1, state.invalidated);
+    p_istate->invalidate({ID_BTN1, ID_BTN2});
+    EXPECT_EQ(3, state.invalidated);
+
+    // defaults
+    EXPECT_TRUE(p_istate->isVisible(p_chbx));
+    EXPECT_EQ(-1, p_istate->getRadioIndex(p_chbx));
+    p_istate->getFocusedID() = ID_BTN1;
+    EXPECT_TRUE(p_istate->isFocused(p_btn));
+    EXPECT_FALSE(p_istate->isFocused(p_chbx));
+}
+
+struct StaticDispatchState : twins::WindowStateT<StaticDispatchState>
+{
+    bool isVisible(const twins::Widget* pWgt) { TWINS_STATE_OVERRIDE(isVisible); visibilityQueries++; return true; }
+    bool isEnabled(const twins::Widget* pWgt) { TWINS_STATE_OVERRIDE(isEnabled); return pWgt->id != ID_CHECK; }
+
+    int visibilityQueries = 0;
+};
+
+TWINS_INSTANTIATE_WINDOW_STATE(StaticDispatchState);
+
+TEST_F(WIDGET, windowStateT_staticDispatch)
+{
+    using TestState = StaticDispatchState;
+
+    const auto *p_wnd = getWndTest()->getWidgets();
+    TestState state;
+    state.init(p_wnd);
+    // the same engine, called through the virtual interface
+    TestState ref;
+    ref.init(p_wnd);
+    twins::CallCtx ctx(p_wnd, ref.getInterface());
+
+    twins::KeyCode kc = {};
+    kc.key = twins::Key::Tab;
+    kc.m_spec = true;
+
+    for (int i = 0; i < 4; i++)
+    {
+        EXPECT_EQ(twins::processInputImpl(ctx, kc), twins::processInput(state, kc));
+        EXPECT_NE(twins::WIDGET_ID_NONE, state.getFocusedID());
+        EXPECT_NE(ID_CHECK, state.getFocusedID());
+        EXPECT_EQ(ref.getFocusedID(), state.getFocusedID());
+    }
+
+    EXPECT_GT(state.visibilityQueries, 0);
+
+    // default invalidateImpl draws through the virtual interface
+    state.visibilityQueries = 0;
+    state.invalidate(ID_BTN1);
+    EXPECT_GT(state.visibilityQueries, 0);
+
+    state.visibilityQueries = 0;
+    twins::drawWidgets(state, {ID_BTN1, ID_CHECK});
+    EXPECT_GT(state.visibilityQueries, 0);
+}